@@ -0,0 +1,351 @@
+// jianhan-opt: optimize layouts for corpus statistics from the command line.
+//
+//   jianhan-opt --corpus bigrams.txt --threads 8 --seconds 60 --out best.txt
+//
+//   jianhan-opt --corpus bigrams.txt --threads 8 --serve /tmp/jianhan.sock
+//
+// Run without arguments for the list of options.
+
+#include <charconv>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "../src/search/search_anneal.hpp"
+#include "../src/search/search_daemon.hpp"
+#include "../src/search/search_deterministic.hpp"
+#include "../src/search/search_sweep.hpp"
+
+using namespace jianhan::v0;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto USAGE = R"(usage: jianhan-opt --corpus FILE [options]
+
+  --corpus FILE    bigram statistics, one per line: two key values and a
+                   frequency, e.g. "TH 0.0152", '#' starts a comment
+  --config FILE    layout configuration (default: conf/layouts.toml of the
+                   project root, or the built-in one)
+  --costs FILE     30 rows of 30 costs, from position to position
+                   (default: grid distance)
+  --engine NAME    anneal (default) or climb
+  --selection NAME static (default): areas and operators drawn by size and
+                   weight, or adaptive: by their recent improvements
+  --threads N      worker threads (default: hardware threads)
+  --restarts N     independent runs (default: 4 per thread)
+  --steps N        moves per restart (default: 1000000)
+  --seconds S      overall time budget, the results then depend on timing
+  --t0 X, --t1 X   annealing temperatures (default: 1 and 0.001)
+  --seed N         (default: 42)
+  --elites K       best distinct layouts kept (default: 10)
+  --out FILE       write the best layouts, one per line
+  --serve PATH     serve jobs on a Unix domain socket until interrupted
+                   instead (see search::Daemon), with --threads workers
+  --sweep FILE     compare configurations instead, repeated once per file:
+                   --restarts per configuration (default: 4), the best
+                   layout and scores of each in a table
+)";
+
+struct Options final {
+    std::string corpus;
+    std::string config;
+    std::string costs;
+    std::string out;
+    std::string serve;
+    std::vector<std::string> sweep;
+    std::string engine{"anneal"};
+    std::string selection{"static"};
+    uz num_threads = std::max(1u, std::thread::hardware_concurrency());
+    uz num_restarts = 0; // 0: 4 per thread
+    uz num_steps = 1'000'000;
+    f64 seconds = 0;     // 0: no time budget
+    f64 start_temperature = 1;
+    f64 end_temperature = 0.001;
+    uint64_t seed = 42;
+    uz num_elites = 10;
+};
+
+template<typename T> auto parseNumber(const std::string_view name, const std::string_view str) -> T {
+    T value{};
+    const auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc{} or end != str.data() + str.size()) {
+        throw std::invalid_argument(fmt::format("invalid value for {:s}: \"{:s}\"", name, str));
+    }
+    return value;
+}
+
+auto parseOptions(const int argc, char **const argv) -> Options {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view name = argv[i];
+        if (i + 1 == argc) {
+            throw std::invalid_argument(fmt::format("missing value for {:s}", name));
+        }
+        const std::string_view value = argv[++i];
+
+        if (name == "--corpus") { options.corpus = value; }
+        else if (name == "--config") { options.config = value; }
+        else if (name == "--costs") { options.costs = value; }
+        else if (name == "--out") { options.out = value; }
+        else if (name == "--serve") { options.serve = value; }
+        else if (name == "--sweep") { options.sweep.emplace_back(value); }
+        else if (name == "--engine") { options.engine = value; }
+        else if (name == "--selection") { options.selection = value; }
+        else if (name == "--threads") { options.num_threads = parseNumber<uz>(name, value); }
+        else if (name == "--restarts") { options.num_restarts = parseNumber<uz>(name, value); }
+        else if (name == "--steps") { options.num_steps = parseNumber<uz>(name, value); }
+        else if (name == "--seconds") { options.seconds = parseNumber<f64>(name, value); }
+        else if (name == "--t0") { options.start_temperature = parseNumber<f64>(name, value); }
+        else if (name == "--t1") { options.end_temperature = parseNumber<f64>(name, value); }
+        else if (name == "--seed") { options.seed = parseNumber<uint64_t>(name, value); }
+        else if (name == "--elites") { options.num_elites = parseNumber<uz>(name, value); }
+        else { throw std::invalid_argument(fmt::format("unknown option {:s}", name)); }
+    }
+
+    if (options.corpus.empty()) {
+        throw std::invalid_argument("missing --corpus");
+    }
+    if (options.engine == "climb") {
+        options.start_temperature = options.end_temperature = 0;
+    } else if (options.engine != "anneal") {
+        throw std::invalid_argument(fmt::format("unknown engine {:s}", options.engine));
+    }
+    if (options.selection != "static" and options.selection != "adaptive") {
+        throw std::invalid_argument(fmt::format("unknown selection {:s}", options.selection));
+    }
+    if (options.num_threads == 0 or options.num_elites == 0) {
+        throw std::invalid_argument("--threads and --elites must be positive");
+    }
+    if (not options.serve.empty() and not options.sweep.empty()) {
+        throw std::invalid_argument("--serve and --sweep are exclusive");
+    }
+    if ((not options.serve.empty() or not options.sweep.empty())
+        and (not options.config.empty() or not options.out.empty())) {
+        throw std::invalid_argument("--config and --out do not apply to --serve or --sweep");
+    }
+    if (options.num_restarts == 0) {
+        options.num_restarts = options.sweep.empty() ? 4 * options.num_threads : 4;
+    }
+    return options;
+}
+
+auto readFile(const std::string &path) -> std::string {
+    std::ifstream file(path, std::ios::binary);
+    if (not file) {
+        throw std::runtime_error(fmt::format("cannot open \"{:s}\"", path));
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// The lines of a text file, without comments and blank lines.
+auto readLines(const std::string &path) -> std::vector<std::string> {
+    std::istringstream content(readFile(path));
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(content, line);) {
+        line.erase(std::min(line.find('#'), line.size()));
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            lines.emplace_back(std::move(line));
+        }
+    }
+    return lines;
+}
+
+auto loadCorpus(const std::string &path) -> std::vector<score::Bigram> {
+    std::vector<score::Bigram> bigrams;
+    for (const std::string &line : readLines(path)) {
+        std::istringstream fields(line);
+        std::string keys;
+        fz freq{};
+        if (not (fields >> keys >> freq) or keys.size() != 2) {
+            throw std::invalid_argument(fmt::format("{:s}: invalid bigram \"{:s}\"", path, line));
+        }
+        bigrams.push_back({static_cast<KeyValue>(keys[0]), static_cast<KeyValue>(keys[1]), freq});
+    }
+    return bigrams;
+}
+
+auto loadCosts(const std::string &path) -> score::CostMatrix {
+    if (path.empty()) {
+        return score::gridDistanceCosts();
+    }
+
+    score::CostMatrix costs{};
+    const std::vector<std::string> lines = readLines(path);
+    if (lines.size() != KEY_COUNT) {
+        throw std::invalid_argument(fmt::format("{:s}: expected {:d} rows, got {:d}", path, KEY_COUNT, lines.size()));
+    }
+    for (uz pos1 = 0; pos1 < KEY_COUNT; ++pos1) {
+        std::istringstream fields(lines[pos1]);
+        for (uz pos2 = 0; pos2 < KEY_COUNT; ++pos2) {
+            if (not (fields >> costs[pos1 * KEY_CNT_POW2 + pos2])) {
+                throw std::invalid_argument(fmt::format("{:s}: row {:d} has less than {:d} costs", path, pos1, KEY_COUNT));
+            }
+        }
+    }
+    return costs;
+}
+
+// The configuration file if any, else the built-in one (nullptr).
+auto loadConfig(const std::string &path) -> std::shared_ptr<const layout::Config> {
+    if (not path.empty()) {
+        return std::make_shared<const layout::Config>(toml::parse(path));
+    }
+    try {
+        return std::make_shared<const layout::Config>(toml::parse(Util::mkAbsPath("conf/layouts.toml")));
+    } catch (const std::runtime_error &) { // no project root
+        return nullptr;
+    }
+}
+
+// Serve until SIGINT or SIGTERM, the evaluator loaded once for all the jobs.
+auto serve(const Options &options) -> void {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr); // before the threads start
+
+    search::Daemon daemon(
+        std::make_shared<const score::Evaluator>(loadCorpus(options.corpus), loadCosts(options.costs)),
+        {.path = options.serve, .num_workers = options.num_threads}
+    );
+    fmt::println(stderr, "serving on {:s} with {:d} workers", options.serve, options.num_threads);
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    daemon.stop();
+    fmt::println(stderr, "{:d} jobs completed", daemon.numCompletedJobs());
+}
+
+// Compare the configurations, the evaluator and the workers shared by all.
+auto sweep(const Options &options, const score::Evaluator &evaluator,
+           const search::AnnealOptions &anneal_options) -> void {
+    search::Sweep sweep(evaluator, {
+        .num_restarts = options.num_restarts,
+        .seed = options.seed,
+        .num_elites = options.num_elites,
+        .anneal = anneal_options,
+    });
+    for (const std::string &path : options.sweep) {
+        sweep.add(path, toml::parse(path));
+    }
+
+    const auto start = Clock::now();
+    search::Scheduler scheduler(options.num_threads);
+    const std::vector<search::SweepRow> rows = sweep.run(scheduler);
+    fmt::println(stderr, "{:d} configurations of {:d} restarts in {:.3f} s", rows.size(), options.num_restarts,
+                 std::chrono::duration<f64>(Clock::now() - start).count());
+    fmt::print("{:s}", search::Sweep::table(rows));
+}
+
+auto run(const Options &options) -> void {
+    if (not options.serve.empty()) {
+        serve(options);
+        return;
+    }
+
+    const auto start = Clock::now();
+    const score::Evaluator evaluator(loadCorpus(options.corpus), loadCosts(options.costs));
+
+    search::AnnealOptions anneal_options{
+        .num_steps = options.num_steps,
+        .start_temperature = options.start_temperature,
+        .end_temperature = options.end_temperature,
+    };
+    if (options.selection == "adaptive") {
+        anneal_options.adaptive = layout::BanditOptions{};
+    }
+    if (options.seconds > 0) {
+        anneal_options.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<f64>(options.seconds)
+        );
+    }
+    if (not options.sweep.empty()) {
+        sweep(options, evaluator, anneal_options);
+        return;
+    }
+    const auto config = loadConfig(options.config);
+    const search::Annealer annealer(evaluator, anneal_options);
+
+    const auto loaded = Clock::now();
+    fmt::println(stderr, "{:d} bigrams, {:s} on {:d} threads, {:d} restarts of {:d} steps (startup {:.3f} s)",
+                 evaluator.size(), options.engine, options.num_threads, options.num_restarts, options.num_steps,
+                 std::chrono::duration<f64>(loaded - start).count());
+
+    std::atomic<uz> num_moves{0}, num_evaluations{0};
+    std::mutex progress_mutex;
+    uz completed = 0;
+    fz best_score = std::numeric_limits<fz>::infinity();
+    const std::atomic<bool> stop{false};
+
+    search::Scheduler scheduler(options.num_threads);
+    search::DeterministicRun deterministic({
+        .num_items = options.num_restarts,
+        .seed = options.seed,
+        .num_elites = options.num_elites,
+        .config = config,
+    });
+    const search::Elites elites = deterministic.run(scheduler, [&](layout::Manager &manager, search::Item &item) -> void {
+        if (Clock::now() >= anneal_options.deadline) {
+            return;
+        }
+        const search::AnnealResult result = annealer.run(manager, item.prng(), stop);
+        item.offer(result.best, result.score);
+        num_moves.fetch_add(result.moves, std::memory_order_relaxed);
+        num_evaluations.fetch_add(result.moves + 2, std::memory_order_relaxed); // deltas and 2 full scores
+
+        const std::scoped_lock lock(progress_mutex);
+        best_score = std::min(best_score, result.score);
+        fmt::println(stderr, "[{:>{}d}/{:d}] {:9.3f} s  best {:.6f}  {:s}",
+                     ++completed, fmt::formatted_size("{:d}", options.num_restarts), options.num_restarts,
+                     std::chrono::duration<f64>(Clock::now() - loaded).count(), best_score, result.best.toStr());
+    });
+
+    const f64 seconds = std::chrono::duration<f64>(Clock::now() - loaded).count();
+    const auto per_second = [&](const uz count) -> f64 { return static_cast<f64>(count) / seconds; };
+    fmt::println(stderr, "{:d} restarts in {:.3f} s", completed, seconds);
+    // The totals divided by the threads, not measured per worker.
+    fmt::println(stderr, "evaluations  {:.4g}/s, {:.4g}/s per thread on average",
+                 per_second(num_evaluations), per_second(num_evaluations) / static_cast<f64>(options.num_threads));
+    fmt::println(stderr, "moves        {:.4g}/s, {:.4g}/s per thread on average",
+                 per_second(num_moves), per_second(num_moves) / static_cast<f64>(options.num_threads));
+
+    for (const search::Elite &elite : elites) {
+        fmt::println("{:s} {:.6f}", elite.layout.toStr(), elite.score);
+    }
+
+    if (not options.out.empty()) {
+        std::vector<Layout> best;
+        best.reserve(elites.size());
+        for (const search::Elite &elite : elites) {
+            best.push_back(elite.layout);
+        }
+        std::string buffer(best.size() * (KEY_COUNT + 1), '\0');
+        writeLayouts(std::span<const Layout>(best), buffer);
+        std::ofstream file(options.out, std::ios::binary);
+        if (not (file << buffer) or not file.flush()) {
+            throw std::runtime_error(fmt::format("cannot write \"{:s}\"", options.out));
+        }
+    }
+}
+
+}
+
+int main(const int argc, char **const argv) {
+    if (argc == 1) {
+        fmt::print(stderr, "{:s}", USAGE);
+        return 1;
+    }
+    try {
+        run(parseOptions(argc, argv));
+    } catch (const std::exception &e) {
+        fmt::println(stderr, "jianhan-opt: {:s}", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "arena.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace jianhan::v0 {
+
+/**
+ * @brief Construct an empty arena.
+ * @param block_size: size of the blocks taken from the heap; larger
+ *                    requests get a block of their own size.
+ **/
+Arena::Arena(const uz block_size)
+    : block_size_(std::max<uz>(block_size, 64)) {}
+
+Arena::~Arena() {
+    for (const Block &block : blocks_) {
+        ::operator delete(block.data, std::align_val_t{64});
+    }
+}
+
+auto Arena::addBlock(const uz min_size) -> void {
+    const uz size = std::max(block_size_, min_size);
+    auto *data = static_cast<std::byte *>(::operator new(size, std::align_val_t{64}));
+    blocks_.push_back({data, size});
+}
+
+auto Arena::do_allocate(const uz bytes, const uz alignment) -> void * {
+    while (current_ < blocks_.size()) {
+        const Block &block = blocks_[current_];
+        const uz aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= block.size) {
+            offset_ = aligned + bytes;
+            return block.data + aligned;
+        }
+        // Move on to the next block, the rest of this one is wasted.
+        used_ += block.size;
+        offset_ = 0;
+        ++current_;
+    }
+    addBlock(bytes + alignment);
+    return do_allocate(bytes, alignment);
+}
+
+auto Arena::do_is_equal(const memory_resource &other) const noexcept -> bool {
+    return this == &other;
+}
+
+/**
+ * @brief Release everything allocated so far, keeping the memory.
+ * @note If the last generation needed several blocks, they are merged
+ *       into one, so that the next generations fit in a single block.
+ **/
+auto Arena::reset() -> void {
+    if (blocks_.size() > 1) {
+        const uz total = reserved();
+        for (const Block &block : blocks_) {
+            ::operator delete(block.data, std::align_val_t{64});
+        }
+        blocks_.clear();
+        addBlock(total);
+    }
+    current_ = offset_ = used_ = 0;
+}
+
+/**
+ * @return bytes handed out since the last reset, alignment padding
+ *         and the wasted ends of the blocks included.
+ **/
+auto Arena::used() const noexcept -> uz {
+    return used_ + offset_;
+}
+
+/**
+ * @return bytes taken from the heap.
+ **/
+auto Arena::reserved() const noexcept -> uz {
+    uz total = 0;
+    for (const Block &block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+/**
+ * @return the arena of the calling thread.
+ **/
+auto Arena::local() -> Arena & {
+    thread_local Arena arena;
+    return arena;
+}
+
+static thread_local uz num_heap_allocations = 0;
+
+auto heapAllocations() noexcept -> uz {
+    return num_heap_allocations;
+}
+
+NoAllocationScope::NoAllocationScope() noexcept
+    : start_(heapAllocations()) {}
+
+NoAllocationScope::~NoAllocationScope() {
+    assert(allocations() == 0 and "heap allocation in a NoAllocationScope");
+}
+
+auto NoAllocationScope::allocations() const noexcept -> uz {
+    return heapAllocations() - start_;
+}
+
+}
+
+#ifdef JIANHAN_COUNT_ALLOCATIONS
+
+// Replacements of the global allocation functions, counting the allocations.
+// The default nothrow and array forms call these ones; the sized deletes
+// are defined as well, so that both ends of every allocation are ours.
+
+auto operator new(const std::size_t size) -> void * {
+    ++jianhan::v0::num_heap_allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+auto operator new(const std::size_t size, const std::align_val_t alignment) -> void * {
+    ++jianhan::v0::num_heap_allocations;
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void *ptr = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void *ptr) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::size_t) noexcept -> void {
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::size_t, std::align_val_t) noexcept -> void {
+    std::free(ptr);
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef JIANHAN_ARENA_HPP
+#define JIANHAN_ARENA_HPP
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "types.hpp"
+
+namespace jianhan::v0 {
+
+// Bump allocator for everything that lives for one generation: children,
+// candidate batches, scoring scratch. Memory is only given back in bulk
+// by reset(), which keeps the blocks, so a search loop that allocates
+// the same amount every generation stops touching the heap after the
+// first one. Destructors are never run.
+//
+// As a std::pmr::memory_resource, an arena can also back pmr containers.
+class Arena final : public std::pmr::memory_resource {
+public:
+    explicit Arena(uz block_size = 1 << 20);
+    ~Arena() override;
+
+    Arena(const Arena &) = delete;
+    auto operator=(const Arena &) -> Arena & = delete;
+
+    template<typename T> auto array(const uz n, const T &value) -> std::span<T> {
+        T *data = static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+        std::uninitialized_fill_n(data, n, value);
+        return {data, n};
+    }
+
+    auto reset() -> void;
+
+    [[nodiscard]] auto used() const noexcept -> uz;
+    [[nodiscard]] auto reserved() const noexcept -> uz;
+
+    [[nodiscard]] static auto local() -> Arena &;
+
+protected:
+    struct Block final {
+        std::byte *data;
+        uz size;
+    };
+
+    const uz block_size_;
+    std::vector<Block> blocks_{};
+    uz current_{0}; // index of the block being filled
+    uz offset_{0};  // in the current block
+    uz used_{0};    // in the previous blocks
+
+    auto do_allocate(uz bytes, uz alignment) -> void * override;
+    auto do_deallocate(void *, uz, uz) -> void override {}
+    [[nodiscard]] auto do_is_equal(const memory_resource &other) const noexcept -> bool override;
+
+    auto addBlock(uz min_size) -> void;
+};
+
+// Instrumentation of the heap: with JIANHAN_COUNT_ALLOCATIONS defined,
+// the global operator new counts the allocations of each thread;
+// otherwise the count is always 0.
+[[nodiscard]] auto heapAllocations() noexcept -> uz;
+
+// Asserts that the calling thread makes no heap allocation in a scope,
+// e.g. the body of a steady-state search loop.
+class NoAllocationScope final {
+public:
+    NoAllocationScope() noexcept;
+    ~NoAllocationScope();
+
+    NoAllocationScope(const NoAllocationScope &) = delete;
+    auto operator=(const NoAllocationScope &) -> NoAllocationScope & = delete;
+
+    [[nodiscard]] auto allocations() const noexcept -> uz;
+
+private:
+    const uz start_;
+};
+
+}
+
+#endif // JIANHAN_ARENA_HPP
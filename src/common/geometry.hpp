@@ -0,0 +1,133 @@
+#ifndef JIANHAN_GEOMETRY_HPP
+#define JIANHAN_GEOMETRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+
+#include "types.hpp"
+
+namespace jianhan::v0 {
+
+// Positions and key values share the key mappings of a layout, positions
+// must stay below the smallest key value (','), which bounds the number
+// of keys. Key values lie in [MIN_KEY_CODE, MAX_KEY_CODE) of a geometry.
+static constexpr uz MIN_KEY_CODE = 44;
+static constexpr uz MAX_KEY_COUNT = MIN_KEY_CODE;
+
+/**
+ * @brief A keyboard geometry: the key values to place and the physical
+ *        coordinates (row, column) of each position. Positions are numbered
+ *        in reading order, columns [0, COL_COUNT / 2) are the left hand.
+ * @note KEY_CNT_POW2 is the width of the position -> key table, which
+ *       sets the SIMD width of the layout operations (32 or 64 lanes).
+ *       MAX_KEY_CODE is the size of the key mappings, the key -> position
+ *       table must fit in two 32-byte blocks.
+ **/
+template<typename G> concept Geometry = requires {
+    { G::KEY_COUNT } -> std::convertible_to<uz>;
+    { G::COL_COUNT } -> std::convertible_to<uz>;
+    { G::ROW_COUNT } -> std::convertible_to<uz>;
+    { G::KEY_CNT_POW2 } -> std::convertible_to<uz>;
+    { G::MAX_KEY_CODE } -> std::convertible_to<uz>;
+    { G::KEY_CODES } -> std::convertible_to<std::array<KeyValue, G::KEY_COUNT>>;
+    { G::ROWS } -> std::convertible_to<std::array<Row, G::KEY_COUNT>>;
+    { G::COLS } -> std::convertible_to<std::array<Col, G::KEY_COUNT>>;
+} and G::KEY_COUNT <= MAX_KEY_COUNT
+  and (G::KEY_CNT_POW2 == 32 or G::KEY_CNT_POW2 == 64)
+  and G::KEY_COUNT <= G::KEY_CNT_POW2
+  and G::MAX_KEY_CODE <= MIN_KEY_CODE + 64
+  and G::MAX_KEY_CODE >= G::KEY_CNT_POW2;
+
+namespace geometry {
+
+// Coordinates of a rectangular grid of N keys, COLS keys per row.
+template<uz N, uz COLS> consteval auto gridRows() -> std::array<Row, N> {
+    std::array<Row, N> rows{};
+    for (uz i = 0; i < N; ++i) { rows[i] = static_cast<Row>(i / COLS); }
+    return rows;
+}
+
+template<uz N, uz COLS> consteval auto gridCols() -> std::array<Col, N> {
+    std::array<Col, N> cols{};
+    for (uz i = 0; i < N; ++i) { cols[i] = static_cast<Col>(i % COLS); }
+    return cols;
+}
+
+}
+
+// The three letter rows: the reference geometry.
+struct Geometry30 final {
+    static constexpr uz KEY_COUNT = 30;
+    static constexpr uz COL_COUNT = 10;
+    static constexpr uz ROW_COUNT = 3;
+    static constexpr uz KEY_CNT_POW2 = 32; // 30 -> 32
+    static constexpr uz MAX_KEY_CODE = 92; // 90 -> 92
+
+    static constexpr std::array<KeyValue, KEY_COUNT> KEY_CODES{
+        ',', '.', '/', ';', 'A', 'B', 'C', 'D', 'E', 'F',
+        'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+        'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    };
+
+    static constexpr auto ROWS = geometry::gridRows<KEY_COUNT, COL_COUNT>();
+    static constexpr auto COLS = geometry::gridCols<KEY_COUNT, COL_COUNT>();
+};
+
+// The number row above the three letter rows, positions [0, 10).
+struct Geometry40 final {
+    static constexpr uz KEY_COUNT = 40;
+    static constexpr uz COL_COUNT = 10;
+    static constexpr uz ROW_COUNT = 4;
+    static constexpr uz KEY_CNT_POW2 = 64;
+    static constexpr uz MAX_KEY_CODE = 92;
+
+    static constexpr std::array<KeyValue, KEY_COUNT> KEY_CODES{
+        ',', '.', '/', '0', '1', '2', '3', '4', '5', '6',
+        '7', '8', '9', ';', 'A', 'B', 'C', 'D', 'E', 'F',
+        'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+        'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    };
+
+    static constexpr auto ROWS = geometry::gridRows<KEY_COUNT, COL_COUNT>();
+    static constexpr auto COLS = geometry::gridCols<KEY_COUNT, COL_COUNT>();
+};
+
+// A split board: the three letter rows, 5 columns per hand, and two thumb
+// keys per hand below the inner columns, positions [30, 34).
+struct GeometrySplit34 final {
+    static constexpr uz KEY_COUNT = 34;
+    static constexpr uz COL_COUNT = 10;
+    static constexpr uz ROW_COUNT = 4;
+    static constexpr uz KEY_CNT_POW2 = 64;
+    static constexpr uz MAX_KEY_CODE = 93; // '\\' + 1
+
+    static constexpr std::array<KeyValue, KEY_COUNT> KEY_CODES{
+        ',', '-', '.', '/', ';', '=', 'A', 'B', 'C', 'D',
+        'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N',
+        'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X',
+        'Y', 'Z', '[', '\\',
+    };
+
+    static constexpr auto ROWS = []() -> std::array<Row, KEY_COUNT> {
+        auto rows = std::array<Row, KEY_COUNT>{};
+        std::ranges::copy(geometry::gridRows<30, COL_COUNT>(), rows.begin());
+        std::ranges::fill(rows.begin() + 30, rows.end(), 3);
+        return rows;
+    }();
+
+    static constexpr auto COLS = []() -> std::array<Col, KEY_COUNT> {
+        auto cols = std::array<Col, KEY_COUNT>{};
+        std::ranges::copy(geometry::gridCols<30, COL_COUNT>(), cols.begin());
+        std::ranges::copy(std::array<Col, 4>{3, 4, 5, 6}, cols.begin() + 30);
+        return cols;
+    }();
+};
+
+static_assert(Geometry<Geometry30>);
+static_assert(Geometry<Geometry40>);
+static_assert(Geometry<GeometrySplit34>);
+
+}
+
+#endif // JIANHAN_GEOMETRY_HPP
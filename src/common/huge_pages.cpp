@@ -0,0 +1,125 @@
+#include "huge_pages.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+
+namespace jianhan::v0 {
+
+static std::atomic<uz> num_hugetlb{0};
+static std::atomic<uz> num_transparent{0};
+static std::atomic<uz> num_fallback{0};
+static std::atomic<uz> num_small{0};
+
+static auto roundUp(const uz size, const uz alignment) noexcept -> uz {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+static auto mapAnonymous(const uz size, const int flags) noexcept -> void * {
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+/**
+ * @brief Map zero-initialized memory, with huge pages if large enough.
+ * @return nullptr if the mapping fails.
+ * @note The memory must be released by deallocateLarge() with the same size.
+ **/
+auto allocateLarge(const uz size) noexcept -> void * {
+    if (size < HUGE_PAGE_SIZE) {
+        ++num_small;
+        return mapAnonymous(std::max<uz>(1, size), 0);
+    }
+
+    const uz huge_size = roundUp(size, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+    if (void *addr = mapAnonymous(huge_size, MAP_HUGETLB)) {
+        ++num_hugetlb;
+        return addr;
+    }
+#endif
+
+    // Map one more huge page, then trim both ends to a 2 MB aligned range,
+    // since the kernel only backs aligned ranges with transparent huge pages.
+    auto *raw = static_cast<std::byte *>(mapAnonymous(huge_size + HUGE_PAGE_SIZE, 0));
+    if (raw == nullptr) { return nullptr; }
+    auto *addr = reinterpret_cast<std::byte *>(
+        roundUp(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE_SIZE)
+    );
+    if (const uz head = addr - raw; head > 0) {
+        munmap(raw, head);
+    }
+    if (const uz tail = raw + huge_size + HUGE_PAGE_SIZE - (addr + huge_size); tail > 0) {
+        munmap(addr + huge_size, tail);
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (madvise(addr, huge_size, MADV_HUGEPAGE) == 0) {
+        ++num_transparent;
+        return addr;
+    }
+#endif
+    ++num_fallback;
+    return addr;
+}
+
+auto deallocateLarge(void *addr, const uz size) noexcept -> void {
+    if (addr == nullptr) { return; }
+    munmap(addr, largeMappingSize(size));
+}
+
+/**
+ * @brief Length of the mapping made by allocateLarge(size), e.g. for
+ *        a memory policy that must cover its last huge page too.
+ **/
+auto largeMappingSize(const uz size) noexcept -> uz {
+    return size < HUGE_PAGE_SIZE ? std::max<uz>(1, size) : roundUp(size, HUGE_PAGE_SIZE);
+}
+
+auto hugePageStats() noexcept -> HugePageStats {
+    return {num_hugetlb.load(), num_transparent.load(), num_fallback.load(), num_small.load()};
+}
+
+/**
+ * @brief Bytes of the mapping containing addr actually backed by huge pages
+ *        (explicit or transparent), read from /proc/self/smaps.
+ * @return 0 if unknown, e.g. on systems without procfs.
+ * @note Transparent huge pages are only obtained once the memory is touched,
+ *       and may be split or collapsed later by the kernel.
+ **/
+auto hugePageBytes(const void *addr) -> uz {
+    const auto target = reinterpret_cast<uintptr_t>(addr);
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_mapping = false;
+    uz kilobytes = 0;
+
+    while (std::getline(smaps, line)) {
+        // Mapping headers start with "begin-end ", fields with "Name:".
+        const auto dash = line.find('-');
+        const auto space = line.find(' ');
+        uintptr_t begin = 0, end = 0;
+        if (dash != std::string::npos and dash < space
+            and std::from_chars(line.data(), line.data() + dash, begin, 16).ec == std::errc{}
+            and std::from_chars(line.data() + dash + 1, line.data() + space, end, 16).ec == std::errc{}) {
+            if (in_mapping) { break; }
+            in_mapping = begin <= target and target < end;
+            continue;
+        }
+        if (not in_mapping) { continue; }
+
+        for (const std::string_view field : {"AnonHugePages:", "Private_Hugetlb:", "Shared_Hugetlb:"}) {
+            if (line.starts_with(field)) {
+                const auto digits = line.find_first_not_of(' ', field.size());
+                uz value = 0;
+                std::from_chars(line.data() + digits, line.data() + line.size(), value);
+                kilobytes += value;
+            }
+        }
+    }
+    return kilobytes * 1024;
+}
+
+}
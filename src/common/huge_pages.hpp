@@ -0,0 +1,54 @@
+#ifndef JIANHAN_HUGE_PAGES_HPP
+#define JIANHAN_HUGE_PAGES_HPP
+
+#include <new>
+
+#include "types.hpp"
+
+namespace jianhan::v0 {
+
+static constexpr uz HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// How the large allocations were backed, since the start of the process.
+struct HugePageStats final {
+    uz hugetlb;     // explicit huge pages (MAP_HUGETLB)
+    uz transparent; // 2 MB aligned and advised (MADV_HUGEPAGE)
+    uz fallback;    // neither is available: regular pages
+    uz small;       // below HUGE_PAGE_SIZE: regular pages
+};
+
+// Large allocations (populations, scoring tables, caches) are backed by
+// 2 MB pages when possible, to save TLB misses in random-access loops:
+// explicit huge pages are tried first, then transparent huge pages.
+// Allocations are whole mappings, so they suit large blocks only.
+[[nodiscard]] auto allocateLarge(uz size) noexcept -> void *;
+auto deallocateLarge(void *addr, uz size) noexcept -> void;
+[[nodiscard]] auto largeMappingSize(uz size) noexcept -> uz;
+
+[[nodiscard]] auto hugePageStats() noexcept -> HugePageStats;
+[[nodiscard]] auto hugePageBytes(const void *addr) -> uz;
+
+template<typename T> class HugePageAllocator {
+public:
+    using value_type = T;
+
+    HugePageAllocator() noexcept = default;
+
+    template<typename U> explicit HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+    auto allocate(const uz n) -> T * {
+        void *addr = allocateLarge(n * sizeof(T));
+        if (addr == nullptr) { throw std::bad_alloc(); }
+        return static_cast<T *>(addr);
+    }
+
+    auto deallocate(T *addr, const uz n) noexcept -> void {
+        deallocateLarge(addr, n * sizeof(T));
+    }
+
+    auto operator==(const HugePageAllocator &) const noexcept -> bool = default;
+};
+
+}
+
+#endif // JIANHAN_HUGE_PAGES_HPP
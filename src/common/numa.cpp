@@ -0,0 +1,199 @@
+#include "numa.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "huge_pages.hpp"
+#include "utils.hpp"
+
+namespace jianhan::v0 {
+
+// From <numaif.h>, which is only shipped with libnuma.
+static constexpr int MPOL_PREFERRED_ = 1;
+static constexpr unsigned MPOL_MF_MOVE_ = 1u << 1;
+
+static auto allowedCpus() -> std::vector<unsigned> {
+    std::vector<unsigned> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) { cpus.emplace_back(cpu); }
+        }
+    }
+    if (cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            cpus.emplace_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @brief Detect the topology.
+ * @param mode: SingleNode forces a single node holding all the allowed CPUs.
+ **/
+NumaTopology::NumaTopology(const NumaMode mode)
+    : mode_(mode) {
+    const std::vector<unsigned> allowed = allowedCpus();
+
+    if (mode == NumaMode::Local) {
+        const std::filesystem::path root = "/sys/devices/system/node";
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator(root, error)) {
+            const std::string name = entry.path().filename().string();
+            int id = -1;
+            if (not name.starts_with("node")
+                or std::from_chars(name.data() + 4, name.data() + name.size(), id).ec != std::errc{}) {
+                continue;
+            }
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            std::getline(file, list);
+
+            Node node{id, {}};
+            std::ranges::copy_if(parseCpuList(list), std::back_inserter(node.cpus),
+                                 [&allowed](const unsigned cpu) -> bool {
+                                     return std::ranges::binary_search(allowed, cpu);
+                                 });
+            if (not node.cpus.empty()) {
+                nodes_.emplace_back(std::move(node));
+            }
+        }
+        std::ranges::sort(nodes_, {}, &Node::id);
+    }
+
+    if (nodes_.empty()) {
+        nodes_.push_back({-1, allowed});
+        mode_ = NumaMode::SingleNode;
+    }
+    for (const Node &node : nodes_) {
+        num_cpus_ += node.cpus.size();
+    }
+}
+
+auto NumaTopology::mode() const noexcept -> NumaMode {
+    return mode_;
+}
+
+auto NumaTopology::numNodes() const noexcept -> uz {
+    return nodes_.size();
+}
+
+auto NumaTopology::numCpus() const noexcept -> uz {
+    return num_cpus_;
+}
+
+/**
+ * @return the OS id of the node, or -1 in the SingleNode mode.
+ **/
+auto NumaTopology::nodeId(const uz node) const noexcept -> int {
+    return nodes_[node].id;
+}
+
+auto NumaTopology::cpus(const uz node) const noexcept -> std::span<const unsigned> {
+    return nodes_[node].cpus;
+}
+
+/**
+ * @brief Workers are dealt to the nodes in turn, so that any number
+ *        of workers uses the memory bandwidth of all the nodes.
+ **/
+auto NumaTopology::nodeOf(const uz worker) const noexcept -> uz {
+    return worker % nodes_.size();
+}
+
+auto NumaTopology::cpuOf(const uz worker) const noexcept -> unsigned {
+    const auto node_cpus = cpus(nodeOf(worker));
+    return node_cpus[worker / nodes_.size() % node_cpus.size()];
+}
+
+/**
+ * @brief Parse a sysfs CPU list, e.g. "0-3,8,10-11".
+ * @return the CPUs in ascending order, malformed items are skipped.
+ **/
+auto NumaTopology::parseCpuList(const std::string_view list) -> std::vector<unsigned> {
+    std::vector<unsigned> cpus;
+    for (const auto item : list | std::views::split(',')) {
+        const std::string_view range(item.begin(), item.end());
+        const auto dash = range.find('-');
+        const std::string_view first = range.substr(0, dash);
+        const std::string_view last = dash == std::string_view::npos ? first : range.substr(dash + 1);
+
+        unsigned beg = 0, end = 0;
+        if (std::from_chars(first.data(), first.data() + first.size(), beg).ec != std::errc{}
+            or std::from_chars(last.data(), last.data() + last.size(), end).ec != std::errc{}) {
+            continue;
+        }
+        for (unsigned cpu = beg; cpu <= end; ++cpu) {
+            cpus.emplace_back(cpu);
+        }
+    }
+    std::ranges::sort(cpus);
+    return cpus;
+}
+
+/**
+ * @brief Pin the calling thread to a CPU.
+ * @return false if the CPU is not available.
+ **/
+auto pinThreadToCpu(const unsigned cpu) noexcept -> bool {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+ScopedPin::ScopedPin(const unsigned cpu) noexcept
+    : saved_(new (std::nothrow) std::byte[sizeof(cpu_set_t)]), pinned_(false) {
+    if (saved_ and sched_getaffinity(0, sizeof(cpu_set_t), reinterpret_cast<cpu_set_t *>(saved_.get())) == 0) {
+        pinned_ = pinThreadToCpu(cpu);
+    }
+}
+
+ScopedPin::~ScopedPin() {
+    if (pinned_) {
+        sched_setaffinity(0, sizeof(cpu_set_t), reinterpret_cast<const cpu_set_t *>(saved_.get()));
+    }
+}
+
+auto ScopedPin::pinned() const noexcept -> bool {
+    return pinned_;
+}
+
+/**
+ * @brief Prefer a node for the pages of a (page-aligned) range,
+ *        moving the pages already touched.
+ * @return false if the kernel does not support it, e.g. without NUMA.
+ **/
+auto bindMemoryToNode(void *addr, const uz size, const int node_id) noexcept -> bool {
+    if (node_id < 0) { return false; }
+    std::array<unsigned long, 16> mask{};
+    constexpr uz BITS = sizeof(unsigned long) * 8;
+    if (static_cast<uz>(node_id) >= mask.size() * BITS) { return false; }
+    mask[node_id / BITS] |= 1ul << (node_id % BITS);
+    return syscall(SYS_mbind, addr, size, MPOL_PREFERRED_, mask.data(),
+                   mask.size() * BITS, MPOL_MF_MOVE_) == 0;
+}
+
+/**
+ * @brief Map whole pages (huge pages if large enough),
+ *        preferably on a node (-1: any node).
+ * @return nullptr if the mapping fails.
+ **/
+auto allocateOnNode(const uz size, const int node_id) noexcept -> void * {
+    void *addr = allocateLarge(size);
+    if (addr == nullptr) { return nullptr; }
+    bindMemoryToNode(addr, largeMappingSize(size), node_id); // best effort, over whole huge pages
+    return addr;
+}
+
+auto deallocateOnNode(void *addr, const uz size) noexcept -> void {
+    deallocateLarge(addr, size);
+}
+
+}
@@ -0,0 +1,135 @@
+#ifndef JIANHAN_NUMA_HPP
+#define JIANHAN_NUMA_HPP
+
+#include <memory>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+
+namespace jianhan::v0 {
+
+enum class NumaMode : u8 {
+    SingleNode, // all the CPUs on one node, memory placement is left to the OS
+    Local,      // workers spread over the nodes, memory bound to the worker's node
+};
+
+// NUMA nodes and the CPUs this process may run on, read from sysfs
+// (no dependency on libnuma). Machines without NUMA information,
+// or the SingleNode mode, are seen as a single node.
+class NumaTopology final {
+public:
+    explicit NumaTopology(NumaMode mode = NumaMode::Local);
+
+    [[nodiscard]] auto mode() const noexcept -> NumaMode;
+    [[nodiscard]] auto numNodes() const noexcept -> uz;
+    [[nodiscard]] auto numCpus() const noexcept -> uz;
+    [[nodiscard]] auto nodeId(uz node) const noexcept -> int;
+    [[nodiscard]] auto cpus(uz node) const noexcept -> std::span<const unsigned>;
+
+    [[nodiscard]] auto nodeOf(uz worker) const noexcept -> uz;
+    [[nodiscard]] auto cpuOf(uz worker) const noexcept -> unsigned;
+
+    [[nodiscard]] static auto parseCpuList(std::string_view list) -> std::vector<unsigned>;
+
+protected:
+    struct Node final {
+        int id; // -1: unknown, do not bind memory
+        std::vector<unsigned> cpus;
+    };
+
+    NumaMode mode_;
+    std::vector<Node> nodes_{};
+    uz num_cpus_{0};
+};
+
+auto pinThreadToCpu(unsigned cpu) noexcept -> bool;
+auto bindMemoryToNode(void *addr, uz size, int node_id) noexcept -> bool;
+
+// Pins the calling thread to a CPU, restoring its affinity on destruction.
+class ScopedPin final {
+public:
+    explicit ScopedPin(unsigned cpu) noexcept;
+    ~ScopedPin();
+
+    ScopedPin() = delete;
+    ScopedPin(const ScopedPin &) = delete;
+    auto operator=(const ScopedPin &) -> ScopedPin & = delete;
+
+    [[nodiscard]] auto pinned() const noexcept -> bool;
+
+private:
+    std::unique_ptr<std::byte[]> saved_; // cpu_set_t
+    bool pinned_;
+};
+
+auto allocateOnNode(uz size, int node_id) noexcept -> void *;
+auto deallocateOnNode(void *addr, uz size) noexcept -> void;
+
+// Allocates whole pages (huge pages when large enough) bound to a NUMA node,
+// for large per-worker buffers such as population slices; node -1 leaves
+// placement to the OS.
+template<typename T> class NodeAllocator {
+public:
+    using value_type = T;
+
+    explicit NodeAllocator(const int node_id = -1) noexcept : node_id_(node_id) {}
+
+    template<typename U> explicit NodeAllocator(const NodeAllocator<U> &other) noexcept
+        : node_id_(other.nodeId()) {}
+
+    auto allocate(const uz n) -> T * {
+        void *addr = allocateOnNode(n * sizeof(T), node_id_);
+        if (addr == nullptr) { throw std::bad_alloc(); }
+        return static_cast<T *>(addr);
+    }
+
+    auto deallocate(T *addr, const uz n) noexcept -> void {
+        deallocateOnNode(addr, n * sizeof(T));
+    }
+
+    [[nodiscard]] auto nodeId() const noexcept -> int {
+        return node_id_;
+    }
+
+    auto operator==(const NodeAllocator &other) const noexcept -> bool = default;
+
+private:
+    int node_id_;
+};
+
+// One copy of a read-mostly object (e.g. a scoring table) per node, each
+// constructed by a thread pinned on its node, so that the first touch
+// of its memory (including its own heap allocations) is node-local.
+template<typename T> class NodeReplicas final {
+public:
+    NodeReplicas(const NumaTopology &topology, const T &value) {
+        replicas_.resize(topology.numNodes());
+        for (uz node = 0; node < topology.numNodes(); ++node) {
+            const unsigned cpu = topology.cpus(node).front();
+            std::jthread([this, node, cpu, &value]() -> void {
+                pinThreadToCpu(cpu);
+                replicas_[node] = std::make_unique<const T>(value);
+            }).join();
+        }
+    }
+
+    NodeReplicas() = delete;
+
+    [[nodiscard]] auto get(const uz node) const noexcept -> const T & {
+        return *replicas_[node];
+    }
+
+    [[nodiscard]] auto size() const noexcept -> uz {
+        return replicas_.size();
+    }
+
+private:
+    std::vector<std::unique_ptr<const T>> replicas_{};
+};
+
+}
+
+#endif // JIANHAN_NUMA_HPP
@@ -0,0 +1,141 @@
+#ifndef JIANHAN_RING_BUFFER_HPP
+#define JIANHAN_RING_BUFFER_HPP
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+
+#include "types.hpp"
+
+namespace jianhan::v0 {
+
+static constexpr uz CACHE_LINE = 64;
+
+/**
+ * @brief Bounded lock-free queue for a single producer and a single consumer.
+ * @tparam T: element type, should be cheap to move (e.g. a pointer).
+ * @note Each side caches the index of the other side, so that the shared
+ *       cache lines are only touched when the queue looks full or empty.
+ **/
+template<typename T> class SpscRing final {
+public:
+    explicit SpscRing(const uz capacity)
+        : mask_(std::bit_ceil(std::max<uz>(2, capacity)) - 1),
+          slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    SpscRing() = delete;
+
+    auto tryPush(T value) noexcept -> bool {
+        const uz tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) { return false; }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto tryPop() noexcept -> std::optional<T> {
+        const uz head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) { return std::nullopt; }
+        }
+        T value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> uz {
+        return mask_ + 1;
+    }
+
+private:
+    const uz mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(CACHE_LINE) std::atomic<uz> head_{0}; // written by the consumer
+    uz tail_cache_{0};
+    alignas(CACHE_LINE) std::atomic<uz> tail_{0}; // written by the producer
+    uz head_cache_{0};
+};
+
+/**
+ * @brief Bounded lock-free queue for multiple producers and consumers
+ *        (Dmitry Vyukov's algorithm, one sequence number per slot).
+ * @tparam T: element type, should be cheap to move (e.g. a pointer).
+ **/
+template<typename T> class MpmcRing final {
+public:
+    explicit MpmcRing(const uz capacity)
+        : mask_(std::bit_ceil(std::max<uz>(2, capacity)) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+        for (uz i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing() = delete;
+
+    auto tryPush(T value) noexcept -> bool {
+        uz pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots_[pos & mask_];
+            const uz seq = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    auto tryPop() noexcept -> std::optional<T> {
+        uz pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots_[pos & mask_];
+            const uz seq = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T value = std::move(slot.value);
+                    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return value;
+                }
+            } else if (diff < 0) {
+                return std::nullopt; // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> uz {
+        return mask_ + 1;
+    }
+
+private:
+    struct Slot final {
+        std::atomic<uz> sequence;
+        T value;
+    };
+
+    const uz mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(CACHE_LINE) std::atomic<uz> head_{0};
+    alignas(CACHE_LINE) std::atomic<uz> tail_{0};
+};
+
+}
+
+#endif // JIANHAN_RING_BUFFER_HPP
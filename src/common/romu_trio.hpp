@@ -1,6 +1,7 @@
 #ifndef JIANHAN_ROMUTRIO_HPP
 #define JIANHAN_ROMUTRIO_HPP
 
+#include <array>
 #include <random>
 
 namespace jianhan::v0 {
@@ -36,6 +37,7 @@ private:
 class RomuTrio64 {
 public:
     using result_type = uint64_t;
+    using state_type = std::array<uint64_t, 3>;
 
     RomuTrio64() : RomuTrio64(42) {}
 
@@ -46,14 +48,22 @@ public:
     auto seed(const uint64_t seed) -> void {
         // SplitMix64 is used to seed the PRNG, which is recommended
         // by the authors of RomuTrio: https://www.romu-random.org/
-        static SplitMix64 initializer_(42);
+        // A local initializer keeps seeding thread-safe.
+        SplitMix64 initializer(seed);
+        initializer.warmup();
 
-        initializer_.seed(seed);
-        initializer_.warmup();
+        x_state_ = initializer();
+        y_state_ = initializer();
+        z_state_ = initializer();
+    }
+
+    // The raw (x, y, z) state, for checkpointing.
+    [[nodiscard]] auto state() const noexcept -> state_type {
+        return {x_state_, y_state_, z_state_};
+    }
 
-        x_state_ = initializer_();
-        y_state_ = initializer_();
-        z_state_ = initializer_();
+    auto setState(const state_type &state) noexcept -> void {
+        x_state_ = state[0], y_state_ = state[1], z_state_ = state[2];
     }
 
     auto operator()() -> result_type {
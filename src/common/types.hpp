@@ -29,8 +29,10 @@ namespace jianhan::v0 {
 
 using f16 = std::bfloat16_t;
 using fz = std::float32_t;
+using f64 = std::float64_t;
 using u8 = uint_fast8_t;
 using uz = size_t;
+using u128 = unsigned __int128;
 
 using KeyValue = uint8_t; // Key Code (ASCII), ∈ [65, 90] ∪ {44, 46, 47, 59}
 using Position = u8; // Position number, ∈ [0, 29]
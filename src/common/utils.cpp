@@ -1,7 +1,16 @@
 #include "utils.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
 namespace jianhan::v0 {
 
+// The project root is shared by all the geometries. Both are constant
+// initialized: loading the library neither allocates nor touches the disk.
+static std::mutex root_mutex;
+static std::string root_directory;
+
 /*!
  * @brief Make absolute path from sub path.
  * @param sub_path relative path to the project root directory,
@@ -9,16 +18,38 @@ namespace jianhan::v0 {
  * @return the absolute path to sub_path (e.g. "c:/jianhan/folder/file.txt").
  * @note This function does not check the legality of input and output paths.
  */
-auto Util::mkAbsPath(std::string_view sub_path) -> std::string {
-    static const std::string ROOT = findProjectDirectory();
-    return fmt::format("{}/{}", ROOT, sub_path);
+template<Geometry G> auto BasicUtil<G>::mkAbsPath(std::string_view sub_path) -> std::string {
+    return fmt::format("{}/{}", projectDirectory(), sub_path);
+}
+
+/*!
+ * @brief Set the root directory of the project explicitly,
+ *        which skips the lookup of projectDirectory().
+ * @param path: the root directory, not checked (e.g. "c:/jianhan").
+ */
+template<Geometry G> auto BasicUtil<G>::setProjectDirectory(const std::string_view path) -> void {
+    const std::scoped_lock lock(root_mutex);
+    root_directory = path;
+}
+
+/*!
+ * @brief The root directory of the project, looked up on first use only:
+ *        $JIANHAN_ROOT if set, else found by findProjectDirectory().
+ */
+template<Geometry G> auto BasicUtil<G>::projectDirectory() -> std::string {
+    const std::scoped_lock lock(root_mutex);
+    if (root_directory.empty()) {
+        const char *env = std::getenv("JIANHAN_ROOT");
+        root_directory = env != nullptr and *env != '\0' ? env : findProjectDirectory();
+    }
+    return root_directory;
 }
 
 /*!
  * @brief Find the root directory of project according to necessary files.
  * @return the absolute path to the root directory of project (e.g. "c:/jianhan").
  */
-auto Util::findProjectDirectory() -> std::string {
+template<Geometry G> auto BasicUtil<G>::findProjectDirectory() -> std::string {
     static constexpr size_t MAX_DEPTH = 8;
 
     auto path = std::filesystem::current_path();
@@ -37,52 +68,46 @@ auto Util::findProjectDirectory() -> std::string {
     throw std::runtime_error("missing necessary files");
 }
 
-auto Util::haveAllNecessaryFiles(const std::filesystem::path &path) -> bool {
-    for (const auto &[sub_dir_name, file_names] : NECESSARY_FILES) {
-        const std::filesystem::path curr_dir = path / sub_dir_name;
-        if (not exists(curr_dir) or not is_directory(curr_dir)) {
-            return false;
-        }
-        for (const std::string &file_name : file_names) {
-            if (not exists(curr_dir / file_name)) {
-                return false;
-            }
-        }
-    }
-    return true;
+template<Geometry G> auto BasicUtil<G>::haveAllNecessaryFiles(const std::filesystem::path &path) -> bool {
+    return std::ranges::all_of(NECESSARY_FILES, [&](const std::string_view file) -> bool {
+        return is_regular_file(path / file);
+    });
 }
 
-auto Util::isKeyValueLegal(const KeyValue val) noexcept -> bool {
-    return ('A' <= val and val <= 'Z')
-           or val == ',' or val == '.'
-           or val == '/' or val == ';';
+template<Geometry G> auto BasicUtil<G>::isKeyValueLegal(const KeyValue val) noexcept -> bool {
+    return val < G::MAX_KEY_CODE and LEGAL_KEY_CODES[val];
 }
 
-auto Util::isPositionLegal(const Position pos) noexcept -> bool {
-    return pos < KEY_COUNT;
+template<Geometry G> auto BasicUtil<G>::isPositionLegal(const Position pos) noexcept -> bool {
+    return pos < G::KEY_COUNT;
 }
 
-auto Util::isColLegal(const Col col) noexcept -> bool {
-    return col < COL_COUNT;
+template<Geometry G> auto BasicUtil<G>::isColLegal(const Col col) noexcept -> bool {
+    return col < G::COL_COUNT;
 }
 
-auto Util::isRowLegal(const Row row) noexcept -> bool {
-    return row < ROW_COUNT;
+template<Geometry G> auto BasicUtil<G>::isRowLegal(const Row row) noexcept -> bool {
+    return row < G::ROW_COUNT;
 }
 
-auto Util::coord2pos(const Row row, const Col col) noexcept -> Position {
+template<Geometry G> auto BasicUtil<G>::coord2pos(const Row row, const Col col) noexcept -> Position {
     assert(isRowLegal(row) and isColLegal(col));
-    return row * COL_COUNT + col;
+    assert(POSITION_AT[row * G::COL_COUNT + col] != NO_POSITION);
+    return POSITION_AT[row * G::COL_COUNT + col];
 }
 
-auto Util::pos2col(const Position pos) noexcept -> Col {
+template<Geometry G> auto BasicUtil<G>::pos2col(const Position pos) noexcept -> Col {
     assert(isPositionLegal(pos));
-    return pos % COL_COUNT;
+    return G::COLS[pos];
 }
 
-auto Util::pos2row(const Position pos) noexcept -> Row {
+template<Geometry G> auto BasicUtil<G>::pos2row(const Position pos) noexcept -> Row {
     assert(isPositionLegal(pos));
-    return pos / COL_COUNT;
+    return G::ROWS[pos];
 }
 
+template class BasicUtil<Geometry30>;
+template class BasicUtil<Geometry40>;
+template class BasicUtil<GeometrySplit34>;
+
 }
@@ -7,21 +7,21 @@
 #include <string>
 #include <ranges>
 #include <memory>
+#include <string_view>
 #include <filesystem>
 
+#include "geometry.hpp"
 #include "types.hpp"
 
 namespace jianhan::v0 {
 
-static constexpr uz KEY_COUNT = 30;
-static constexpr uz COL_COUNT = 10;
-static constexpr uz ROW_COUNT = 3;
+// The constants of the reference geometry, used wherever
+// the keyboard is not a template parameter.
+static constexpr uz KEY_COUNT = Geometry30::KEY_COUNT;
+static constexpr uz COL_COUNT = Geometry30::COL_COUNT;
+static constexpr uz ROW_COUNT = Geometry30::ROW_COUNT;
 
-static constexpr std::array<KeyValue, KEY_COUNT> KEY_CODES{
-    ',', '.', '/', ';', 'A', 'B', 'C', 'D', 'E', 'F',
-    'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
-    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
-};
+static constexpr std::array<KeyValue, KEY_COUNT> KEY_CODES = Geometry30::KEY_CODES;
 
 // @formatter:off
 static constexpr std::array<Position, KEY_COUNT> POSITIONS{
@@ -31,12 +31,20 @@ static constexpr std::array<Position, KEY_COUNT> POSITIONS{
 };
 // @formatter:on
 
-static constexpr uz KEY_CNT_POW2 = 32; // 30 -> 32
-static constexpr uz MAX_KEY_CODE = 92; // 90 -> 92
+static constexpr uz KEY_CNT_POW2 = Geometry30::KEY_CNT_POW2;
+static constexpr uz MAX_KEY_CODE = Geometry30::MAX_KEY_CODE;
 
-class Util final {
+template<Geometry G> class BasicUtil final {
 public:
+    // 0, 1, ..., KEY_COUNT - 1
+    static constexpr auto POSITIONS = []() -> std::array<Position, G::KEY_COUNT> {
+        std::array<Position, G::KEY_COUNT> positions{};
+        for (uz i = 0; i < G::KEY_COUNT; ++i) { positions[i] = static_cast<Position>(i); }
+        return positions;
+    }();
+
     static auto mkAbsPath(std::string_view sub_path) -> std::string;
+    static auto setProjectDirectory(std::string_view path) -> void;
 
     static auto isKeyValueLegal(KeyValue val) noexcept -> bool;
     static auto isPositionLegal(Position pos) noexcept -> bool;
@@ -48,15 +56,36 @@ public:
     static auto pos2row(Position pos) noexcept -> Row;
 
 private:
-    using NecessaryFiles = std::pair<std::string, std::vector<std::string>>;
-    inline static const std::vector<NecessaryFiles> NECESSARY_FILES{
-        {"conf", {"layouts.toml"}},
+    // Relative to the project root, nothing to construct at load time.
+    static constexpr std::array<std::string_view, 1> NECESSARY_FILES{
+        "conf/layouts.toml",
     };
 
+    // Whether each byte is a key value of the geometry.
+    static constexpr auto LEGAL_KEY_CODES = []() -> std::array<bool, G::MAX_KEY_CODE> {
+        std::array<bool, G::MAX_KEY_CODE> legal{};
+        for (const KeyValue val : G::KEY_CODES) { legal[val] = true; }
+        return legal;
+    }();
+
+    // Position at each (row, column), NO_POSITION where there is no key.
+    static constexpr Position NO_POSITION = 0xff;
+    static constexpr auto POSITION_AT = []() -> std::array<Position, G::ROW_COUNT * G::COL_COUNT> {
+        std::array<Position, G::ROW_COUNT * G::COL_COUNT> at{};
+        std::ranges::fill(at, NO_POSITION);
+        for (uz pos = 0; pos < G::KEY_COUNT; ++pos) {
+            at[G::ROWS[pos] * G::COL_COUNT + G::COLS[pos]] = static_cast<Position>(pos);
+        }
+        return at;
+    }();
+
+    static auto projectDirectory() -> std::string;
     static auto findProjectDirectory() -> std::string;
     static auto haveAllNecessaryFiles(const std::filesystem::path &path) -> bool;
 };
 
+using Util = BasicUtil<Geometry30>;
+
 }
 
 #endif // JIANHAN_UTILS_HPP
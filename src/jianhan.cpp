@@ -1,6 +1,348 @@
 #include "jianhan.hpp"
 
+#include <atomic>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include "search/search_anneal.hpp"
+#include "search/search_deterministic.hpp"
+
+using namespace jianhan::v0;
+
+struct jh_config final {
+    std::shared_ptr<const layout::Config> config;
+};
+
+struct jh_manager final {
+    layout::Manager manager;
+};
+
+struct jh_evaluator final {
+    score::Evaluator evaluator;
+};
+
+struct jh_run final {
+    search::Annealer annealer; // refers to the evaluator, not owned
+    std::shared_ptr<const layout::Config> config;
+    jh_run_options options;
+    jh_progress_fn progress{nullptr};
+    void *user_data{nullptr};
+    search::Elites results{};
+};
+
+static_assert(JH_KEY_COUNT == KEY_COUNT);
+
+namespace {
+
+thread_local std::string last_error;
+std::atomic<size_t> default_num_threads{1};
+
+auto fail(const jh_status status, const std::string_view msg) -> jh_status {
+    last_error = msg;
+    return status;
+}
+
+/**
+ * @brief Run a function of the interface, exceptions must not cross it.
+ * @return the status returned by f, or the one of the exception it throws.
+ **/
+template<typename F> auto guard(F &&f) noexcept -> jh_status {
+    try {
+        return f();
+    } catch (const std::invalid_argument &e) {
+        return fail(JH_INVALID_ARGUMENT, e.what());
+    } catch (const std::bad_alloc &) {
+        return fail(JH_OUT_OF_MEMORY, "out of memory");
+    } catch (const std::exception &e) {
+        return fail(JH_INTERNAL_ERROR, e.what());
+    } catch (...) {
+        return fail(JH_INTERNAL_ERROR, "unknown exception");
+    }
+}
+
+auto numThreads(const size_t num_threads) noexcept -> uz {
+    const size_t n = num_threads != 0 ? num_threads : default_num_threads.load();
+    return n != 0 ? n : std::max(1u, std::thread::hardware_concurrency());
+}
+
+auto layoutString(const char *const layouts, const size_t i) noexcept -> std::string_view {
+    return {layouts + i * KEY_COUNT, KEY_COUNT};
+}
+
+auto layoutSpan(char *const layouts, const size_t i) noexcept -> std::span<char, KEY_COUNT> {
+    return std::span<char, KEY_COUNT>(layouts + i * KEY_COUNT, KEY_COUNT);
+}
+
+auto illegalLayout(const size_t i, const ParseError error) -> jh_status {
+    static constexpr std::array<std::string_view, 3> REASONS{
+        "incorrect length", "invalid key value", "duplicate key values"
+    };
+    return fail(JH_INVALID_ARGUMENT, fmt::format(
+        "illegal layout string at index {:d}: {:s}", i, REASONS[static_cast<uz>(error)]
+    ));
+}
+
+}
+
 int add(const int a, const int b) {
     return a + b;
 }
 
+const char *jh_last_error(void) {
+    return last_error.c_str();
+}
+
+void jh_set_num_threads(const size_t num_threads) {
+    default_num_threads = num_threads;
+}
+
+jh_status jh_config_new(const char *const toml, const size_t size, jh_config **const config) {
+    if ((toml == nullptr and size > 0) or config == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_config_new()");
+    }
+    return guard([&]() -> jh_status {
+        layout::toml_t parsed;
+        try {
+            parsed = toml::literals::operator""_toml(toml == nullptr ? "" : toml, size);
+        } catch (const std::bad_alloc &) {
+            throw;
+        } catch (const std::exception &e) {
+            return fail(JH_INVALID_ARGUMENT, e.what());
+        }
+        *config = new jh_config{std::make_shared<const layout::Config>(parsed)};
+        return JH_OK;
+    });
+}
+
+jh_status jh_config_new_default(jh_config **const config) {
+    if (config == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_config_new_default()");
+    }
+    return guard([&]() -> jh_status {
+        *config = new jh_config{std::make_shared<const layout::Config>(
+            layout::Config::fromStatic<layout::static_config::DEFAULT>()
+        )};
+        return JH_OK;
+    });
+}
+
+void jh_config_free(jh_config *const config) {
+    delete config;
+}
+
+jh_status jh_manager_new(const jh_config *const config, const uint64_t seed, jh_manager **const manager) {
+    if (manager == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_manager_new()");
+    }
+    return guard([&]() -> jh_status {
+        *manager = config != nullptr ? new jh_manager{layout::Manager(*config->config)}
+                                     : new jh_manager{layout::Manager()};
+        (*manager)->manager.seed(seed);
+        return JH_OK;
+    });
+}
+
+void jh_manager_free(jh_manager *const manager) {
+    delete manager;
+}
+
+jh_status jh_manager_create(jh_manager *const manager, char *const layouts, const size_t count) {
+    if (manager == nullptr or (layouts == nullptr and count > 0)) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_manager_create()");
+    }
+    return guard([&]() -> jh_status {
+        for (size_t i = 0; i < count; ++i) {
+            manager->manager.create().writeTo(layoutSpan(layouts, i));
+        }
+        return JH_OK;
+    });
+}
+
+/**
+ * @brief Mutate each parent into the child at the same index,
+ *        parents and children may be the same buffer.
+ **/
+jh_status jh_manager_mutate(jh_manager *const manager, const char *const parents,
+                            char *const children, const size_t count) {
+    if (manager == nullptr or ((parents == nullptr or children == nullptr) and count > 0)) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_manager_mutate()");
+    }
+    return guard([&]() -> jh_status {
+        for (size_t i = 0; i < count; ++i) {
+            auto layout = Layout::parse(layoutString(parents, i));
+            if (not layout) {
+                return illegalLayout(i, layout.error());
+            }
+            if (not manager->manager.canManage(*layout)) {
+                return fail(JH_INVALID_ARGUMENT, fmt::format(
+                    "layout at index {:d} does not match the configuration of the manager", i
+                ));
+            }
+            std::ignore = manager->manager.mutate(*layout);
+            layout->writeTo(layoutSpan(children, i));
+        }
+        return JH_OK;
+    });
+}
+
+jh_status jh_evaluator_new(const jh_bigram *const bigrams, const size_t num_bigrams,
+                           const float *const costs, jh_evaluator **const evaluator) {
+    if ((bigrams == nullptr and num_bigrams > 0) or costs == nullptr or evaluator == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_evaluator_new()");
+    }
+    return guard([&]() -> jh_status {
+        std::vector<score::Bigram> samples(num_bigrams);
+        for (size_t i = 0; i < num_bigrams; ++i) {
+            samples[i] = {bigrams[i].first, bigrams[i].second, bigrams[i].freq};
+        }
+        // Rows of KEY_COUNT costs, padded to KEY_CNT_POW2.
+        auto padded = std::make_unique<score::CostMatrix>();
+        padded->fill(0);
+        for (uz pos1 = 0; pos1 < KEY_COUNT; ++pos1) {
+            std::copy_n(costs + pos1 * KEY_COUNT, KEY_COUNT, padded->begin() + pos1 * KEY_CNT_POW2);
+        }
+        *evaluator = new jh_evaluator{score::Evaluator(std::move(samples), *padded)};
+        return JH_OK;
+    });
+}
+
+void jh_evaluator_free(jh_evaluator *const evaluator) {
+    delete evaluator;
+}
+
+jh_status jh_evaluator_score(const jh_evaluator *const evaluator, const char *const layouts,
+                             const size_t count, float *const scores) {
+    if (evaluator == nullptr or ((layouts == nullptr or scores == nullptr) and count > 0)) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_evaluator_score()");
+    }
+    return guard([&]() -> jh_status {
+        const score::Evaluator &scorer = evaluator->evaluator;
+        const int num_threads = static_cast<int>(numThreads(0));
+
+        // Index of the first illegal layout, count if none.
+        std::atomic<size_t> first_illegal{count};
+#pragma omp parallel for schedule(static) num_threads(num_threads) shared(scorer, layouts, scores, first_illegal) firstprivate(count) default(none)
+        for (size_t i = 0; i < count; ++i) {
+            const auto layout = Layout::parse(layoutString(layouts, i));
+            if (layout) {
+                scores[i] = scorer.score(*layout);
+            } else {
+                size_t illegal = first_illegal.load();
+                while (i < illegal and not first_illegal.compare_exchange_weak(illegal, i)) {}
+            }
+        }
+
+        if (const size_t i = first_illegal.load(); i < count) {
+            return illegalLayout(i, Layout::parse(layoutString(layouts, i)).error());
+        }
+        return JH_OK;
+    });
+}
+
+jh_status jh_run_new(const jh_evaluator *const evaluator, const jh_config *const config,
+                     const jh_run_options *const options, jh_run **const run) {
+    if (evaluator == nullptr or options == nullptr or run == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_run_new()");
+    }
+    if (options->num_restarts == 0 or options->num_elites == 0) {
+        return fail(JH_INVALID_ARGUMENT, "jh_run_new(): no restart or no elite");
+    }
+    return guard([&]() -> jh_status {
+        search::Annealer annealer(evaluator->evaluator, {
+            .num_steps = options->num_steps,
+            .start_temperature = options->start_temperature,
+            .end_temperature = options->end_temperature,
+        });
+        *run = new jh_run{std::move(annealer), config != nullptr ? config->config : nullptr, *options};
+        return JH_OK;
+    });
+}
+
+void jh_run_free(jh_run *const run) {
+    delete run;
+}
+
+void jh_run_set_progress(jh_run *const run, const jh_progress_fn progress, void *const user_data) {
+    if (run != nullptr) {
+        run->progress = progress;
+        run->user_data = user_data;
+    }
+}
+
+/**
+ * @brief Run the optimizer, blocking until all the restarts are done
+ *        or the progress callback cancels the run. A cancelled run keeps
+ *        the results of the restarts it completed.
+ **/
+jh_status jh_run_start(jh_run *const run) {
+    if (run == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_run_start()");
+    }
+    return guard([&]() -> jh_status {
+        const jh_run_options &options = run->options;
+
+        search::Scheduler scheduler(numThreads(options.num_threads));
+        search::DeterministicRun deterministic({
+            .num_items = options.num_restarts,
+            .seed = options.seed,
+            .num_elites = options.num_elites,
+            .config = run->config,
+        });
+
+        std::mutex progress_mutex;
+        size_t completed = 0;
+        fz best_score = std::numeric_limits<fz>::infinity();
+        std::atomic<bool> cancelled{false};
+
+        run->results = deterministic.run(scheduler, [&](layout::Manager &manager, search::Item &item) -> void {
+            const search::AnnealResult result = run->annealer.run(manager, item.prng(), cancelled);
+            if (cancelled and result.moves < options.num_steps) {
+                return; // cut short by the cancellation
+            }
+            item.offer(result.best, result.score);
+            if (run->progress == nullptr) {
+                return;
+            }
+            const std::scoped_lock lock(progress_mutex);
+            best_score = std::min(best_score, result.score);
+            if (not cancelled and run->progress(run->user_data, ++completed, options.num_restarts, best_score) != 0) {
+                cancelled = true;
+                scheduler.cancel();
+            }
+        });
+
+        if (cancelled) {
+            return fail(JH_CANCELLED, "run cancelled by the progress callback");
+        }
+        return JH_OK;
+    });
+}
+
+size_t jh_run_num_results(const jh_run *const run) {
+    return run != nullptr ? run->results.size() : 0;
+}
+
+/**
+ * @brief Copy the count best results, from the best, into layouts
+ *        and scores (either may be NULL).
+ **/
+jh_status jh_run_results(const jh_run *const run, char *const layouts, float *const scores, const size_t count) {
+    if (run == nullptr) {
+        return fail(JH_INVALID_ARGUMENT, "null argument in jh_run_results()");
+    }
+    if (count > run->results.size()) {
+        return fail(JH_INVALID_ARGUMENT, fmt::format(
+            "jh_run_results(): {:d} results requested, {:d} available", count, run->results.size()
+        ));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (layouts != nullptr) {
+            run->results[i].layout.writeTo(layoutSpan(layouts, i));
+        }
+        if (scores != nullptr) {
+            scores[i] = run->results[i].score;
+        }
+    }
+    return JH_OK;
+}
@@ -1,6 +1,9 @@
 #ifndef JIANHAN_HPP
 #define JIANHAN_HPP
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,6 +18,93 @@ extern "C" {
 
     _export int add(int a, int b);
 
+    /*
+     * C interface of the library.
+     *
+     * Layouts cross the interface as layout strings of JH_KEY_COUNT bytes
+     * (e.g. "QWERTYUIOPASDFGHJKL;ZXCVBNM,./"), without terminating null.
+     * Batch functions take contiguous buffers of such strings, layout i
+     * at offset i * JH_KEY_COUNT, so that a batch is a single call.
+     *
+     * Functions return JH_OK or an error status, the message of the last
+     * error of the calling thread is given by jh_last_error(). Handles are
+     * opaque, created by jh_*_new() and released by jh_*_free(), which
+     * accept NULL. A handle may be used by one thread at a time, except
+     * configs and evaluators, which are read-only once created.
+     */
+
+    enum { JH_KEY_COUNT = 30 };
+
+    typedef enum jh_status {
+        JH_OK = 0,
+        JH_INVALID_ARGUMENT = 1, // includes illegal configurations and layout strings
+        JH_CANCELLED = 2,        // by a progress callback
+        JH_OUT_OF_MEMORY = 3,
+        JH_INTERNAL_ERROR = 4,
+    } jh_status;
+
+    typedef struct jh_config jh_config;
+    typedef struct jh_manager jh_manager;
+    typedef struct jh_evaluator jh_evaluator;
+    typedef struct jh_run jh_run;
+
+    _export const char *jh_last_error(void);
+
+    // Number of threads of the batch functions and of the runs that do
+    // not set their own, 1 by default (0: one per hardware thread).
+    _export void jh_set_num_threads(size_t num_threads);
+
+    // Layout configuration, see conf/layouts.toml.
+    _export jh_status jh_config_new(const char *toml, size_t size, jh_config **config);
+    _export jh_status jh_config_new_default(jh_config **config);
+    _export void jh_config_free(jh_config *config);
+
+    // Mutation context, config may be NULL for the default one.
+    _export jh_status jh_manager_new(const jh_config *config, uint64_t seed, jh_manager **manager);
+    _export void jh_manager_free(jh_manager *manager);
+    _export jh_status jh_manager_create(jh_manager *manager, char *layouts, size_t count);
+    _export jh_status jh_manager_mutate(jh_manager *manager, const char *parents, char *children, size_t count);
+
+    typedef struct jh_bigram {
+        uint8_t first;  // key values, e.g. 'T' and 'H'
+        uint8_t second;
+        float freq;
+    } jh_bigram;
+
+    // Scores of layouts (lower is better): the sum over the bigrams of
+    // freq * costs[pos(first) * JH_KEY_COUNT + pos(second)].
+    _export jh_status jh_evaluator_new(const jh_bigram *bigrams, size_t num_bigrams,
+                                       const float *costs, jh_evaluator **evaluator);
+    _export void jh_evaluator_free(jh_evaluator *evaluator);
+    _export jh_status jh_evaluator_score(const jh_evaluator *evaluator, const char *layouts,
+                                         size_t count, float *scores);
+
+    typedef struct jh_run_options {
+        uint64_t seed;
+        size_t num_restarts;        // independent annealing runs
+        size_t num_steps;           // moves per restart
+        size_t num_elites;          // best distinct layouts kept
+        size_t num_threads;         // 0: see jh_set_num_threads()
+        double start_temperature;   // geometric schedule, 0 for hill climbing
+        double end_temperature;
+    } jh_run_options;
+
+    // Called after each restart, from the worker threads one at a time.
+    // Returning nonzero cancels the run.
+    typedef int (*jh_progress_fn)(void *user_data, size_t completed, size_t total, float best_score);
+
+    // Optimizer run: for the same options, the results do not depend on
+    // the number of threads. config may be NULL for the default one, the
+    // evaluator must outlive the run. jh_run_start() blocks until the end,
+    // jh_run_results() copies the count best layouts and their scores.
+    _export jh_status jh_run_new(const jh_evaluator *evaluator, const jh_config *config,
+                                 const jh_run_options *options, jh_run **run);
+    _export void jh_run_free(jh_run *run);
+    _export void jh_run_set_progress(jh_run *run, jh_progress_fn progress, void *user_data);
+    _export jh_status jh_run_start(jh_run *run);
+    _export size_t jh_run_num_results(const jh_run *run);
+    _export jh_status jh_run_results(const jh_run *run, char *layouts, float *scores, size_t count);
+
 #ifdef __cplusplus
 }
 #endif
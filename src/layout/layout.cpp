@@ -1,39 +1,45 @@
 #include "layout.hpp"
 
+#include <bit>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace jianhan::v0 {
 
 /**
  * @brief Should not be used to create anything other than a temporary object.
  * @note Empty layout should not be used as a parameter for any function.
  **/
-Layout::Layout() = default;
+template<Geometry G> BasicLayout<G>::BasicLayout() = default;
 
 /**
  * @brief Construct a layout from a string that gives the order of the keys.
  * @param str Layout string, e.g."QWERTYUIOPASDFGHJKL;ZXCVBNM,./".
  */
-Layout::Layout(const std::string_view str) {
+template<Geometry G> BasicLayout<G>::BasicLayout(const std::string_view str) {
     varifyLayoutString(str);
     loadFromString(str);
 }
 
-auto Layout::varifyLayoutString(const std::string_view str) -> void {
+template<Geometry G> auto BasicLayout<G>::varifyLayoutString(const std::string_view str) -> void {
     // Check string length
-    if (const uz len = str.length(); len != KEY_COUNT) {
+    if (const uz len = str.length(); len != G::KEY_COUNT) {
         constexpr auto what{"incorrect length: expected {:d}, got {:d}"};
-        throw IllegalString(str, fmt::format(what, KEY_COUNT, len));
+        throw IllegalString(str, fmt::format(what, G::KEY_COUNT, len));
     }
 
     // Check characters
     for (const char ch : str) {
-        if (const auto v = static_cast<KeyValue>(ch); not Util::isKeyValueLegal(v)) {
+        if (const auto v = static_cast<KeyValue>(ch); not BasicUtil<G>::isKeyValueLegal(v)) {
             constexpr std::string_view what = "invalid key value: '{:c}'";
             throw IllegalString(str, fmt::format(what, ch));
         }
     }
 
     // Check for duplicates
-    std::bitset<MAX_KEY_CODE> existing_vals;
+    std::bitset<G::MAX_KEY_CODE> existing_vals;
     for (const char ch : str) {
         if (const auto val = static_cast<KeyValue>(ch); existing_vals[val]) {
             constexpr std::string_view what = "duplicate key values: '{:c}'";
@@ -44,7 +50,89 @@ auto Layout::varifyLayoutString(const std::string_view str) -> void {
     }
 }
 
-void Layout::loadFromString(const std::string_view str) {
+/**
+ * @brief Non-throwing counterpart of BasicLayout(std::string_view),
+ *        for bulk parsing.
+ * @param str Layout string, e.g."QWERTYUIOPASDFGHJKL;ZXCVBNM,./".
+ * @return the layout, or why the string is rejected.
+ **/
+template<Geometry G> auto BasicLayout<G>::parse(const std::string_view str) noexcept
+    -> std::expected<BasicLayout, ParseError> {
+    if (str.length() != G::KEY_COUNT) {
+        return std::unexpected(ParseError::Length);
+    }
+    if (const auto checked = checkKeys(str.data()); not checked) {
+        return std::unexpected(checked.error());
+    }
+    BasicLayout layout;
+    layout.loadFromString(str);
+    return layout;
+}
+
+// Nibble tables of the key codes of a geometry: byte c is a key code
+// iff LO[c & 15] & HI[c >> 4] != 0. Key codes lie in [44, 108), their
+// high nibbles in [2, 6], one bit each.
+template<Geometry G> struct KeyNibbles final {
+    static constexpr auto TABLES = []() -> std::array<std::array<uint8_t, 16>, 2> {
+        std::array<std::array<uint8_t, 16>, 2> tables{};
+        for (const KeyValue val : G::KEY_CODES) {
+            tables[0][val & 15] |= static_cast<uint8_t>(1 << ((val >> 4) - 2));
+        }
+        for (uz hi = 2; hi <= 6; ++hi) {
+            tables[1][hi] = static_cast<uint8_t>(1 << (hi - 2));
+        }
+        return tables;
+    }();
+};
+
+/**
+ * @brief Check the KEY_COUNT characters at str: legal, then unique.
+ * @note Legality is checked 32 characters at a time with AVX2. Since key
+ *       codes lie in [MIN_KEY_CODE, MIN_KEY_CODE + 64), uniqueness is a
+ *       population count of a 64-bit mask with one bit per key code.
+ **/
+template<Geometry G> auto BasicLayout<G>::checkKeys(const char *const str) noexcept
+    -> std::expected<void, ParseError> {
+#ifdef __AVX2__
+    static constexpr uz NUM_BLOCKS = (G::KEY_COUNT + 31) / 32;
+    alignas(32) std::array<char, 32 * NUM_BLOCKS> keys{}; // zeros are illegal
+    std::memcpy(keys.data(), str, G::KEY_COUNT);
+
+    const auto &[lo_nibbles, hi_nibbles] = KeyNibbles<G>::TABLES;
+    const __m256i lo_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo_nibbles.data())));
+    const __m256i hi_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(hi_nibbles.data())));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    for (uz block = 0; block < NUM_BLOCKS; ++block) {
+        const __m256i bytes = _mm256_load_si256(reinterpret_cast<const __m256i *>(keys.data() + 32 * block));
+        const __m256i lo = _mm256_shuffle_epi8(lo_table, _mm256_and_si256(bytes, nibble));
+        const __m256i hi = _mm256_shuffle_epi8(hi_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble));
+        const __m256i illegal = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+
+        const uz num_lanes = std::min<uz>(32, G::KEY_COUNT - 32 * block);
+        const uint32_t lanes = num_lanes == 32 ? ~uint32_t{0} : (uint32_t{1} << num_lanes) - 1;
+        if ((static_cast<uint32_t>(_mm256_movemask_epi8(illegal)) & lanes) != 0) {
+            return std::unexpected(ParseError::IllegalKey);
+        }
+    }
+#else
+    for (uz i = 0; i < G::KEY_COUNT; ++i) {
+        if (not BasicUtil<G>::isKeyValueLegal(static_cast<KeyValue>(str[i]))) {
+            return std::unexpected(ParseError::IllegalKey);
+        }
+    }
+#endif
+
+    uint64_t seen = 0;
+    for (uz i = 0; i < G::KEY_COUNT; ++i) {
+        seen |= uint64_t{1} << (static_cast<KeyValue>(str[i]) - MIN_KEY_CODE);
+    }
+    if (std::popcount(seen) != static_cast<int>(G::KEY_COUNT)) {
+        return std::unexpected(ParseError::DuplicateKey);
+    }
+    return {};
+}
+
+template<Geometry G> void BasicLayout<G>::loadFromString(const std::string_view str) {
     for (const auto [i, ch] : str | std::views::enumerate) {
         const auto val = static_cast<KeyValue>(ch);
         const auto pos = static_cast<Position>(i);
@@ -52,74 +140,139 @@ void Layout::loadFromString(const std::string_view str) {
     }
 }
 
-auto Layout::getVal(const Position pos) const noexcept -> KeyValue {
-    assert(Util::isPositionLegal(pos));
+template<Geometry G> auto BasicLayout<G>::getVal(const Position pos) const noexcept -> KeyValue {
+    assert(BasicUtil<G>::isPositionLegal(pos));
     return key_mappings_[pos];
 }
 
-auto Layout::getPos(const KeyValue val) const noexcept -> Position {
-    assert(Util::isKeyValueLegal(val));
+template<Geometry G> auto BasicLayout<G>::getPos(const KeyValue val) const noexcept -> Position {
+    assert(BasicUtil<G>::isKeyValueLegal(val));
     return key_mappings_[val];
 }
 
-auto Layout::toStr() const noexcept -> std::string {
-    auto key_vals = key_mappings_ | std::views::take(KEY_COUNT);
+template<Geometry G> auto BasicLayout<G>::toStr() const noexcept -> std::string {
+    auto key_vals = key_mappings_ | std::views::take(G::KEY_COUNT);
     return {key_vals.begin(), key_vals.end()};
 }
 
-auto Layout::setPosValPair(const KeyValue val, const Position pos) noexcept -> void {
-    assert(Util::isKeyValueLegal(val));
-    assert(Util::isPositionLegal(pos));
+/**
+ * @brief Write the layout string, without allocating.
+ * @param out: KEY_COUNT characters, no terminating null.
+ **/
+template<Geometry G> auto BasicLayout<G>::writeTo(const std::span<char, G::KEY_COUNT> out) const noexcept -> void {
+    std::memcpy(out.data(), key_mappings_.data(), G::KEY_COUNT);
+}
+
+/**
+ * @brief 64-bit hash of the layout, computed over the KEY_CNT_POW2
+ *        bytes of the position -> key table (one or two 32-byte stripes).
+ * @note The AVX2 and scalar paths give identical results, so hashes
+ *       can be exchanged between builds with different vector extensions.
+ **/
+template<Geometry G> auto BasicLayout<G>::hash() const noexcept -> uint64_t {
+    // Positions [KEY_COUNT, 44) are never written, the bytes beyond
+    // (with 64 lanes) hold key -> position entries: the stripes
+    // depend on the layout only.
+    static constexpr uz NUM_STRIPES = G::KEY_CNT_POW2 / 32;
+    static constexpr std::array<uint64_t, 8> SECRET{
+        0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull,
+        0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+        0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull,
+        0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+    };
+
+    // XXH3-style accumulation: (data ^ secret).lo32 * (data ^ secret).hi32
+    // plus the neighbouring lane of data, for each of the four 64-bit lanes.
+    // Stripe s uses the secret rotated by s lanes.
+    std::array<uint64_t, 4> acc{};
+#ifdef __AVX2__
+    __m256i sum = _mm256_setzero_si256();
+    for (uz stripe = 0; stripe < NUM_STRIPES; ++stripe) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key_mappings_.data() + 32 * stripe));
+        const __m256i secret = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(SECRET.data() + stripe));
+        const __m256i keyed = _mm256_xor_si256(data, secret);
+        const __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+        const __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        sum = _mm256_add_epi64(sum, _mm256_add_epi64(product, swapped));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc.data()), sum);
+#else
+    for (uz stripe = 0; stripe < NUM_STRIPES; ++stripe) {
+        std::array<uint64_t, 4> data;
+        std::memcpy(data.data(), key_mappings_.data() + 32 * stripe, sizeof(data));
+        for (uz i = 0; i < 4; ++i) {
+            const uint64_t keyed = data[i] ^ SECRET[i + stripe];
+            acc[i] += (keyed & 0xffffffffull) * (keyed >> 32) + data[i ^ 1];
+        }
+    }
+#endif
+
+    auto fold = [](const uint64_t lhs, const uint64_t rhs) -> uint64_t {
+        const auto product = static_cast<unsigned __int128>(lhs) * rhs;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    };
+    uint64_t h = fold(acc[0] ^ SECRET[2], acc[1] ^ SECRET[3])
+                 + fold(acc[2] ^ SECRET[0], acc[3] ^ SECRET[1]);
+
+    // avalanche
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9ull;
+    return h ^ (h >> 32);
+}
+
+template<Geometry G> auto BasicLayout<G>::setPosValPair(const KeyValue val, const Position pos) noexcept -> void {
+    assert(BasicUtil<G>::isKeyValueLegal(val));
+    assert(BasicUtil<G>::isPositionLegal(pos));
     key_mappings_[val] = pos;
     key_mappings_[pos] = val;
 }
 
-auto Layout::swapKeyValues(const Position pos1, const Position pos2) noexcept -> void {
-    assert(Util::isPositionLegal(pos1));
-    assert(Util::isPositionLegal(pos2));
+template<Geometry G> auto BasicLayout<G>::swapKeyValues(const Position pos1, const Position pos2) noexcept -> void {
+    assert(BasicUtil<G>::isPositionLegal(pos1));
+    assert(BasicUtil<G>::isPositionLegal(pos2));
     std::swap(key_mappings_[pos1], key_mappings_[pos2]);
     std::swap(key_mappings_[getVal(pos1)], key_mappings_[getVal(pos2)]);
 }
 
-auto Layout::operator<=>(const Layout &other) const noexcept -> std::weak_ordering {
+template<Geometry G> auto BasicLayout<G>::operator<=>(const BasicLayout &other) const noexcept -> std::weak_ordering {
     for (const auto [this_val, other_val] : std::views::zip(
-             this->key_mappings_ | std::views::take(KEY_COUNT),
-             other.key_mappings_ | std::views::take(KEY_COUNT))) {
+             this->key_mappings_ | std::views::take(G::KEY_COUNT),
+             other.key_mappings_ | std::views::take(G::KEY_COUNT))) {
         if (this_val < other_val) { return std::weak_ordering::less; }
         if (this_val > other_val) { return std::weak_ordering::greater; }
     }
     return std::weak_ordering::equivalent;
 }
 
-auto Layout::operator==(const Layout &other) const noexcept -> bool {
+template<Geometry G> auto BasicLayout<G>::operator==(const BasicLayout &other) const noexcept -> bool {
     return this->key_mappings_ == other.key_mappings_;
 }
 
-auto Layout::valid() const noexcept -> bool {
+template<Geometry G> auto BasicLayout<G>::valid() const noexcept -> bool {
     return arekeysLegal() and arekeysUnique();
 }
 
-auto Layout::arekeysLegal() const noexcept -> bool {
+template<Geometry G> auto BasicLayout<G>::arekeysLegal() const noexcept -> bool {
     return std::ranges::all_of( // Check key codes
-               POSITIONS, [this](const auto pos) -> bool {
+               BasicUtil<G>::POSITIONS, [this](const auto pos) -> bool {
                    const KeyValue val = this->getVal(pos);
-                   return Util::isKeyValueLegal(val);
+                   return BasicUtil<G>::isKeyValueLegal(val);
                }
            )
            and
            std::ranges::all_of( // Check positions
-               KEY_CODES, [this](const auto val) -> bool {
+               G::KEY_CODES, [this](const auto val) -> bool {
                    const Position pos = this->getPos(val);
-                   return Util::isPositionLegal(pos);
+                   return BasicUtil<G>::isPositionLegal(pos);
                }
            );
 }
 
-auto Layout::arekeysUnique() const noexcept -> bool {
-    std::bitset<MAX_KEY_CODE> already_observed(0);
+template<Geometry G> auto BasicLayout<G>::arekeysUnique() const noexcept -> bool {
+    std::bitset<G::MAX_KEY_CODE> already_observed(0);
 
     // Check key code uniqueness
-    for (const Position pos : POSITIONS) {
+    for (const Position pos : BasicUtil<G>::POSITIONS) {
         const KeyValue val = getVal(pos);
         if (already_observed[val]) {
             return false;
@@ -129,7 +282,7 @@ auto Layout::arekeysUnique() const noexcept -> bool {
     }
 
     // Check position uniqueness
-    for (const KeyValue val : KEY_CODES) {
+    for (const KeyValue val : G::KEY_CODES) {
         const Position pos = getPos(val);
         if (already_observed[pos]) {
             return false;
@@ -141,4 +294,65 @@ auto Layout::arekeysUnique() const noexcept -> bool {
     return true;
 }
 
+/**
+ * @brief Parse a layout file straight into contiguous storage.
+ * @param text: one layout string per line, empty lines are skipped.
+ * @param layouts: where the layouts are appended, in order.
+ * @return the number of layouts appended, or the first rejected line,
+ *         in which case the layouts before it are appended.
+ **/
+template<Geometry G> auto parseLayouts(const std::string_view text, std::vector<BasicLayout<G>> &layouts)
+    -> std::expected<uz, LineError> {
+    const uz first = layouts.size();
+    layouts.reserve(first + static_cast<uz>(std::ranges::count(text, '\n')) + 1);
+
+    uz line = 0;
+    for (uz beg = 0; beg < text.size();) {
+        const uz end = std::min(text.find('\n', beg), text.size());
+        std::string_view row = text.substr(beg, end - beg);
+        beg = end + 1, ++line;
+
+        if (row.ends_with('\r')) {
+            row.remove_suffix(1);
+        }
+        if (row.empty()) {
+            continue;
+        }
+        auto layout = BasicLayout<G>::parse(row);
+        if (not layout) {
+            return std::unexpected(LineError{line, layout.error()});
+        }
+        layouts.push_back(*layout);
+    }
+    return layouts.size() - first;
+}
+
+/**
+ * @brief Write layouts as the lines of a layout file, without allocating.
+ * @param buffer: KEY_COUNT + 1 bytes per line, '\n' included.
+ * @return the number of layouts written: as many whole lines as fit.
+ **/
+template<Geometry G> auto writeLayouts(const std::span<const BasicLayout<G>> layouts, const std::span<char> buffer) noexcept
+    -> uz {
+    static constexpr uz LINE_SIZE = G::KEY_COUNT + 1;
+    const uz num_lines = std::min(layouts.size(), buffer.size() / LINE_SIZE);
+    for (uz i = 0; i < num_lines; ++i) {
+        char *const line = buffer.data() + i * LINE_SIZE;
+        layouts[i].writeTo(std::span<char, G::KEY_COUNT>(line, G::KEY_COUNT));
+        line[G::KEY_COUNT] = '\n';
+    }
+    return num_lines;
+}
+
+template class BasicLayout<Geometry30>;
+template class BasicLayout<Geometry40>;
+template class BasicLayout<GeometrySplit34>;
+
+template auto parseLayouts(std::string_view, std::vector<BasicLayout<Geometry30>> &) -> std::expected<uz, LineError>;
+template auto writeLayouts(std::span<const BasicLayout<Geometry30>>, std::span<char>) noexcept -> uz;
+template auto parseLayouts(std::string_view, std::vector<BasicLayout<Geometry40>> &) -> std::expected<uz, LineError>;
+template auto writeLayouts(std::span<const BasicLayout<Geometry40>>, std::span<char>) noexcept -> uz;
+template auto parseLayouts(std::string_view, std::vector<BasicLayout<GeometrySplit34>> &) -> std::expected<uz, LineError>;
+template auto writeLayouts(std::span<const BasicLayout<GeometrySplit34>>, std::span<char>) noexcept -> uz;
+
 } // namespace jianhan::v0
@@ -1,13 +1,20 @@
 #ifndef JIANHAN_LAYOUT_HPP
 #define JIANHAN_LAYOUT_HPP
 
+#include <expected>
+#include <span>
+#include <vector>
+
 #include "../common/utils.hpp"
 
 namespace jianhan::v0 {
 
 namespace layout {
-class Manager;
-class Area;
+template<Geometry G> class BasicManager;
+template<Geometry G> class BasicArea;
+class Ranker;
+class Distance;
+template<auto CONFIG> class StaticManager;
 }
 
 struct Key final {
@@ -15,27 +22,49 @@ struct Key final {
     Position pos;
 };
 
-class Layout {
+// Why BasicLayout::parse() rejects a layout string.
+enum class ParseError : u8 {
+    Length,       // not KEY_COUNT characters
+    IllegalKey,   // a character out of the key codes of the geometry
+    DuplicateKey, // a key value twice, hence another one missing
+};
+
+// The first rejected line of a layout file.
+struct LineError final {
+    uz line; // 1-based
+    ParseError error;
+};
+
+/**
+ * @brief A layout of the keys of a geometry.
+ * @tparam G: keyboard geometry, which sets the size of the key mappings
+ *            and the SIMD width of hash().
+ **/
+template<Geometry G> class BasicLayout {
 public:
-    explicit Layout(std::string_view str);
-    virtual ~Layout() = default;
+    explicit BasicLayout(std::string_view str);
+    virtual ~BasicLayout() = default;
+
+    [[nodiscard]] static auto parse(std::string_view str) noexcept -> std::expected<BasicLayout, ParseError>;
 
     [[nodiscard]] auto getVal(Position pos) const noexcept -> KeyValue;
     [[nodiscard]] auto getPos(KeyValue val) const noexcept -> Position;
 
     [[nodiscard]] auto toStr() const noexcept -> std::string;
+    auto writeTo(std::span<char, G::KEY_COUNT> out) const noexcept -> void;
     [[nodiscard]] auto valid() const noexcept -> bool;
+    [[nodiscard]] auto hash() const noexcept -> uint64_t;
 
-    auto operator<=>(const Layout &other) const noexcept -> std::weak_ordering;
-    auto operator==(const Layout &other) const noexcept -> bool;
+    auto operator<=>(const BasicLayout &other) const noexcept -> std::weak_ordering;
+    auto operator==(const BasicLayout &other) const noexcept -> bool;
 
 protected:
     // Key values and position numbers are stored in a single array
     // since they do not conflict with each other while
-    // being indexed: Position <= 29, KeyValue >= 44.
-    std::array<u8, MAX_KEY_CODE> key_mappings_{};
+    // being indexed: Position < KEY_COUNT <= 44 <= KeyValue.
+    std::array<u8, G::MAX_KEY_CODE> key_mappings_{};
 
-    Layout();
+    BasicLayout();
 
     auto loadFromString(std::string_view str) -> void;
 
@@ -45,6 +74,7 @@ protected:
 
 private:
     static auto varifyLayoutString(std::string_view str) -> void;
+    static auto checkKeys(const char *str) noexcept -> std::expected<void, ParseError>;
 
     [[nodiscard]] auto arekeysLegal() const noexcept -> bool;
     [[nodiscard]] auto arekeysUnique() const noexcept -> bool;
@@ -64,10 +94,27 @@ private:
         };
     };
 
-    friend class layout::Manager;
-    friend class layout::Area;
+    friend class layout::BasicManager<G>;
+    friend class layout::BasicArea<G>;
+    friend class layout::Ranker;
+    friend class layout::Distance;
+    template<auto CONFIG> friend class layout::StaticManager;
 };
 
+using Layout = BasicLayout<Geometry30>;
+
+// Layout files: one layout string per line, '\n' or "\r\n" line endings.
+template<Geometry G> auto parseLayouts(std::string_view text, std::vector<BasicLayout<G>> &layouts)
+    -> std::expected<uz, LineError>;
+template<Geometry G> auto writeLayouts(std::span<const BasicLayout<G>> layouts, std::span<char> buffer) noexcept
+    -> uz;
+
 } // namespace jianhan::v0
 
+template<jianhan::v0::Geometry G> struct std::hash<jianhan::v0::BasicLayout<G>> {
+    auto operator()(const jianhan::v0::BasicLayout<G> &layout) const noexcept -> size_t {
+        return layout.hash();
+    }
+};
+
 #endif // JIANHAN_LAYOUT_HPP
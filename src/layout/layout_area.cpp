@@ -1,13 +1,17 @@
 #include "layout_area.hpp"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 namespace jianhan::v0::layout {
 
 auto size_of_area = [](const toml_t &config) -> uz {
     return config.at("val").size();
 };
 
-Area::Area(const toml_t &config)
-    : Area(size_of_area(config)) {
+template<Geometry G> BasicArea<G>::BasicArea(const toml_t &config)
+    : BasicArea(size_of_area(config)) {
     for (const toml_t &v : config.at("val").as_array()) {
         const KeyValue val = v.as_string().str[0];
         addKeyValue(val);
@@ -18,73 +22,227 @@ Area::Area(const toml_t &config)
     }
     // for comparisons
     std::ranges::sort(key_codes_);
+    buildShuffles();
 }
 
-Area::Area(const uz size)
+template<Geometry G> BasicArea<G>::BasicArea(const uz size)
     : size_(size), lim_(size - size % 2), idx_(lim_ + 1) {
-    assert(size <= KEY_COUNT);
+    assert(size <= G::KEY_COUNT);
     key_codes_.reserve(size);
     positions_.reserve(size);
 }
 
-auto Area::addKeyValue(const KeyValue val) -> void {
+template<Geometry G> auto BasicArea<G>::addKeyValue(const KeyValue val) -> void {
     key_codes_.emplace_back(val);
 }
 
-auto Area::addPosition(const Position pos) -> void {
+template<Geometry G> auto BasicArea<G>::addPosition(const Position pos) -> void {
     positions_.emplace_back(pos);
 }
 
+static constexpr uz KEYS_LO = MIN_KEY_CODE; // first key byte of the [44, 76) block
+
+// First key byte of the last 32-byte block, [60, 92) with 30 keys.
+template<Geometry G> static constexpr uz KEYS_HI = G::MAX_KEY_CODE - 32;
+
+/**
+ * @brief Precompute the shuffle controls and blend masks of assign(),
+ *        once the key values (sorted) and the positions are known.
+ **/
+template<Geometry G> auto BasicArea<G>::buildShuffles() noexcept -> void {
+    shuffles_.key_codes.fill(0);
+    shuffles_.pos_mask.fill(0);
+    shuffles_.lo_ctrl.fill(0x80), shuffles_.lo_mask.fill(0);
+    shuffles_.hi_ctrl.fill(0x80), shuffles_.hi_mask.fill(0);
+
+    for (const auto [i, val] : key_codes_ | std::views::enumerate) {
+        shuffles_.key_codes[i] = val;
+        if (val >= KEYS_LO and val < KEYS_LO + 32) {
+            shuffles_.lo_ctrl[val - KEYS_LO] = static_cast<uint8_t>(i);
+            shuffles_.lo_mask[val - KEYS_LO] = 0xff;
+        }
+        if (val >= KEYS_HI<G>) {
+            shuffles_.hi_ctrl[val - KEYS_HI<G>] = static_cast<uint8_t>(i);
+            shuffles_.hi_mask[val - KEYS_HI<G>] = 0xff;
+        }
+    }
+    for (const Position pos : positions_) {
+        shuffles_.pos_mask[pos] = 0xff;
+    }
+
+    ordered_positions_ = positions_;
+    std::ranges::sort(ordered_positions_);
+}
+
+#ifdef __AVX2__
+// table[idx[i]] for each byte, with a 32-byte table: pshufb only looks up
+// within 128-bit lanes, so both halves are looked up and selected by bit 4.
+// Indices with bit 7 set give 0.
+static auto lookup32(const __m256i table, const __m256i idx) noexcept -> __m256i {
+    const __m256i lo = _mm256_shuffle_epi8(_mm256_permute2x128_si256(table, table, 0x00), idx);
+    const __m256i hi = _mm256_shuffle_epi8(_mm256_permute2x128_si256(table, table, 0x11), idx);
+    return _mm256_blendv_epi8(lo, hi, _mm256_slli_epi16(idx, 3));
+}
+
+// Same with a 64-byte table (two halves), selected by bit 5.
+static auto lookup64(const __m256i lo_table, const __m256i hi_table, const __m256i idx) noexcept -> __m256i {
+    return _mm256_blendv_epi8(lookup32(lo_table, idx), lookup32(hi_table, idx), _mm256_slli_epi16(idx, 2));
+}
+
+static auto load(const void *addr) noexcept -> __m256i {
+    return _mm256_loadu_si256(static_cast<const __m256i *>(addr));
+}
+
+static auto blendInto(std::byte *dst, const __m256i src, const __m256i mask) noexcept -> void {
+    auto *const addr = reinterpret_cast<__m256i *>(dst);
+    _mm256_storeu_si256(addr, _mm256_blendv_epi8(_mm256_loadu_si256(addr), src, mask));
+}
+#endif
+
 /**
  * @brief Randomly assign all the keys in the area.
  * @param layout: target layout.
  * @param prng: random number generator.
  * @note This operation can break the object.
  **/
-auto Area::assign(Layout &layout, Prng &prng) noexcept -> void {
+template<Geometry G> auto BasicArea<G>::assign(Layout &layout, Prng &prng) noexcept -> void {
     std::ranges::shuffle(positions_, prng);
+#ifdef __AVX2__
+    // key_codes_[i] goes to positions_[i]. The key -> position blocks are
+    // gathers from positions_ with fixed controls. The position -> key block
+    // needs the inverse permutation, built in a KEY_CNT_POW2-byte buffer first.
+    static constexpr uz LANES = G::KEY_CNT_POW2;
+    alignas(32) std::array<uint8_t, LANES> positions{};
+    alignas(32) std::array<uint8_t, LANES> inverse;
+    inverse.fill(0x80);
+    for (uz i = 0; i < size_; ++i) {
+        positions[i] = static_cast<uint8_t>(positions_[i]);
+        inverse[positions_[i]] = static_cast<uint8_t>(i);
+    }
+
+    auto *const bytes = reinterpret_cast<std::byte *>(layout.key_mappings_.data());
+    if constexpr (LANES == 32) {
+        const __m256i pos_vec = load(positions.data());
+        blendInto(bytes, lookup32(load(shuffles_.key_codes.data()), load(inverse.data())),
+                  load(shuffles_.pos_mask.data()));
+        blendInto(bytes + KEYS_LO, lookup32(pos_vec, load(shuffles_.lo_ctrl.data())),
+                  load(shuffles_.lo_mask.data()));
+        blendInto(bytes + KEYS_HI<G>, lookup32(pos_vec, load(shuffles_.hi_ctrl.data())),
+                  load(shuffles_.hi_mask.data()));
+    } else {
+        // The second position block overlaps the first key block,
+        // it has to be written first.
+        const __m256i pos_lo = load(positions.data()), pos_hi = load(positions.data() + 32);
+        const __m256i keys_lo = load(shuffles_.key_codes.data());
+        const __m256i keys_hi = load(shuffles_.key_codes.data() + 32);
+        for (uz block = 0; block < LANES; block += 32) {
+            blendInto(bytes + block, lookup64(keys_lo, keys_hi, load(inverse.data() + block)),
+                      load(shuffles_.pos_mask.data() + block));
+        }
+        blendInto(bytes + KEYS_LO, lookup64(pos_lo, pos_hi, load(shuffles_.lo_ctrl.data())),
+                  load(shuffles_.lo_mask.data()));
+        blendInto(bytes + KEYS_HI<G>, lookup64(pos_lo, pos_hi, load(shuffles_.hi_ctrl.data())),
+                  load(shuffles_.hi_mask.data()));
+    }
+#else
     for (const auto [val, pos] // bind val and pos
          : std::views::zip(key_codes_, positions_)) {
         layout.setPosValPair(val, pos);
     }
+#endif
 }
 
 /**
  * @brief Randomly swap two keys in the area.
  * @param layout: target layout.
  * @param prng: random number generator.
+ * @return the swap, with area 0.
  * @note This operation can break the object.
  **/
-auto Area::mutate(Layout &layout, Prng &prng) noexcept -> void {
+template<Geometry G> auto BasicArea<G>::mutate(Layout &layout, Prng &prng) noexcept -> Move {
     // When all the owned positions have been visited,
     // reshuffle positions_ and reset idx_ to 0.
-    if (idx_ >= lim_) { reset(prng); }
+    if (idx_ + 2 > size_) { reset(prng); }
 
     // Select two positions in the area, then
     // exchange the corresponding key values.
     const Position pos1 = positions_[idx_++];
     const Position pos2 = positions_[idx_++];
     layout.swapKeyValues(pos1, pos2);
+
+    Move move{};
+    move.add(pos1, pos2);
+    return move;
 }
 
-auto Area::reset(Prng &prng) noexcept -> void {
+/**
+ * @brief Randomly rotate three keys in the area,
+ *        or swap two keys if the area is too small.
+ * @param layout: target layout.
+ * @param prng: random number generator.
+ * @return the two swaps making the 3-cycle, with area 0.
+ **/
+template<Geometry G> auto BasicArea<G>::cycle(Layout &layout, Prng &prng) noexcept -> Move {
+    if (size_ < 3) { return mutate(layout, prng); }
+    if (idx_ + 3 > size_) { reset(prng); }
+
+    const Position pos1 = positions_[idx_++];
+    const Position pos2 = positions_[idx_++];
+    const Position pos3 = positions_[idx_++];
+    layout.swapKeyValues(pos1, pos2);
+    layout.swapKeyValues(pos1, pos3);
+
+    Move move{};
+    move.add(pos1, pos2), move.add(pos1, pos3);
+    move.op = Operator::Cycle;
+    return move;
+}
+
+/**
+ * @brief Reverse the keys along a random segment of the area's positions,
+ *        taken in ascending order (e.g. a run of keys on a row).
+ * @param layout: target layout.
+ * @param prng: random number generator.
+ * @return the swaps of the reversal, with area 0.
+ **/
+template<Geometry G> auto BasicArea<G>::reverse(Layout &layout, Prng &prng) noexcept -> Move {
+    if (size_ < 3) { return mutate(layout, prng); }
+
+    const uz max_length = std::min(size_, 2 * Move::MAX_SWAPS);
+    const uz length = std::uniform_int_distribution<uz>(3, max_length)(prng);
+    const uz first = std::uniform_int_distribution<uz>(0, size_ - length)(prng);
+
+    Move move{};
+    for (uz i = first, j = first + length - 1; i < j; ++i, --j) {
+        layout.swapKeyValues(ordered_positions_[i], ordered_positions_[j]);
+        move.add(ordered_positions_[i], ordered_positions_[j]);
+    }
+    move.op = Operator::Reverse;
+    return move;
+}
+
+template<Geometry G> auto BasicArea<G>::reset(Prng &prng) noexcept -> void {
     std::ranges::shuffle(positions_, prng);
     idx_ = 0;
 }
 
-auto Area::isCompatible(const Layout &layout) const noexcept -> bool {
+template<Geometry G> auto BasicArea<G>::isCompatible(const Layout &layout) const noexcept -> bool {
     // If the key values in a layout (at the same positions) match
     // the key values of the current area (regardless of order),
     // then this area is compatible with the layout.
-    std::vector<KeyValue> observed_key_values;
-    for (const Position pos : positions_) {
-        observed_key_values.emplace_back(
-            layout.getVal(pos)
-        );
-    }
+    // A fixed-size buffer keeps this check off the heap.
+    std::array<KeyValue, G::KEY_COUNT> buffer;
+    const auto observed_key_values = std::span(buffer).first(positions_.size());
+    std::ranges::transform(positions_, observed_key_values.begin(), [&layout](const Position pos) {
+        return layout.getVal(pos);
+    });
     // Sort to wipe out the effects of element order.
-    std::ranges::stable_sort(observed_key_values);
-    return observed_key_values == key_codes_;
+    std::ranges::sort(observed_key_values);
+    return std::ranges::equal(observed_key_values, key_codes_);
 }
 
+template class BasicArea<Geometry30>;
+template class BasicArea<Geometry40>;
+template class BasicArea<GeometrySplit34>;
+
 }
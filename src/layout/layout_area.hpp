@@ -1,22 +1,63 @@
 #ifndef JIANHAN_LAYOUT_AREA_HPP
 #define JIANHAN_LAYOUT_AREA_HPP
 
+#include <span>
+
 #include "layout.hpp"
 
 namespace jianhan::v0::layout {
 
 using toml_t = toml::value;
 
-class Config;
+template<Geometry G> class BasicConfig;
+template<Geometry G> class BasicManager;
+class Ranker;
+class Distance;
+
+// Move operators of Area and Manager.
+enum class Operator : u8 {
+    Swap,      // exchange two keys of an area
+    Cycle,     // rotate three keys of an area
+    KSwap,     // 2 to 4 random swaps in an area
+    Reverse,   // reverse the keys along a segment of an area's (sorted) positions
+    CrossArea, // a swap in each of two areas
+};
+
+static constexpr uz NUM_OPERATORS = 5;
+
+// A move as the sequence of swaps it made, applied in place and reverted
+// by applying the swaps again in reverse order. The touched positions
+// are what delta scoring needs (see score::Evaluator::delta()).
+struct Move final {
+    static constexpr uz MAX_SWAPS = MAX_KEY_COUNT / 2; // for any geometry
+
+    std::array<std::array<Position, 2>, MAX_SWAPS> swaps;
+    u8 num_swaps;
+    u8 area; // index of the (first) area in its manager
+    Operator op;
+
+    auto add(const Position pos1, const Position pos2) noexcept -> void {
+        assert(num_swaps < MAX_SWAPS);
+        swaps[num_swaps++] = {pos1, pos2};
+    }
 
-class Area final {
+    [[nodiscard]] auto applied() const noexcept -> std::span<const std::array<Position, 2>> {
+        return {swaps.data(), num_swaps};
+    }
+};
+
+template<Geometry G> class BasicArea final {
 public:
-    explicit Area(const toml_t &config);
+    using Layout = BasicLayout<G>;
+
+    explicit BasicArea(const toml_t &config);
 
-    Area() = delete;
+    BasicArea() = delete;
 
     auto assign(Layout &layout, Prng &prng) noexcept -> void;
-    auto mutate(Layout &layout, Prng &prng) noexcept -> void;
+    auto mutate(Layout &layout, Prng &prng) noexcept -> Move;
+    auto cycle(Layout &layout, Prng &prng) noexcept -> Move;
+    auto reverse(Layout &layout, Prng &prng) noexcept -> Move;
 
     [[nodiscard]] auto isCompatible(const Layout &layout) const noexcept -> bool;
 
@@ -28,17 +69,39 @@ protected:
     const uz lim_;
     uz idx_;
 
+    // Byte tables of the vectorized assign(), over the blocks of
+    // Layout::key_mappings_: [0, KEY_CNT_POW2) positions, then the keys
+    // in two 32-byte blocks [44, 76) and [MAX_KEY_CODE - 32, MAX_KEY_CODE).
+    // A control byte is the index (in key_codes_) of the key to load,
+    // 0x80 where the area has nothing to write; masks select those bytes.
+    // Tables indexed by key or position have KEY_CNT_POW2 (32 or 64) lanes.
+    struct alignas(32) Shuffles final {
+        std::array<uint8_t, G::KEY_CNT_POW2> key_codes;
+        std::array<uint8_t, G::KEY_CNT_POW2> pos_mask;
+        std::array<uint8_t, 32> lo_ctrl, lo_mask;
+        std::array<uint8_t, 32> hi_ctrl, hi_mask;
+    };
+
+    Shuffles shuffles_{};
+    std::vector<Position> ordered_positions_{}; // sorted, for reverse()
+
     auto reset(Prng &prng) noexcept -> void;
+    auto buildShuffles() noexcept -> void;
 
     auto addKeyValue(KeyValue val) -> void;
     auto addPosition(Position pos) -> void;
 
 private:
-    explicit Area(uz size);
+    explicit BasicArea(uz size);
 
-    friend class Config;
+    friend class BasicConfig<G>;
+    friend class BasicManager<G>;
+    friend class Ranker;
+    friend class Distance;
 };
 
+using Area = BasicArea<Geometry30>;
+
 }
 
 #endif // JIANHAN_LAYOUT_AREA_HPP
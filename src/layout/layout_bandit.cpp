@@ -0,0 +1,184 @@
+#include "layout_bandit.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace jianhan::v0::layout {
+
+static constexpr uint64_t ONE = uint64_t{1} << 32;
+
+/**
+ * @brief Construct an alias table.
+ * @param weights: non-negative, at least one positive, at most 2^32 of them.
+ **/
+AliasTable::AliasTable(const std::span<const fz> weights)
+    : thresholds_(weights.size()), aliases_(weights.size()),
+      scaled_(weights.size()), work_(weights.size()) {
+    rebuild(weights);
+}
+
+/**
+ * @brief Replace the distribution, without allocating.
+ * @param weights: as many as at construction, non-negative, at least one positive.
+ * @note Vose's construction: each column keeps its own index with some
+ *       chance and falls back to the alias of an overweight index.
+ **/
+auto AliasTable::rebuild(const std::span<const fz> weights) noexcept -> void {
+    const uz n = thresholds_.size();
+    assert(weights.size() == n and n > 0);
+    const f64 total = std::accumulate(weights.begin(), weights.end(), f64{0});
+    assert(total > 0);
+
+    // Two stacks in one buffer: underweight columns grow from the front,
+    // overweight ones from the back.
+    uz num_small = 0, num_large = 0;
+    for (uz i = 0; i < n; ++i) {
+        scaled_[i] = static_cast<f64>(weights[i]) * static_cast<f64>(n) / total;
+        if (scaled_[i] < 1) {
+            work_[num_small++] = static_cast<uint32_t>(i);
+        } else {
+            work_[n - ++num_large] = static_cast<uint32_t>(i);
+        }
+    }
+
+    while (num_small > 0 and num_large > 0) {
+        const uint32_t small = work_[--num_small];
+        const uint32_t large = work_[n - num_large--];
+        thresholds_[small] = static_cast<uint64_t>(scaled_[small] * static_cast<f64>(ONE));
+        aliases_[small] = large;
+
+        scaled_[large] += scaled_[small] - 1;
+        if (scaled_[large] < 1) {
+            work_[num_small++] = large;
+        } else {
+            work_[n - ++num_large] = large;
+        }
+    }
+
+    // The leftovers are (up to rounding) exactly full.
+    for (uz i = 0; i < num_small; ++i) {
+        thresholds_[work_[i]] = ONE, aliases_[work_[i]] = work_[i];
+    }
+    for (uz i = 0; i < num_large; ++i) {
+        thresholds_[work_[n - 1 - i]] = ONE, aliases_[work_[n - 1 - i]] = work_[n - 1 - i];
+    }
+}
+
+/**
+ * @brief Draw an index with probability proportional to its weight,
+ *        from a single random number.
+ **/
+auto AliasTable::sample(Prng &prng) const noexcept -> uz {
+    const uint64_t r = prng();
+    const uz column = static_cast<uz>(((r >> 32) * thresholds_.size()) >> 32);
+    return (r & (ONE - 1)) < thresholds_[column] ? column : aliases_[column];
+}
+
+auto AliasTable::size() const noexcept -> uz {
+    return thresholds_.size();
+}
+
+/**
+ * @brief Construct a bandit, which selects arms following the priors
+ *        until it gets rewards.
+ * @param priors: prior weight of each arm, non-negative, at least one
+ *                positive. Arms with a null prior are never selected.
+ * @param options: see BanditOptions.
+ **/
+Bandit::Bandit(const std::span<const fz> priors, const BanditOptions options)
+    : options_(validateOptions(options)), priors_(normalizePriors(priors)),
+      trials_(priors.size(), 0), gains_(priors.size(), 0),
+      weights_(priors_), table_(priors_) {}
+
+auto Bandit::normalizePriors(const std::span<const fz> priors) -> std::vector<fz> {
+    if (priors.empty()) {
+        throw IllegalBandit("no arm");
+    }
+    if (not std::ranges::all_of(priors, [](const fz p) { return p >= 0; })) {
+        throw IllegalBandit("negative or NaN prior");
+    }
+    const f64 total = std::accumulate(priors.begin(), priors.end(), f64{0});
+    if (not (total > 0)) {
+        throw IllegalBandit("no arm with a positive prior");
+    }
+
+    std::vector<fz> normalized(priors.size());
+    for (uz i = 0; i < priors.size(); ++i) {
+        normalized[i] = static_cast<fz>(priors[i] / total);
+    }
+    return normalized;
+}
+
+auto Bandit::validateOptions(BanditOptions options) -> BanditOptions {
+    if (not (options.decay > 0 and options.decay <= 1)) {
+        throw IllegalBandit("decay not in (0, 1]");
+    }
+    if (not (options.exploration >= 0 and options.exploration <= 1)) {
+        throw IllegalBandit("exploration not in [0, 1]");
+    }
+    options.period = std::max<uz>(1, options.period);
+    return options;
+}
+
+auto Bandit::select(Prng &prng) const noexcept -> uz {
+    return table_.sample(prng);
+}
+
+/**
+ * @brief Credit an arm with the gain of one of its selections.
+ * @param arm: index of the selected arm.
+ * @param gain: e.g. the score improvement, negative gains count as 0.
+ **/
+auto Bandit::reward(const uz arm, const fz gain) noexcept -> void {
+    assert(arm < trials_.size());
+    trials_[arm] += 1;
+    gains_[arm] += gain > 0 ? gain : 0; // also drops NaN
+    if (++pending_ >= options_.period) {
+        pending_ = 0;
+        rebuild();
+    }
+}
+
+auto Bandit::rebuild() noexcept -> void {
+    const f64 total_trials = std::accumulate(trials_.begin(), trials_.end(), f64{0});
+    const f64 total_gains = std::accumulate(gains_.begin(), gains_.end(), f64{0});
+
+    if (total_gains > 0) {
+        // Rates are shrunk toward the mean rate by one pseudo-trial,
+        // so that a single lucky selection does not take over.
+        const f64 mean_rate = total_gains / total_trials;
+        f64 total = 0;
+        for (uz i = 0; i < weights_.size(); ++i) {
+            const f64 rate = (gains_[i] + mean_rate) / (trials_[i] + 1);
+            total += priors_[i] * rate;
+        }
+        for (uz i = 0; i < weights_.size(); ++i) {
+            const f64 rate = (gains_[i] + mean_rate) / (trials_[i] + 1);
+            weights_[i] = static_cast<fz>(
+                (1 - options_.exploration) * priors_[i] * rate / total
+                + options_.exploration * priors_[i]
+            );
+        }
+    } else {
+        weights_ = priors_;
+    }
+    table_.rebuild(weights_);
+
+    for (uz i = 0; i < trials_.size(); ++i) {
+        trials_[i] *= options_.decay;
+        gains_[i] *= options_.decay;
+    }
+}
+
+/**
+ * @return the current selection probability of each arm.
+ **/
+auto Bandit::probabilities() const -> std::vector<fz> {
+    return weights_;
+}
+
+auto Bandit::size() const noexcept -> uz {
+    return priors_.size();
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef JIANHAN_LAYOUT_BANDIT_HPP
+#define JIANHAN_LAYOUT_BANDIT_HPP
+
+#include <span>
+#include <vector>
+
+#include "../common/types.hpp"
+
+namespace jianhan::v0::layout {
+
+// Walker's alias method: O(1) sampling from a fixed discrete distribution.
+class AliasTable final {
+public:
+    explicit AliasTable(std::span<const fz> weights);
+
+    AliasTable() = delete;
+
+    auto rebuild(std::span<const fz> weights) noexcept -> void;
+
+    [[nodiscard]] auto sample(Prng &prng) const noexcept -> uz;
+    [[nodiscard]] auto size() const noexcept -> uz;
+
+protected:
+    std::vector<uint64_t> thresholds_{}; // chance to keep the column, scaled to 2^32
+    std::vector<uint32_t> aliases_{};
+
+    // Scratch of rebuild(), allocated once.
+    std::vector<f64> scaled_{};
+    std::vector<uint32_t> work_{};
+};
+
+struct BanditOptions final {
+    fz decay = 0.99f;       // statistics are multiplied by decay at every rebuild
+    uz period = 256;        // number of rewards between two rebuilds
+    fz exploration = 0.1f;  // share of the selections following the prior only
+};
+
+// Adaptive pursuit of the arms with the best recent reward rates.
+// Each arm has a prior weight (e.g. the size of an area), selections
+// are proportional to prior * reward rate, mixed with the prior alone
+// for exploration, and sampled from an alias table rebuilt every
+// period rewards: selection is O(1), a reward O(1) amortized.
+class Bandit final {
+public:
+    Bandit(std::span<const fz> priors, BanditOptions options);
+
+    Bandit() = delete;
+
+    [[nodiscard]] auto select(Prng &prng) const noexcept -> uz;
+    auto reward(uz arm, fz gain) noexcept -> void;
+
+    [[nodiscard]] auto probabilities() const -> std::vector<fz>;
+    [[nodiscard]] auto size() const noexcept -> uz;
+
+protected:
+    BanditOptions options_;
+    std::vector<fz> priors_;     // normalized
+    std::vector<f64> trials_;    // decayed numbers of rewards
+    std::vector<f64> gains_;     // decayed sums of gains
+    std::vector<fz> weights_;
+    AliasTable table_;
+    uz pending_{0};
+
+    auto rebuild() noexcept -> void;
+
+private:
+    static auto normalizePriors(std::span<const fz> priors) -> std::vector<fz>;
+    static auto validateOptions(BanditOptions options) -> BanditOptions;
+
+    class IllegalBandit final : public std::invalid_argument {
+    public:
+        IllegalBandit() = delete;
+        explicit IllegalBandit(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid argument in Bandit(): {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_LAYOUT_BANDIT_HPP
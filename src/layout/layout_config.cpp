@@ -2,17 +2,65 @@
 
 namespace jianhan::v0::layout {
 
-Config::Config(const toml_t &config) {
+template<Geometry G> BasicConfig<G>::BasicConfig(const toml_t &config) {
     validateConfig(config);
     loadFixedKeys(config);
     loadAreas(config);
     makeDefatulArea();
 }
 
-auto Config::validateConfig(const toml_t &config) -> void {
+/**
+ * @brief Construct from a flat, already validated configuration.
+ * @param vals: the key values of the areas one after the other.
+ * @param positions: the positions in the same order as vals.
+ * @param area_sizes: the number of keys of each area, the keys left
+ *                    out of fixed_keys and vals form a default area.
+ **/
+template<Geometry G> BasicConfig<G>::BasicConfig(
+    const std::span<const Key> fixed_keys, const std::span<const KeyValue> vals,
+    const std::span<const Position> positions, const std::span<const uz> area_sizes
+) : fixed_keys_(fixed_keys.begin(), fixed_keys.end()),
+    num_mutable_keys_(G::KEY_COUNT - fixed_keys.size()),
+    num_fixed_keys_(fixed_keys.size()),
+    num_areas_(area_sizes.size() + 1) {
+    assert(vals.size() == positions.size());
+    for (const auto &[val, pos] : fixed_keys) {
+        processed_.set(val).set(pos);
+    }
+
+    mutable_areas_.reserve(num_areas_);
+    uz beg = 0;
+    for (uz area_id = 0; area_id < area_sizes.size(); ++area_id) {
+        const uz size = area_sizes[area_id];
+        BasicArea<G> area(size);
+        for (uz i = beg; i < beg + size; ++i) {
+            area.addKeyValue(vals[i]);
+            area.addPosition(positions[i]);
+            processed_.set(vals[i]).set(positions[i]);
+        }
+        std::ranges::sort(area.key_codes_);
+        area.buildShuffles();
+        mutable_areas_.emplace_back(std::move(area));
+        area_ids_.insert(area_ids_.end(), size, area_id);
+        beg += size;
+    }
+    makeDefatulArea();
+    num_areas_ = mutable_areas_.size(); // with the default area only if built
+}
+
+/**
+ * @brief All the keys of the geometry in a single mutable area,
+ *        the same as an empty TOML configuration.
+ **/
+template<Geometry G> auto BasicConfig<G>::allMutable() -> BasicConfig {
+    return BasicConfig({}, {}, {}, {});
+}
+
+template<Geometry G> auto BasicConfig<G>::validateConfig(const toml_t &config) -> void {
     static constexpr uz MIN_MUTABLE_KEYS = 2;
 
     where_.fill(nullptr);
+    processed_.reset();
 
     // Check fixed keys
     if (config.contains("fixed_key")) {
@@ -28,7 +76,7 @@ auto Config::validateConfig(const toml_t &config) -> void {
     }
 
     // Check number of mutable keys
-    num_mutable_keys_ = KEY_COUNT - num_fixed_keys_;
+    num_mutable_keys_ = G::KEY_COUNT - num_fixed_keys_;
     if (num_mutable_keys_ < MIN_MUTABLE_KEYS) {
         throw IllegalSetting(fmt::format(
             "unable to gengrate adequate samples:\n"
@@ -52,7 +100,7 @@ auto Config::validateConfig(const toml_t &config) -> void {
     }
 }
 
-auto Config::checkIfAllRequiredFieldsExist(const toml_t &config) -> void {
+template<Geometry G> auto BasicConfig<G>::checkIfAllRequiredFieldsExist(const toml_t &config) -> void {
     if (not config.contains("val")) {
         throw IllegalSetting(format_error(
             "missing key `val` in table:",
@@ -67,7 +115,7 @@ auto Config::checkIfAllRequiredFieldsExist(const toml_t &config) -> void {
     }
 }
 
-auto Config::checkFieldSizes(const toml_t &area_config) -> void {
+template<Geometry G> auto BasicConfig<G>::checkFieldSizes(const toml_t &area_config) -> void {
     const toml_t &val_settings = area_config.at("val");
     const toml_t &pos_settings = area_config.at("pos");
 
@@ -102,31 +150,31 @@ auto Config::checkFieldSizes(const toml_t &area_config) -> void {
     }
 
     if (const uz size = num_val;
-        size < 2 or size > KEY_COUNT) {
+        size < 2 or size > G::KEY_COUNT) {
         throw IllegalSetting(format_error(
             "illegal area size: out of range:",
             val_settings, make_size_comment(num_val),
             pos_settings, make_size_comment(num_pos),
-            {"size of area should be in range [2, 30]"}
+            {fmt::format("size of area should be in range [2, {:d}]", G::KEY_COUNT)}
         ));
     }
 }
 
-auto Config::checkKeyValues(const toml_t &area_config) -> void {
+template<Geometry G> auto BasicConfig<G>::checkKeyValues(const toml_t &area_config) -> void {
     const toml_t &val_settings = area_config.at("val");
     for (const toml_t &val : val_settings.as_array()) {
         checkKeyValue(val);
     }
 }
 
-auto Config::checkPositions(const toml_t &area_config) -> void {
+template<Geometry G> auto BasicConfig<G>::checkPositions(const toml_t &area_config) -> void {
     const toml_t &pos_settings = area_config.at("pos");
     for (const toml_t &pos : pos_settings.as_array()) {
         checkPosition(pos);
     }
 }
 
-auto Config::checkKeyValue(const toml_t &val) -> void {
+template<Geometry G> auto BasicConfig<G>::checkKeyValue(const toml_t &val) -> void {
     if (not val.is_string()) {
         throw IllegalSetting(format_error(
             "illegal type for key value:",
@@ -146,13 +194,13 @@ auto Config::checkKeyValue(const toml_t &val) -> void {
 
     const auto v = static_cast<KeyValue>(str[0]);
 
-    // key value should be a capital letter or
-    // one of the 4 symbols: ',', '.', ';', '/'
-    if (not Util::isKeyValueLegal(v)) {
+    // key value should be one of the key codes of the geometry,
+    // e.g. a capital letter or one of the 4 symbols: ',', '.', ';', '/'
+    if (not BasicUtil<G>::isKeyValueLegal(v)) {
+        const std::string_view codes(reinterpret_cast<const char *>(G::KEY_CODES.data()), G::KEY_COUNT);
         throw IllegalSetting(format_error(
             "illegal key value:",
-            val, "should be a capital letter "
-            "or one of the 4 symbols: ',', '.', ';' and '/'"
+            val, fmt::format("should be one of \"{:s}\"", codes)
         ));
     }
 
@@ -166,13 +214,14 @@ auto Config::checkKeyValue(const toml_t &val) -> void {
     }
 
     where_[v] = &val;
+    processed_.set(v);
 }
 
-auto Config::isValProcessed(const KeyValue val) const -> bool {
-    return where_[val] != nullptr;
+template<Geometry G> auto BasicConfig<G>::isValProcessed(const KeyValue val) const -> bool {
+    return processed_[val];
 }
 
-auto Config::checkPosition(const toml_t &pos) -> void {
+template<Geometry G> auto BasicConfig<G>::checkPosition(const toml_t &pos) -> void {
     if (not pos.is_integer()) {
         throw IllegalSetting(format_error(
             "illegal type for position:",
@@ -182,11 +231,11 @@ auto Config::checkPosition(const toml_t &pos) -> void {
 
     const auto p = static_cast<Position>(pos.as_integer());
 
-    // position should be in range [0, 29]
-    if (not Util::isPositionLegal(p)) {
+    // position should be in range [0, KEY_COUNT)
+    if (not BasicUtil<G>::isPositionLegal(p)) {
         throw IllegalSetting(format_error(
             "position out of range:",
-            pos, "should be in range [0, 29]"
+            pos, fmt::format("should be in range [0, {:d}]", G::KEY_COUNT - 1)
         ));
     }
 
@@ -200,13 +249,14 @@ auto Config::checkPosition(const toml_t &pos) -> void {
     }
 
     where_[p] = &pos;
+    processed_.set(p);
 }
 
-auto Config::isPosProcessed(const Position pos) const -> bool {
-    return where_[pos] != nullptr;
+template<Geometry G> auto BasicConfig<G>::isPosProcessed(const Position pos) const -> bool {
+    return processed_[pos];
 }
 
-auto Config::loadFixedKeys(const toml_t &config) -> void {
+template<Geometry G> auto BasicConfig<G>::loadFixedKeys(const toml_t &config) -> void {
     if (not config.contains("fixed_key")) {
         return;
     }
@@ -218,7 +268,7 @@ auto Config::loadFixedKeys(const toml_t &config) -> void {
     }
 }
 
-auto Config::loadAreas(const toml_t &config) -> void {
+template<Geometry G> auto BasicConfig<G>::loadAreas(const toml_t &config) -> void {
     if (not config.contains("mutable_area")) {
         return;
     }
@@ -231,10 +281,10 @@ auto Config::loadAreas(const toml_t &config) -> void {
     }
 }
 
-auto Config::makeDefatulArea() -> void {
+template<Geometry G> auto BasicConfig<G>::makeDefatulArea() -> void {
     // Find if there's any unprocessed keys left
     num_unprocessed_keys_ = num_mutable_keys_;
-    for (const Area &area : mutable_areas_) {
+    for (const BasicArea<G> &area : mutable_areas_) {
         num_unprocessed_keys_ -= area.size_;
     }
 
@@ -243,20 +293,21 @@ auto Config::makeDefatulArea() -> void {
     if (num_unprocessed_keys_ == 0) {
         return;
     }
-    Area area(num_unprocessed_keys_);
+    BasicArea<G> area(num_unprocessed_keys_);
 
     // Fill with the remaininig key values and positions
-    for (const KeyValue val : KEY_CODES) {
+    for (const KeyValue val : G::KEY_CODES) {
         if (not isValProcessed(val)) {
             area.addKeyValue(val);
         }
     }
-    for (const Position pos : POSITIONS) {
+    for (const Position pos : BasicUtil<G>::POSITIONS) {
         if (not isPosProcessed(pos)) {
             area.addPosition(pos);
         }
     }
     std::ranges::sort(area.key_codes_);
+    area.buildShuffles();
     mutable_areas_.emplace_back(area);
 
     // Update area_ids_
@@ -264,4 +315,8 @@ auto Config::makeDefatulArea() -> void {
     area_ids_.insert(area_ids_.end(), area.size_, area_id);
 }
 
+template class BasicConfig<Geometry30>;
+template class BasicConfig<Geometry40>;
+template class BasicConfig<GeometrySplit34>;
+
 }
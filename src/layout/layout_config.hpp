@@ -1,20 +1,23 @@
 #ifndef JIANHAN_LAYOUT_CONFIG_HPP
 #define JIANHAN_LAYOUT_CONFIG_HPP
 
+#include <span>
+
 #include "layout_area.hpp"
 
 namespace jianhan::v0::layout {
 
-class Manager;
-
-class Config final {
+template<Geometry G> class BasicConfig final {
 public:
-    explicit Config(const toml_t &config);
+    explicit BasicConfig(const toml_t &config);
 
-    Config() = delete;
+    BasicConfig() = delete;
+
+    template<auto CONFIG> [[nodiscard]] static auto fromStatic() -> BasicConfig;
+    [[nodiscard]] static auto allMutable() -> BasicConfig;
 
 protected:
-    std::vector<Area> mutable_areas_{};
+    std::vector<BasicArea<G>> mutable_areas_{};
     std::vector<Key> fixed_keys_{};
     std::vector<uz> area_ids_{};
 
@@ -28,9 +31,13 @@ protected:
     auto makeDefatulArea() -> void;
 
 private:
-    std::array<const toml_t *, MAX_KEY_CODE> where_{nullptr};
+    std::array<const toml_t *, G::MAX_KEY_CODE> where_{nullptr}; // for error messages
+    std::bitset<G::MAX_KEY_CODE> processed_{};
     uz num_unprocessed_keys_{};
 
+    BasicConfig(std::span<const Key> fixed_keys, std::span<const KeyValue> vals,
+                std::span<const Position> positions, std::span<const uz> area_sizes);
+
     static auto checkIfAllRequiredFieldsExist(const toml_t &config) -> void;
     static auto checkFieldSizes(const toml_t &area_config) -> void;
 
@@ -60,9 +67,22 @@ private:
         }
     };
 
-    friend class Manager;
+    friend class BasicManager<G>;
 };
 
+/**
+ * @brief Build a configuration from its compile-time form, without any
+ *        parsing: e.g. fromStatic<static_config::DEFAULT>().
+ * @tparam CONFIG: a StaticConfig, checked at compile time.
+ **/
+template<Geometry G>
+template<auto CONFIG> auto BasicConfig<G>::fromStatic() -> BasicConfig {
+    static_assert(CONFIG.template valid<G>(), "invalid static layout configuration");
+    return BasicConfig(CONFIG.fixed_keys, CONFIG.vals, CONFIG.positions, decltype(CONFIG)::AREA_SIZES);
+}
+
+using Config = BasicConfig<Geometry30>;
+
 }
 
 #endif // JIANHAN_LAYOUT_CONFIG_HPP
@@ -0,0 +1,136 @@
+#include "layout_distance.hpp"
+
+#include <bit>
+#include <cstring>
+#include <immintrin.h>
+
+namespace jianhan::v0::layout {
+
+/**
+ * @brief Construct a per-area distance over the mutable areas of a manager.
+ **/
+Distance::Distance(const Manager &manager) {
+    for (const Area &area : manager.mutable_areas_) {
+        uint32_t mask = 0;
+        for (const Position pos : area.positions_) {
+            mask |= 1u << pos;
+        }
+        area_masks_.emplace_back(mask);
+    }
+}
+
+auto Distance::numAreas() const noexcept -> uz {
+    return area_masks_.size();
+}
+
+auto Distance::mismatches(const KeyValue *const lhs, const KeyValue *const rhs) noexcept -> uint32_t {
+    // Positions 30 and 31 are never written (KeyValue >= 44),
+    // thus always equal: the first 32 bytes can be compared at once.
+#ifdef __AVX2__
+    const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs));
+    const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs));
+    const auto equal = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+#else
+    const __m128i l0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs));
+    const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs));
+    const __m128i l1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + 16));
+    const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + 16));
+    const auto equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(l0, r0)))
+                       | static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(l1, r1))) << 16;
+#endif
+    return ~equal & ((1u << KEY_COUNT) - 1);
+}
+
+/**
+ * @return a mask whose bit p is set if the keys at position p differ.
+ **/
+auto Distance::mismatches(const Layout &lhs, const Layout &rhs) noexcept -> uint32_t {
+    return mismatches(lhs.key_mappings_.data(), rhs.key_mappings_.data());
+}
+
+/**
+ * @return the number of positions holding different keys, ∈ [0, 30].
+ **/
+auto Distance::hamming(const Layout &lhs, const Layout &rhs) noexcept -> uz {
+    return std::popcount(mismatches(lhs, rhs));
+}
+
+/**
+ * @return the minimum number of swaps to turn lhs into rhs, ∈ [0, 29].
+ * @note Each cycle of length L of the permutation between the two layouts
+ *       takes L - 1 swaps. Matching positions (cycles of length 1) are
+ *       skipped with the mismatch mask, so that only the differing
+ *       positions are visited.
+ **/
+auto Distance::swap(const Layout &lhs, const Layout &rhs) noexcept -> uz {
+    uint32_t unvisited = mismatches(lhs, rhs);
+    uz num_swaps = 0;
+    while (unvisited != 0) {
+        const auto start = static_cast<Position>(std::countr_zero(unvisited));
+        Position pos = start;
+        uz length = 0;
+        do {
+            unvisited &= ~(1u << pos);
+            pos = rhs.getPos(lhs.getVal(pos));
+            ++length;
+        } while (pos != start);
+        num_swaps += length - 1;
+    }
+    return num_swaps;
+}
+
+/**
+ * @brief Hamming distance restricted to the positions of each mutable area.
+ * @param distances: output, one distance per area, see numAreas().
+ **/
+auto Distance::perArea(const Layout &lhs, const Layout &rhs,
+                       const std::span<uz> distances) const noexcept -> void {
+    assert(distances.size() == area_masks_.size());
+    const uint32_t mask = mismatches(lhs, rhs);
+    for (uz i = 0; i < area_masks_.size(); ++i) {
+        distances[i] = std::popcount(mask & area_masks_[i]);
+    }
+}
+
+/**
+ * @brief Distances between all pairs of layouts.
+ * @param layouts: valid layouts.
+ * @param metric: distance metric.
+ * @return a symmetric n * n matrix, the distance between
+ *         layouts i and j is at (i * n + j).
+ * @note Tiles of the upper triangle are distributed over OpenMP threads.
+ **/
+auto Distance::allPairs(const std::span<const Layout> layouts, const Metric metric) -> std::vector<u8> {
+    const uz n = layouts.size();
+    std::vector<u8> distances(n * n, 0);
+
+    // Pack the position -> key tables contiguously,
+    // 32 bytes each, for the hamming distance.
+    std::vector<KeyRow> rows;
+    if (metric == Metric::Hamming) {
+        rows.resize(n);
+        for (uz i = 0; i < n; ++i) {
+            std::memcpy(rows[i].data(), layouts[i].key_mappings_.data(), sizeof(KeyRow));
+        }
+    }
+
+    const uz num_tiles = (n + TILE - 1) / TILE;
+#pragma omp parallel for schedule(dynamic) shared(layouts, rows, distances) firstprivate(n, num_tiles, metric) default(none)
+    for (uz ti = 0; ti < num_tiles; ++ti) {
+        const uz i_end = std::min(n, (ti + 1) * TILE);
+        for (uz tj = ti; tj < num_tiles; ++tj) {
+            const uz j_end = std::min(n, (tj + 1) * TILE);
+            for (uz i = ti * TILE; i < i_end; ++i) {
+                for (uz j = std::max(i + 1, tj * TILE); j < j_end; ++j) {
+                    const uz d = metric == Metric::Hamming
+                                     ? std::popcount(mismatches(rows[i].data(), rows[j].data()))
+                                     : swap(layouts[i], layouts[j]);
+                    distances[i * n + j] = distances[j * n + i] = static_cast<u8>(d);
+                }
+            }
+        }
+    }
+    return distances;
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef JIANHAN_LAYOUT_DISTANCE_HPP
+#define JIANHAN_LAYOUT_DISTANCE_HPP
+
+#include <span>
+
+#include "layout_manager.hpp"
+
+namespace jianhan::v0::layout {
+
+enum class Metric : u8 {
+    Hamming, // number of positions holding different keys
+    Swap,    // minimum number of swaps (Cayley distance)
+};
+
+class Distance final {
+public:
+    explicit Distance(const Manager &manager);
+
+    Distance() = delete;
+
+    [[nodiscard]] static auto mismatches(const Layout &lhs, const Layout &rhs) noexcept -> uint32_t;
+    [[nodiscard]] static auto hamming(const Layout &lhs, const Layout &rhs) noexcept -> uz;
+    [[nodiscard]] static auto swap(const Layout &lhs, const Layout &rhs) noexcept -> uz;
+
+    static auto allPairs(std::span<const Layout> layouts, Metric metric) -> std::vector<u8>;
+
+    auto perArea(const Layout &lhs, const Layout &rhs, std::span<uz> distances) const noexcept -> void;
+
+    [[nodiscard]] auto numAreas() const noexcept -> uz;
+
+protected:
+    std::vector<uint32_t> area_masks_{}; // bit p is set if position p is in the area
+
+private:
+    // Layouts are processed in square tiles, so that
+    // both sides of a tile stay in the L1 cache.
+    static constexpr uz TILE = 64;
+
+    using KeyRow = std::array<KeyValue, KEY_CNT_POW2>;
+
+    static auto mismatches(const KeyValue *lhs, const KeyValue *rhs) noexcept -> uint32_t;
+};
+
+}
+
+#endif // JIANHAN_LAYOUT_DISTANCE_HPP
@@ -1,35 +1,120 @@
 #include "layout_manager.hpp"
 
+#include <algorithm>
+#include <ranges>
+
 namespace jianhan::v0::layout {
 
-Manager::Manager()
-    : mutable_areas_(config_.mutable_areas_),
-      fixed_keys_(config_.fixed_keys_),
-      area_ids_(config_.area_ids_),
-      need_to_select_area_(config_.num_areas_ > 1),
-      have_fixed_key_(config_.num_fixed_keys_ > 0),
-      lim_(config_.num_mutable_keys_), idx_(lim_ + 1) {}
+template<Geometry G> BasicManager<G>::BasicManager()
+    : BasicManager(loadedConfig()) {}
+
+/**
+ * @brief Construct a manager for a specific configuration,
+ *        regardless of the one loaded by loadConfig().
+ **/
+template<Geometry G> BasicManager<G>::BasicManager(const Config &config)
+    : mutable_areas_(config.mutable_areas_),
+      fixed_keys_(config.fixed_keys_),
+      area_ids_(config.area_ids_),
+      need_to_select_area_(config.num_areas_ > 1),
+      have_fixed_key_(config.num_fixed_keys_ > 0),
+      lim_(config.num_mutable_keys_), idx_(lim_ + 1) {
+    assignFixedKeys(base_);
+}
+
+template<Geometry G> auto BasicManager<G>::loadConfig(const toml_t &config) -> void {
+    loadedConfig() = Config(config);
+}
+
+/**
+ * @brief The configuration of the managers constructed by default, built
+ *        on first use: static_config::DEFAULT for the reference geometry,
+ *        all the keys mutable for the others, until loadConfig().
+ **/
+template<Geometry G> auto BasicManager<G>::loadedConfig() -> Config & {
+    static Config config = []() -> Config {
+        if constexpr (std::same_as<G, Geometry30>) {
+            return Config::template fromStatic<static_config::DEFAULT>();
+        } else {
+            return Config::allMutable();
+        }
+    }();
+    return config;
+}
+
+template<Geometry G> auto BasicManager<G>::seed(const uint64_t seed) noexcept -> void {
+    prng_.seed(seed);
+}
+
+/**
+ * @brief Capture the mutation state: the PRNG, the shuffled area ids
+ *        and the shuffled positions of each area, with their cursors.
+ **/
+template<Geometry G> auto BasicManager<G>::state() const -> ManagerState {
+    ManagerState state{prng_.state(), idx_, area_ids_, {}, {}};
+    state.area_positions.reserve(mutable_areas_.size());
+    state.area_idxs.reserve(mutable_areas_.size());
+    for (const Area &area : mutable_areas_) {
+        state.area_positions.emplace_back(area.positions_);
+        state.area_idxs.emplace_back(area.idx_);
+    }
+    return state;
+}
+
+/**
+ * @brief Resume from a state captured by state(), so that the following
+ *        mutations are exactly the ones the original manager would make.
+ * @param state: a state of a manager with the same configuration.
+ * @note The state is checked against the configuration, an exception
+ *       is thrown (and nothing is changed) if they do not match.
+ **/
+template<Geometry G> auto BasicManager<G>::restore(const ManagerState &state) -> void {
+    const auto is_permutation_of = [](auto lhs, auto rhs) -> bool {
+        std::ranges::sort(lhs), std::ranges::sort(rhs);
+        return lhs == rhs;
+    };
+
+    if (state.area_positions.size() != mutable_areas_.size()
+        or state.area_idxs.size() != mutable_areas_.size()) {
+        throw IllegalState("number of areas mismatch");
+    }
+    if (state.idx > lim_ + 1 or not is_permutation_of(state.area_ids, area_ids_)) {
+        throw IllegalState("area ids mismatch");
+    }
+    for (uz i = 0; i < mutable_areas_.size(); ++i) {
+        const Area &area = mutable_areas_[i];
+        if (state.area_idxs[i] > area.lim_ + 1
+            or not is_permutation_of(state.area_positions[i], area.positions_)) {
+            throw IllegalState(fmt::format("positions of area {} mismatch", i));
+        }
+    }
 
-auto Manager::loadConfig(const toml_t &config) -> void {
-    config_ = Config(config);
+    prng_.setState(state.prng);
+    idx_ = state.idx;
+    area_ids_ = state.area_ids;
+    for (uz i = 0; i < mutable_areas_.size(); ++i) {
+        mutable_areas_[i].positions_ = state.area_positions[i];
+        mutable_areas_[i].idx_ = state.area_idxs[i];
+    }
 }
 
-auto Manager::create() noexcept -> Layout {
-    Layout layout;
-    assignFixedKeys(layout);
+template<Geometry G> auto BasicManager<G>::create() noexcept -> Layout {
+    // Fixed keys are copied from the precomputed base layout,
+    // then each area blends its keys in (see Area::assign()).
+    Layout layout = base_;
     assignMutableKeys(layout);
     assert(layout.valid());
     return layout;
 }
 
-auto Manager::assignFixedKeys(Layout &layout) noexcept -> void {
+template<Geometry G> auto BasicManager<G>::assignFixedKeys(Layout &layout) noexcept -> void {
     if (not have_fixed_key_) { return; }
     for (const auto &[val, pos] : fixed_keys_) {
         layout.setPosValPair(val, pos);
     }
 }
 
-auto Manager::assignMutableKeys(Layout &layout) noexcept -> void {
+template<Geometry G> auto BasicManager<G>::assignMutableKeys(Layout &layout) noexcept -> void {
     for (Area &area : mutable_areas_) {
         area.assign(layout, prng_);
     }
@@ -43,7 +128,7 @@ auto Manager::assignMutableKeys(Layout &layout) noexcept -> void {
  * @note - This function may cause undefined behavior if target layout
  *         is not valid or unmanagable, for the argument is not checked.
  **/
-auto Manager::reinit(Layout &layout) noexcept -> void {
+template<Geometry G> auto BasicManager<G>::reinit(Layout &layout) noexcept -> void {
     assert(layout.valid() and canManage(layout));
     assignMutableKeys(layout);
     assert(layout.valid());
@@ -59,18 +144,214 @@ auto Manager::reinit(Layout &layout) noexcept -> void {
  * @note - This function may cause undefined behavior if parent layout
  *         is not valid or unmanagable, for the arguments are not checked.
  **/
-auto Manager::mutate(Layout &target, const Layout &parent) noexcept -> void {
+template<Geometry G> auto BasicManager<G>::mutate(Layout &target, const Layout &parent) noexcept -> void {
     assert(parent.valid() and canManage(parent));
     target.key_mappings_ = parent.key_mappings_;
+    std::ignore = mutate(target);
+}
+
+/**
+ * @brief Slightly modify a layout in place, the same way as mutate(target, parent).
+ * @param layout: a valid and manageable layout.
+ * @return the move, which undo() reverts: a rejected move costs a few
+ *         swaps instead of a copy of the parent and the move.
+ * @note The move consumes the same random numbers as mutate(target, parent),
+ *       undoing it does not give them back.
+ **/
+template<Geometry G> auto BasicManager<G>::mutate(Layout &layout) noexcept -> Move {
+    return mutate(layout, randomlySelectAnOperator());
+}
+
+/**
+ * @brief Apply a move of a given operator in place.
+ * @param layout: a valid and manageable layout.
+ * @param op: the move operator, see Operator.
+ * @return the move, which undo() reverts.
+ **/
+template<Geometry G> auto BasicManager<G>::mutate(Layout &layout, const Operator op) noexcept -> Move {
+    assert(layout.valid() and canManage(layout));
     Area &rand_area = randomlySelectAnArea();
-    rand_area.mutate(target, prng_);
-    assert(target.valid());
+
+    Move move{};
+    switch (op) {
+    case Operator::Swap:
+        move = rand_area.mutate(layout, prng_);
+        break;
+    case Operator::Cycle:
+        move = rand_area.cycle(layout, prng_);
+        break;
+    case Operator::Reverse:
+        move = rand_area.reverse(layout, prng_);
+        break;
+    case Operator::KSwap: {
+        static constexpr uz MAX_K = 4;
+        const uz k = std::uniform_int_distribution<uz>(2, MAX_K)(prng_);
+        for (uz i = 0; i < k; ++i) {
+            const auto [pos1, pos2] = rand_area.mutate(layout, prng_).swaps[0];
+            move.add(pos1, pos2);
+        }
+        break;
+    }
+    case Operator::CrossArea: {
+        // Keys never leave their area, so a cross-area move
+        // is a simultaneous swap in two different areas.
+        move = rand_area.mutate(layout, prng_);
+        if (need_to_select_area_) {
+            Area *other = &randomlySelectAnArea();
+            for (uz tries = 1; other == &rand_area and tries < lim_; ++tries) {
+                other = &randomlySelectAnArea();
+            }
+            if (other != &rand_area) {
+                const auto [pos1, pos2] = other->mutate(layout, prng_).swaps[0];
+                move.add(pos1, pos2);
+            }
+        }
+        break;
+    }
+    }
+    move.area = static_cast<u8>(&rand_area - mutable_areas_.data());
+    move.op = op;
+    assert(layout.valid());
+    return move;
+}
+
+/**
+ * @brief Revert the last move applied to a layout by mutate(layout).
+ * @param layout: the layout the move was applied to.
+ * @param move: the record returned by mutate(layout).
+ * @note Moves must be undone in the reverse order of their application.
+ **/
+template<Geometry G> auto BasicManager<G>::undo(Layout &layout, const Move &move) const noexcept -> void {
+    assert(move.area < mutable_areas_.size());
+    for (const auto [pos1, pos2] : move.applied() | std::views::reverse) {
+        layout.swapKeyValues(pos1, pos2);
+    }
+}
+
+/**
+ * @brief Set how often each operator is picked by mutate().
+ * @param weights: non-negative, at least one positive.
+ **/
+template<Geometry G> auto BasicManager<G>::setOperatorWeights(const OperatorWeights &weights) -> void {
+    fz total = 0;
+    OperatorWeights cumulative{};
+    for (uz i = 0; i < NUM_OPERATORS; ++i) {
+        if (not (weights[i] >= 0)) { // also rejects NaN
+            throw IllegalWeights(fmt::format("negative weight for operator {}", i));
+        }
+        total += weights[i];
+        cumulative[i] = total;
+    }
+    if (not (total > 0)) {
+        throw IllegalWeights("no operator enabled");
+    }
+    op_weights_ = weights;
+    op_cumulative_ = cumulative;
+    have_several_ops_ = std::ranges::count_if(weights, [](const fz w) { return w > 0; }) > 1;
+    if (bandit_options_) {
+        enableAdaptiveSelection(*bandit_options_);
+    }
+}
+
+template<Geometry G> auto BasicManager<G>::operatorWeights() const noexcept -> const OperatorWeights & {
+    return op_weights_;
+}
+
+/**
+ * @brief Select areas and operators by their recent improvement rates
+ *        instead of their sizes and weights alone (see Bandit).
+ * @param options: see BanditOptions.
+ * @note - The sizes of the areas and the operator weights are the priors,
+ *         the statistics start from scratch.
+ * @note - Moves have to be rewarded with reward() for the selection to adapt.
+ * @note - The statistics are not part of state(), so adaptive runs do not
+ *         resume bit-exactly.
+ **/
+template<Geometry G> auto BasicManager<G>::enableAdaptiveSelection(const BanditOptions options) -> void {
+    area_bandit_.reset();
+    op_bandit_.reset();
+    if (need_to_select_area_) {
+        std::vector<fz> sizes;
+        for (const Area &area : mutable_areas_) {
+            sizes.emplace_back(static_cast<fz>(area.size_));
+        }
+        area_bandit_.emplace(sizes, options);
+    }
+    if (have_several_ops_) {
+        op_bandit_.emplace(op_weights_, options);
+    }
+    bandit_options_ = options;
+}
+
+template<Geometry G> auto BasicManager<G>::disableAdaptiveSelection() noexcept -> void {
+    bandit_options_.reset();
+    area_bandit_.reset();
+    op_bandit_.reset();
+}
+
+/**
+ * @brief Credit the area and the operator of a move with its outcome.
+ * @param move: a move returned by mutate(layout).
+ * @param gain: improvement made by the move, e.g. -Evaluator::delta(),
+ *              negative gains count as 0.
+ * @note Does nothing unless adaptive selection is enabled.
+ **/
+template<Geometry G> auto BasicManager<G>::reward(const Move &move, const fz gain) noexcept -> void {
+    if (area_bandit_) { area_bandit_->reward(move.area, gain); }
+    if (op_bandit_) { op_bandit_->reward(static_cast<uz>(move.op), gain); }
 }
 
-auto Manager::randomlySelectAnArea() noexcept -> Area & {
+/**
+ * @return the current selection probability of each area.
+ **/
+template<Geometry G> auto BasicManager<G>::areaProbabilities() const -> std::vector<fz> {
+    if (area_bandit_) {
+        return area_bandit_->probabilities();
+    }
+    std::vector<fz> probabilities;
+    for (const Area &area : mutable_areas_) {
+        probabilities.emplace_back(static_cast<fz>(area.size_) / static_cast<fz>(lim_));
+    }
+    return probabilities;
+}
+
+/**
+ * @return the current selection probability of each operator.
+ **/
+template<Geometry G> auto BasicManager<G>::operatorProbabilities() const -> std::vector<fz> {
+    if (op_bandit_) {
+        return op_bandit_->probabilities();
+    }
+    const fz total = op_cumulative_.back();
+    std::vector<fz> probabilities;
+    for (const fz weight : op_weights_) {
+        probabilities.emplace_back(weight / total);
+    }
+    return probabilities;
+}
+
+template<Geometry G> auto BasicManager<G>::randomlySelectAnOperator() noexcept -> Operator {
+    if (op_bandit_) {
+        return static_cast<Operator>(op_bandit_->select(prng_));
+    }
+    if (not have_several_ops_) {
+        // No random number is drawn, so that a single operator
+        // gives the same moves as before operators existed.
+        const auto it = std::ranges::find_if(op_weights_, [](const fz w) { return w > 0; });
+        return static_cast<Operator>(it - op_weights_.begin());
+    }
+    const fz r = std::uniform_real_distribution<fz>(0, op_cumulative_.back())(prng_);
+    const auto it = std::ranges::upper_bound(op_cumulative_, r);
+    return static_cast<Operator>(std::min<uz>(it - op_cumulative_.begin(), NUM_OPERATORS - 1));
+}
+
+template<Geometry G> auto BasicManager<G>::randomlySelectAnArea() noexcept -> Area & {
     if (not need_to_select_area_) {
         return mutable_areas_[0];
     }
+    if (area_bandit_) {
+        return mutable_areas_[area_bandit_->select(prng_)];
+    }
 
     // When all the area ids have been visited,
     // reshuffle area_ids_ and reset idx_ to 0.
@@ -84,16 +365,20 @@ auto Manager::randomlySelectAnArea() noexcept -> Area & {
     return mutable_areas_[random_id];
 }
 
-auto Manager::reset() noexcept -> void {
+template<Geometry G> auto BasicManager<G>::reset() noexcept -> void {
     std::ranges::shuffle(area_ids_, prng_);
     idx_ = 0;
 }
 
-auto Manager::canManage(const Layout &layout) const noexcept -> bool {
+template<Geometry G> auto BasicManager<G>::canManage(const Layout &layout) const noexcept -> bool {
     // Check if the layout is compatible with the manager's configuration.
     return std::ranges::all_of(mutable_areas_, [&layout](const Area &area) -> bool {
         return area.isCompatible(layout);
     });
 }
 
+template class BasicManager<Geometry30>;
+template class BasicManager<Geometry40>;
+template class BasicManager<GeometrySplit34>;
+
 }
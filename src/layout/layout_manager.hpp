@@ -1,15 +1,19 @@
 #ifndef JIANHAN_LAYOUT_MANAGER_HPP
 #define JIANHAN_LAYOUT_MANAGER_HPP
 
+#include <optional>
+
+#include "layout_bandit.hpp"
 #include "layout_config.hpp"
+#include "layout_static.hpp"
 
 namespace jianhan::v0::layout {
 
 namespace default_config {
 
-using namespace toml::literals::toml_literals;
-
-static const auto toml = u8R"(
+// The built-in configuration, for reference: managers are built from
+// its precompiled form, static_config::DEFAULT, and never parse it.
+inline constexpr std::string_view TOML = R"(
         [[mutable_area]]
         val = ["Z", "X", "C", "V"]
         pos = [20, 21, 22, 23]
@@ -29,18 +33,59 @@ static const auto toml = u8R"(
         [[fixed_key]]
         val = "/"
         pos = 29
-    )"_toml;
+    )";
+
+// TOML parsed on demand.
+inline auto toml() -> toml_t {
+    return toml::literals::operator""_toml(TOML.data(), TOML.size());
+}
+
 }
 
-class Manager final {
+// Everything a manager changes while mutating layouts,
+// enough to resume the mutation sequence bit-exactly.
+struct ManagerState final {
+    Prng::state_type prng;
+    uz idx;
+    std::vector<uz> area_ids;
+    std::vector<std::vector<Position>> area_positions;
+    std::vector<uz> area_idxs;
+};
+
+// Relative frequencies of the move operators, indexed by Operator.
+using OperatorWeights = std::array<fz, NUM_OPERATORS>;
+
+template<Geometry G> class BasicManager final {
 public:
-    Manager();
+    using Layout = BasicLayout<G>;
+    using Area = BasicArea<G>;
+    using Config = BasicConfig<G>;
+
+    BasicManager();
+    explicit BasicManager(const Config &config);
 
     static auto loadConfig(const toml_t &config) -> void;
 
+    auto seed(uint64_t seed) noexcept -> void;
+
+    [[nodiscard]] auto state() const -> ManagerState;
+    auto restore(const ManagerState &state) -> void;
+
     auto create() noexcept -> Layout;
     auto reinit(Layout &layout) noexcept -> void;
     auto mutate(Layout &target, const Layout &parent) noexcept -> void;
+    auto mutate(Layout &layout) noexcept -> Move;
+    auto mutate(Layout &layout, Operator op) noexcept -> Move;
+    auto undo(Layout &layout, const Move &move) const noexcept -> void;
+
+    auto setOperatorWeights(const OperatorWeights &weights) -> void;
+    [[nodiscard]] auto operatorWeights() const noexcept -> const OperatorWeights &;
+
+    auto enableAdaptiveSelection(BanditOptions options = {}) -> void;
+    auto disableAdaptiveSelection() noexcept -> void;
+    auto reward(const Move &move, fz gain) noexcept -> void;
+    [[nodiscard]] auto areaProbabilities() const -> std::vector<fz>;
+    [[nodiscard]] auto operatorProbabilities() const -> std::vector<fz>;
 
     [[nodiscard]] auto canManage(const Layout &layout) const noexcept -> bool;
 
@@ -51,6 +96,20 @@ protected:
 
     Prng prng_{};
 
+    // The fixed keys alone, the starting point of every created layout.
+    Layout base_{};
+
+    // Only swaps by default, the cumulative weights are used
+    // when several operators are enabled.
+    OperatorWeights op_weights_{1};
+    OperatorWeights op_cumulative_{1, 1, 1, 1, 1};
+    bool have_several_ops_{false};
+
+    // Adaptive selection, learned from the rewards of the moves.
+    std::optional<BanditOptions> bandit_options_{};
+    std::optional<Bandit> area_bandit_{};
+    std::optional<Bandit> op_bandit_{};
+
     const bool need_to_select_area_;
     const bool have_fixed_key_;
 
@@ -59,14 +118,44 @@ protected:
 
     auto reset() noexcept -> void;
     auto randomlySelectAnArea() noexcept -> Area &;
+    auto randomlySelectAnOperator() noexcept -> Operator;
 
 private:
-    inline static Config config_{default_config::toml};
+    static auto loadedConfig() -> Config &;
 
     auto assignFixedKeys(Layout &layout) noexcept -> void;
     auto assignMutableKeys(Layout &layout) noexcept -> void;
+
+    class IllegalState final : public std::invalid_argument {
+    public:
+        IllegalState() = delete;
+        explicit IllegalState(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{
+            "invalid argument in Manager::restore(const ManagerState &): {:s}"
+        };
+    };
+
+    class IllegalWeights final : public std::invalid_argument {
+    public:
+        IllegalWeights() = delete;
+        explicit IllegalWeights(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{
+            "invalid argument in Manager::setOperatorWeights(): {:s}"
+        };
+    };
+
+    friend class Ranker;
+    friend class Distance;
 };
 
+using Manager = BasicManager<Geometry30>;
+
 }
 
 #endif // JIANHAN_LAYOUT_MANAGER_HPP
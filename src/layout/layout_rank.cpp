@@ -0,0 +1,168 @@
+#include "layout_rank.hpp"
+
+#include <bit>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace jianhan::v0::layout {
+
+static constexpr auto FACTORIALS = []() -> std::array<Rank, KEY_COUNT + 1> {
+    std::array<Rank, KEY_COUNT + 1> factorials{1};
+    for (uz i = 1; i <= KEY_COUNT; ++i) {
+        factorials[i] = factorials[i - 1] * i;
+    }
+    return factorials;
+}();
+
+/**
+ * @brief Index of the n-th (0-based) set bit of a mask.
+ **/
+static auto selectBit(const uint32_t mask, const uz n) noexcept -> uz {
+#ifdef __BMI2__
+    return std::countr_zero(_pdep_u32(1u << n, mask));
+#else
+    uint32_t m = mask;
+    for (uz i = 0; i < n; ++i) {
+        m &= m - 1; // clear the lowest set bit
+    }
+    return std::countr_zero(m);
+#endif
+}
+
+/**
+ * @brief Rank layouts among all the permutations of the 30 keys.
+ * @note Ranks follow the lexicographic order of Layout::operator<=>.
+ **/
+Ranker::Ranker() {
+    addPart({POSITIONS.begin(), POSITIONS.end()}, {KEY_CODES.begin(), KEY_CODES.end()});
+}
+
+/**
+ * @brief Rank layouts among the ones that can be managed by a manager.
+ * @note Fixed keys take no bits, and each mutable area only takes
+ *       log2(size!) bits, e.g. 74 bits instead of 108 for the
+ *       default configuration.
+ **/
+Ranker::Ranker(const Manager &manager)
+    : fixed_keys_(manager.fixed_keys_) {
+    for (const Area &area : manager.mutable_areas_) {
+        addPart(area.positions_, area.key_codes_);
+    }
+}
+
+auto Ranker::addPart(std::vector<Position> positions, std::vector<KeyValue> key_codes) -> void {
+    assert(positions.size() == key_codes.size());
+    assert(positions.size() <= KEY_COUNT);
+
+    // Positions of an area are shuffled during mutation,
+    // so a canonical order is required.
+    std::ranges::sort(positions);
+    std::ranges::sort(key_codes);
+
+    const uz size = key_codes.size();
+    Part part{std::move(positions), std::move(key_codes), {}, FACTORIALS[size]};
+    for (const auto [i, val] : part.key_codes | std::views::enumerate) {
+        part.index_of[val] = static_cast<u8>(i);
+    }
+    parts_.emplace_back(std::move(part));
+}
+
+/**
+ * @brief Lehmer code of the keys of a part, read in the order of its positions.
+ *        Each digit counts the unused keys smaller than the current one,
+ *        which is a single popcount over a bit mask of unused keys.
+ **/
+auto Ranker::rankPart(const Part &part, const Layout &layout) noexcept -> Rank {
+    const uz size = part.positions.size();
+    uint32_t unused = (1u << size) - 1;
+    Rank rank = 0;
+    for (uz i = 0; i < size; ++i) {
+        const u8 idx = part.index_of[layout.getVal(part.positions[i])];
+        const auto digit = static_cast<uz>(std::popcount(unused & ((1u << idx) - 1)));
+        unused &= ~(1u << idx);
+        rank = rank * (size - i) + digit;
+    }
+    return rank;
+}
+
+auto Ranker::unrankPart(const Part &part, Rank rank, Layout &layout) noexcept -> void {
+    const uz size = part.positions.size();
+
+    // Digits are extracted from the least significant one, and
+    // 128-bit divisions are avoided as soon as the rank fits in 64 bits.
+    std::array<u8, KEY_COUNT> digits{};
+    uz i = size;
+    for (; i > 0 and (rank >> 64) != 0; --i) {
+        const uz radix = size - i + 1;
+        digits[i - 1] = static_cast<u8>(rank % radix);
+        rank /= radix;
+    }
+    for (auto small = static_cast<uint64_t>(rank); i > 0; --i) {
+        const uz radix = size - i + 1;
+        digits[i - 1] = static_cast<u8>(small % radix);
+        small /= radix;
+    }
+
+    uint32_t unused = (1u << size) - 1;
+    for (uz j = 0; j < size; ++j) {
+        const uz idx = selectBit(unused, digits[j]);
+        unused &= ~(1u << idx);
+        layout.setPosValPair(part.key_codes[idx], part.positions[j]);
+    }
+}
+
+/**
+ * @brief Encode a layout as its rank.
+ * @param layout: a valid layout, which should be manageable
+ *                if the ranker is constructed from a manager.
+ **/
+auto Ranker::rank(const Layout &layout) const noexcept -> Rank {
+    Rank rank = 0;
+    for (const Part &part : parts_ | std::views::reverse) {
+        rank = rank * part.radix + rankPart(part, layout);
+    }
+    return rank;
+}
+
+/**
+ * @brief Decode a layout from its rank.
+ * @param rank: ∈ [0, count()).
+ **/
+auto Ranker::unrank(Rank rank) const noexcept -> Layout {
+    assert(rank < count());
+    Layout layout;
+    for (const auto &[val, pos] : fixed_keys_) {
+        layout.setPosValPair(val, pos);
+    }
+    for (const Part &part : parts_) {
+        unrankPart(part, rank % part.radix, layout);
+        rank /= part.radix;
+    }
+    assert(layout.valid());
+    return layout;
+}
+
+/**
+ * @return the number of distinct layouts, i.e. the product of size! of all parts.
+ **/
+auto Ranker::count() const noexcept -> Rank {
+    Rank count = 1;
+    for (const Part &part : parts_) {
+        count *= part.radix;
+    }
+    return count;
+}
+
+/**
+ * @return the number of bits required to store any rank.
+ **/
+auto Ranker::bits() const noexcept -> uz {
+    const Rank max_rank = count() - 1;
+    if (const auto hi = static_cast<uint64_t>(max_rank >> 64); hi != 0) {
+        return 64 + std::bit_width(hi);
+    }
+    return std::bit_width(static_cast<uint64_t>(max_rank));
+}
+
+}
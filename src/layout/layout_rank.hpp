@@ -0,0 +1,44 @@
+#ifndef JIANHAN_LAYOUT_RANK_HPP
+#define JIANHAN_LAYOUT_RANK_HPP
+
+#include "layout_manager.hpp"
+
+namespace jianhan::v0::layout {
+
+// Rank of a layout among all the permutations of its keys,
+// 30! < 2^108, so that any rank fits in 128 bits.
+using Rank = u128;
+
+class Ranker final {
+public:
+    Ranker();
+    explicit Ranker(const Manager &manager);
+
+    [[nodiscard]] auto rank(const Layout &layout) const noexcept -> Rank;
+    [[nodiscard]] auto unrank(Rank rank) const noexcept -> Layout;
+
+    [[nodiscard]] auto bits() const noexcept -> uz;
+    [[nodiscard]] auto count() const noexcept -> Rank;
+
+protected:
+    // Keys of a part are permuted over its positions,
+    // both of which are kept in ascending order.
+    struct Part final {
+        std::vector<Position> positions;
+        std::vector<KeyValue> key_codes;
+        std::array<u8, MAX_KEY_CODE> index_of; // KeyValue -> index in key_codes
+        Rank radix;                            // size!
+    };
+
+    std::vector<Part> parts_{};
+    std::vector<Key> fixed_keys_{};
+
+    auto addPart(std::vector<Position> positions, std::vector<KeyValue> key_codes) -> void;
+
+    [[nodiscard]] static auto rankPart(const Part &part, const Layout &layout) noexcept -> Rank;
+    static auto unrankPart(const Part &part, Rank rank, Layout &layout) noexcept -> void;
+};
+
+}
+
+#endif // JIANHAN_LAYOUT_RANK_HPP
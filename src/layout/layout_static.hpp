@@ -0,0 +1,237 @@
+#ifndef JIANHAN_LAYOUT_STATIC_HPP
+#define JIANHAN_LAYOUT_STATIC_HPP
+
+#include <algorithm>
+#include <utility>
+
+#include "layout_area.hpp"
+
+namespace jianhan::v0::layout {
+
+// A layout configuration known at compile time, the counterpart of a TOML
+// configuration without default area: all the keys are either fixed or
+// listed in an area. Usable as a template argument of StaticManager
+// and of Config::fromStatic().
+template<uz NUM_FIXED, uz... SIZES> struct StaticConfig final {
+    static_assert(sizeof...(SIZES) > 0, "at least one mutable area is required");
+
+    static constexpr uz NUM_AREAS = sizeof...(SIZES);
+    static constexpr uz NUM_MUTABLE_KEYS = (SIZES + ...);
+    static constexpr std::array<uz, NUM_AREAS> AREA_SIZES{SIZES...};
+
+    std::array<Key, NUM_FIXED> fixed_keys;
+    std::array<KeyValue, NUM_MUTABLE_KEYS> vals;      // the areas one after the other
+    std::array<Position, NUM_MUTABLE_KEYS> positions; // in the same order as vals
+
+    // Same rules as Config: legal and unique key values and positions,
+    // areas of at least 2 keys, and all the keys are assigned.
+    template<Geometry G = Geometry30> [[nodiscard]] consteval auto valid() const -> bool {
+        if (NUM_FIXED + NUM_MUTABLE_KEYS != G::KEY_COUNT) { return false; }
+        if (std::ranges::any_of(AREA_SIZES, [](const uz size) { return size < 2; })) {
+            return false;
+        }
+
+        std::array<bool, G::MAX_KEY_CODE> seen_val{};
+        std::array<bool, G::KEY_COUNT> seen_pos{};
+        const auto use = [&](const KeyValue val, const Position pos) -> bool {
+            if (std::ranges::find(G::KEY_CODES, val) == G::KEY_CODES.end() or pos >= G::KEY_COUNT
+                or seen_val[val] or seen_pos[pos]) {
+                return false;
+            }
+            seen_val[val] = seen_pos[pos] = true;
+            return true;
+        };
+        for (const auto &[val, pos] : fixed_keys) {
+            if (not use(val, pos)) { return false; }
+        }
+        for (uz i = 0; i < NUM_MUTABLE_KEYS; ++i) {
+            if (not use(vals[i], positions[i])) { return false; }
+        }
+        return true;
+    }
+};
+
+namespace static_config {
+
+// Same as default_config::TOML, with its default area spelled out:
+// the built-in configuration of Manager, without any parsing.
+inline constexpr StaticConfig<4, 4, 22> DEFAULT{
+    .fixed_keys{{{';', 9}, {',', 27}, {'.', 28}, {'/', 29}}},
+    .vals{
+        'Z', 'X', 'C', 'V',
+        'A', 'B', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L',
+        'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'W', 'Y',
+    },
+    .positions{
+        20, 21, 22, 23,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 11,
+        12, 13, 14, 15, 16, 17, 18, 19, 24, 25, 26,
+    },
+};
+
+}
+
+/**
+ * @brief Manager specialized for a compile-time configuration: the areas
+ *        live in fixed-size arrays, the fixed keys are a precomputed table,
+ *        the loops over the keys of an area have constant trip counts, and
+ *        the area selection compiles away with a single area.
+ * @tparam CONFIG: a valid StaticConfig, e.g. static_config::DEFAULT.
+ * @note Given the same configuration and seed, the layouts and swaps are
+ *       exactly those of Manager (with only the swap operator).
+ **/
+template<auto CONFIG> class StaticManager final {
+    using Spec = decltype(CONFIG);
+    static_assert(CONFIG.valid(), "invalid static layout configuration");
+
+public:
+    StaticManager() = default;
+
+    auto seed(const uint64_t seed) noexcept -> void {
+        prng_.seed(seed);
+    }
+
+    auto create() noexcept -> Layout {
+        Layout layout;
+        layout.key_mappings_ = BASE;
+        assignMutableKeys(layout);
+        assert(layout.valid());
+        return layout;
+    }
+
+    auto reinit(Layout &layout) noexcept -> void {
+        assert(layout.valid() and canManage(layout));
+        assignMutableKeys(layout);
+    }
+
+    auto mutate(Layout &target, const Layout &parent) noexcept -> void {
+        assert(parent.valid() and canManage(parent));
+        target.key_mappings_ = parent.key_mappings_;
+        std::ignore = mutate(target);
+    }
+
+    auto mutate(Layout &layout) noexcept -> Move {
+        assert(layout.valid() and canManage(layout));
+        const uz area = selectArea();
+        const uz beg = OFFSETS[area];
+        const uz size = Spec::AREA_SIZES[area];
+
+        uz &idx = idxs_[area];
+        if (idx + 2 > size) {
+            std::ranges::shuffle(std::span(positions_.data() + beg, size), prng_);
+            idx = 0;
+        }
+        const Position pos1 = positions_[beg + idx++];
+        const Position pos2 = positions_[beg + idx++];
+        layout.swapKeyValues(pos1, pos2);
+
+        Move move{};
+        move.add(pos1, pos2);
+        move.area = static_cast<u8>(area);
+        return move;
+    }
+
+    auto undo(Layout &layout, const Move &move) const noexcept -> void {
+        for (const auto [pos1, pos2] : move.applied() | std::views::reverse) {
+            layout.swapKeyValues(pos1, pos2);
+        }
+    }
+
+    [[nodiscard]] auto canManage(const Layout &layout) const noexcept -> bool {
+        return [&]<uz... I>(std::index_sequence<I...>) -> bool {
+            return (isCompatible<I>(layout) and ...);
+        }(std::make_index_sequence<Spec::NUM_AREAS>{});
+    }
+
+protected:
+    static constexpr uz NUM_AREAS = Spec::NUM_AREAS;
+    static constexpr uz NUM_MUTABLE_KEYS = Spec::NUM_MUTABLE_KEYS;
+
+    // Index of the first key of each area in vals and positions.
+    static constexpr auto OFFSETS = []() -> std::array<uz, NUM_AREAS + 1> {
+        std::array<uz, NUM_AREAS + 1> offsets{};
+        for (uz i = 0; i < NUM_AREAS; ++i) {
+            offsets[i + 1] = offsets[i] + Spec::AREA_SIZES[i];
+        }
+        return offsets;
+    }();
+
+    // Key values sorted within each area, as in Area.
+    static constexpr auto VALS = []() -> std::array<KeyValue, NUM_MUTABLE_KEYS> {
+        auto vals = CONFIG.vals;
+        for (uz i = 0; i < NUM_AREAS; ++i) {
+            std::ranges::sort(vals.begin() + OFFSETS[i], vals.begin() + OFFSETS[i + 1]);
+        }
+        return vals;
+    }();
+
+    // Key mappings of the fixed keys alone.
+    static constexpr auto BASE = []() -> std::array<u8, MAX_KEY_CODE> {
+        std::array<u8, MAX_KEY_CODE> mappings{};
+        for (const auto &[val, pos] : CONFIG.fixed_keys) {
+            mappings[pos] = val, mappings[val] = pos;
+        }
+        return mappings;
+    }();
+
+    // Each area id repeated as many times as the area has keys.
+    static constexpr auto AREA_IDS = []() -> std::array<u8, NUM_MUTABLE_KEYS> {
+        std::array<u8, NUM_MUTABLE_KEYS> ids{};
+        for (uz i = 0; i < NUM_AREAS; ++i) {
+            std::ranges::fill(ids.begin() + OFFSETS[i], ids.begin() + OFFSETS[i + 1], i);
+        }
+        return ids;
+    }();
+
+    Prng prng_{};
+    std::array<Position, NUM_MUTABLE_KEYS> positions_{CONFIG.positions};
+    std::array<u8, NUM_MUTABLE_KEYS> area_ids_{AREA_IDS};
+    std::array<uz, NUM_AREAS> idxs_{Spec::AREA_SIZES}; // reshuffle at first use
+    uz idx_{NUM_MUTABLE_KEYS};
+
+    auto selectArea() noexcept -> uz {
+        if constexpr (NUM_AREAS == 1) {
+            return 0;
+        } else {
+            if (idx_ >= NUM_MUTABLE_KEYS) {
+                std::ranges::shuffle(area_ids_, prng_);
+                idx_ = 0;
+            }
+            return area_ids_[idx_++];
+        }
+    }
+
+    auto assignMutableKeys(Layout &layout) noexcept -> void {
+        [&]<uz... I>(std::index_sequence<I...>) -> void {
+            (assignArea<I>(layout), ...);
+        }(std::make_index_sequence<NUM_AREAS>{});
+    }
+
+    template<uz I> auto assignArea(Layout &layout) noexcept -> void {
+        static constexpr uz BEG = OFFSETS[I];
+        static constexpr uz SIZE = Spec::AREA_SIZES[I];
+
+        const std::span<Position, SIZE> positions(positions_.data() + BEG, SIZE);
+        std::ranges::shuffle(positions, prng_);
+        for (uz i = 0; i < SIZE; ++i) {
+            layout.key_mappings_[positions[i]] = VALS[BEG + i];
+            layout.key_mappings_[VALS[BEG + i]] = positions[i];
+        }
+    }
+
+    template<uz I> [[nodiscard]] auto isCompatible(const Layout &layout) const noexcept -> bool {
+        static constexpr uz BEG = OFFSETS[I];
+        static constexpr uz SIZE = Spec::AREA_SIZES[I];
+
+        std::array<KeyValue, SIZE> observed;
+        for (uz i = 0; i < SIZE; ++i) {
+            observed[i] = layout.getVal(positions_[BEG + i]);
+        }
+        std::ranges::sort(observed);
+        return std::ranges::equal(observed, std::span(VALS.data() + BEG, SIZE));
+    }
+};
+
+}
+
+#endif // JIANHAN_LAYOUT_STATIC_HPP
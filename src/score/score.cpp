@@ -0,0 +1,154 @@
+#include "score.hpp"
+
+#include <bit>
+#include <ranges>
+
+namespace jianhan::v0::score {
+
+/**
+ * @brief The simplest cost model: the Manhattan distance between the
+ *        positions on the 3 * 10 grid, e.g. 1 between neighbouring keys.
+ **/
+auto gridDistanceCosts() noexcept -> CostMatrix {
+    CostMatrix costs{};
+    for (const Position p1 : POSITIONS) {
+        for (const Position p2 : POSITIONS) {
+            const int rows = Util::pos2row(p1) - Util::pos2row(p2);
+            const int cols = Util::pos2col(p1) - Util::pos2col(p2);
+            costs[p1 * KEY_CNT_POW2 + p2] = static_cast<fz>(std::abs(rows) + std::abs(cols));
+        }
+    }
+    return costs;
+}
+
+/**
+ * @brief Construct an evaluator from corpus statistics and a cost model.
+ * @param bigrams: weighted key bigrams observed in the corpus.
+ * @param costs: cost of each ordered pair of positions.
+ * @note Scores are costs: the lower the score, the better the layout.
+ **/
+Evaluator::Evaluator(std::vector<Bigram> bigrams, const CostMatrix &costs)
+    : bigrams_(bigrams.begin(), bigrams.end()), costs_(costs) {
+    validateBigrams(bigrams_);
+    indexIncidentBigrams();
+}
+
+auto Evaluator::indexIncidentBigrams() -> void {
+    incident_offsets_.assign(MAX_KEY_CODE + 1, 0);
+    for (const auto &[first, second, freq] : bigrams_) {
+        ++incident_offsets_[first + 1];
+        if (second != first) { ++incident_offsets_[second + 1]; }
+    }
+    for (uz k = 0; k < MAX_KEY_CODE; ++k) {
+        incident_offsets_[k + 1] += incident_offsets_[k];
+    }
+
+    incident_.resize(incident_offsets_.back());
+    std::vector<uint32_t> next(incident_offsets_.begin(), incident_offsets_.end() - 1);
+    for (uz i = 0; i < bigrams_.size(); ++i) {
+        const auto &[first, second, freq] = bigrams_[i];
+        incident_[next[first]++] = static_cast<uint32_t>(i);
+        if (second != first) { incident_[next[second]++] = static_cast<uint32_t>(i); }
+    }
+}
+
+auto Evaluator::validateBigrams(const std::span<const Bigram> bigrams) -> void {
+    for (const auto &[first, second, freq] : bigrams) {
+        if (not Util::isKeyValueLegal(first) or not Util::isKeyValueLegal(second)) {
+            constexpr std::string_view what = "illegal key values: '{:c}{:c}'";
+            throw IllegalBigram(fmt::format(what, first, second));
+        }
+        if (not (freq >= 0)) { // also rejects NaN
+            constexpr std::string_view what = "negative frequency for '{:c}{:c}'";
+            throw IllegalBigram(fmt::format(what, first, second));
+        }
+    }
+}
+
+/**
+ * @brief Evaluate a layout on the whole corpus.
+ * @param layout: a valid layout.
+ * @return the sum of the weighted costs of all the bigrams.
+ **/
+auto Evaluator::score(const Layout &layout) const noexcept -> fz {
+    f64 total = 0;
+    for (uz i = 0; i < bigrams_.size(); ++i) {
+        total += cost(layout, i);
+    }
+    return static_cast<fz>(total);
+}
+
+/**
+ * @brief Evaluate a layout on a single sample of the corpus.
+ * @param layout: a valid layout.
+ * @param idx: index of the bigram, ∈ [0, size()).
+ * @return the weighted cost of the bigram.
+ **/
+auto Evaluator::cost(const Layout &layout, const uz idx) const noexcept -> fz {
+    assert(idx < bigrams_.size());
+    const auto &[first, second, freq] = bigrams_[idx];
+    const Position pos1 = layout.getPos(first);
+    const Position pos2 = layout.getPos(second);
+    return freq * costs_[pos1 * KEY_CNT_POW2 + pos2];
+}
+
+/**
+ * @brief Score difference made by a move, without rescoring the layout.
+ * @param layout: a valid layout, after the move.
+ * @param move: the move returned by Manager::mutate(layout).
+ * @return score(layout) - score(layout before the move), only the bigrams
+ *         with a moved key are evaluated (each of them once).
+ * @note Equal to the difference of the scores up to rounding.
+ **/
+auto Evaluator::delta(const Layout &layout, const layout::Move &move) const noexcept -> fz {
+    // Positions before the move: undo the swaps on the touched entries only.
+    std::array<KeyValue, KEY_CNT_POW2> val_before;
+    for (const auto [pos1, pos2] : move.applied()) {
+        val_before[pos1] = layout.getVal(pos1);
+        val_before[pos2] = layout.getVal(pos2);
+    }
+    for (const auto [pos1, pos2] : move.applied() | std::views::reverse) {
+        std::swap(val_before[pos1], val_before[pos2]);
+    }
+
+    u128 moved = 0;
+    std::array<Position, MAX_KEY_CODE> pos_before;
+    for (const auto [pos1, pos2] : move.applied()) {
+        for (const Position pos : {pos1, pos2}) {
+            pos_before[val_before[pos]] = pos;
+            moved |= u128{1} << val_before[pos];
+        }
+    }
+    const auto before = [&](const KeyValue key) -> Position {
+        return moved >> key & 1 ? pos_before[key] : layout.getPos(key);
+    };
+
+    f64 total = 0;
+    u128 done = 0;
+    for (u128 keys = moved; keys != 0; keys &= keys - 1) { // the moved keys, in increasing order
+        const auto low = static_cast<uint64_t>(keys);
+        const auto key = static_cast<KeyValue>(
+            low != 0 ? std::countr_zero(low) : 64 + std::countr_zero(static_cast<uint64_t>(keys >> 64))
+        );
+        for (uz j = incident_offsets_[key]; j < incident_offsets_[key + 1]; ++j) {
+            const auto &[first, second, freq] = bigrams_[incident_[j]];
+            const KeyValue other = first == key ? second : first;
+            if (done >> other & 1) { continue; } // counted with the other key
+            const fz after = costs_[layout.getPos(first) * KEY_CNT_POW2 + layout.getPos(second)];
+            const fz prior = costs_[before(first) * KEY_CNT_POW2 + before(second)];
+            total += freq * (after - prior);
+        }
+        done |= u128{1} << key;
+    }
+    return static_cast<fz>(total);
+}
+
+auto Evaluator::size() const noexcept -> uz {
+    return bigrams_.size();
+}
+
+auto Evaluator::samples() const noexcept -> std::span<const Bigram> {
+    return bigrams_;
+}
+
+}
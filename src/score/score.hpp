@@ -0,0 +1,66 @@
+#ifndef JIANHAN_SCORE_HPP
+#define JIANHAN_SCORE_HPP
+
+#include <span>
+
+#include "../common/huge_pages.hpp"
+#include "../layout/layout_area.hpp"
+
+namespace jianhan::v0::score {
+
+// A pair of successive keys observed in the corpus,
+// weighted by its (normalized) frequency.
+struct Bigram final {
+    KeyValue first;
+    KeyValue second;
+    fz freq;
+};
+
+// Cost of typing a key at one position followed by a key at another,
+// stored as a 32 * 32 matrix indexed by (pos1 * KEY_CNT_POW2 + pos2).
+using CostMatrix = std::array<fz, KEY_CNT_POW2 * KEY_CNT_POW2>;
+
+[[nodiscard]] auto gridDistanceCosts() noexcept -> CostMatrix;
+
+class Evaluator final {
+public:
+    Evaluator(std::vector<Bigram> bigrams, const CostMatrix &costs);
+
+    Evaluator() = delete;
+
+    [[nodiscard]] auto score(const Layout &layout) const noexcept -> fz;
+    [[nodiscard]] auto cost(const Layout &layout, uz idx) const noexcept -> fz;
+    [[nodiscard]] auto delta(const Layout &layout, const layout::Move &move) const noexcept -> fz;
+
+    [[nodiscard]] auto size() const noexcept -> uz;
+    [[nodiscard]] auto samples() const noexcept -> std::span<const Bigram>;
+
+protected:
+    // Large corpora (e.g. trigram or syllable tables) get huge pages.
+    std::vector<Bigram, HugePageAllocator<Bigram>> bigrams_;
+    CostMatrix costs_;
+
+    // Bigrams incident to each key value, in compressed rows:
+    // incident_[incident_offsets_[k], incident_offsets_[k + 1]).
+    std::vector<uint32_t> incident_offsets_;
+    std::vector<uint32_t> incident_;
+
+private:
+    auto indexIncidentBigrams() -> void;
+
+    static auto validateBigrams(std::span<const Bigram> bigrams) -> void;
+
+    class IllegalBigram final : public std::invalid_argument {
+    public:
+        IllegalBigram() = delete;
+        explicit IllegalBigram(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid corpus statistics: {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_SCORE_HPP
@@ -0,0 +1,73 @@
+#include "search_anneal.hpp"
+
+#include <cmath>
+
+namespace jianhan::v0::search {
+
+/**
+ * @brief Construct an annealer.
+ * @param evaluator: which should outlive the annealer.
+ * @param options: temperatures both 0, or 0 < end <= start.
+ **/
+Annealer::Annealer(const score::Evaluator &evaluator, const AnnealOptions options)
+    : evaluator_(evaluator), options_(validateOptions(options)),
+      cooling_(options_.start_temperature > 0 and options_.num_steps > 1
+                   ? std::pow(options_.end_temperature / options_.start_temperature,
+                              1.0 / static_cast<f64>(options_.num_steps - 1))
+                   : 1) {}
+
+auto Annealer::validateOptions(const AnnealOptions &options) -> const AnnealOptions & {
+    const f64 t0 = options.start_temperature, t1 = options.end_temperature;
+    if (not (t0 == 0 and t1 == 0) and not (0 < t1 and t1 <= t0 and std::isfinite(t0))) {
+        throw IllegalOptions("temperatures must be both 0 or 0 < end <= start");
+    }
+    return options;
+}
+
+/**
+ * @brief Anneal a new layout of the manager.
+ * @param prng: draws the acceptance tests, the moves come from the manager.
+ * @param stop: set by another thread to stop the run early.
+ * @return the best layout met, with its (full) score.
+ * @note With options.adaptive, adaptive selection is (re)enabled on the
+ *       manager, whose statistics start from scratch.
+ **/
+auto Annealer::run(layout::Manager &manager, Prng &prng, const std::atomic<bool> &stop) const -> AnnealResult {
+    if (options_.adaptive) {
+        manager.enableAdaptiveSelection(*options_.adaptive);
+    }
+    Layout current = manager.create();
+    fz current_score = evaluator_.score(current);
+    AnnealResult result{current, current_score, 0, 0};
+
+    f64 temperature = options_.start_temperature;
+    for (uz step = 0; step < options_.num_steps; ++step) {
+        if (step % CHECK_PERIOD == 0
+            and (stop.load(std::memory_order_relaxed) or std::chrono::steady_clock::now() >= options_.deadline)) {
+            break;
+        }
+        const layout::Move move = manager.mutate(current);
+        const fz delta = evaluator_.delta(current, move);
+        manager.reward(move, -delta); // a no-op without adaptive selection
+        const f64 u = static_cast<f64>(prng() >> 11) * 0x1.0p-53;
+        ++result.moves;
+
+        // With a null temperature, exp(-inf) rejects every uphill move.
+        if (delta <= 0 or u < std::exp(-delta / temperature)) {
+            ++result.accepted;
+            current_score += delta;
+            if (current_score < result.score) {
+                result.best = current;
+                result.score = current_score;
+            }
+        } else {
+            manager.undo(current, move);
+        }
+        temperature *= cooling_;
+    }
+
+    result.score = evaluator_.score(result.best); // without the rounding of the deltas
+    return result;
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef JIANHAN_SEARCH_ANNEAL_HPP
+#define JIANHAN_SEARCH_ANNEAL_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include "../layout/layout_manager.hpp"
+#include "../score/score.hpp"
+
+namespace jianhan::v0::search {
+
+struct AnnealOptions final {
+    uz num_steps;                 // moves per run
+    f64 start_temperature = 0;    // geometric schedule, 0 for hill climbing
+    f64 end_temperature = 0;      // in (0, start_temperature], or 0 with it
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+    std::optional<layout::BanditOptions> adaptive{}; // adaptive selection of the areas and operators
+};
+
+struct AnnealResult final {
+    Layout best;
+    fz score;
+    uz moves;    // each one scored by a delta evaluation
+    uz accepted;
+};
+
+// Simulated annealing from a layout created by the manager: each move
+// is scored by Evaluator::delta() and undone when rejected. With adaptive
+// selection, the manager is rewarded with the gain of every move, so
+// that it draws more moves from the areas and operators that still pay.
+//
+// The run stops after num_steps moves, at the deadline, or when stop is
+// set, the last two being checked every CHECK_PERIOD moves.
+class Annealer final {
+public:
+    Annealer(const score::Evaluator &evaluator, AnnealOptions options);
+
+    Annealer() = delete;
+
+    auto run(layout::Manager &manager, Prng &prng, const std::atomic<bool> &stop) const -> AnnealResult;
+
+    static constexpr uz CHECK_PERIOD = 4096;
+
+protected:
+    const score::Evaluator &evaluator_;
+    const AnnealOptions options_;
+    const f64 cooling_; // temperature factor per move
+
+private:
+    static auto validateOptions(const AnnealOptions &options) -> const AnnealOptions &;
+
+    class IllegalOptions final : public std::invalid_argument {
+    public:
+        IllegalOptions() = delete;
+        explicit IllegalOptions(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid argument in Annealer(): {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_SEARCH_ANNEAL_HPP
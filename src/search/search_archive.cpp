@@ -0,0 +1,93 @@
+#include "search_archive.hpp"
+
+namespace jianhan::v0::search {
+
+/**
+ * @brief Construct an empty archive.
+ * @param capacity: maximum number of elites (K), should be positive.
+ **/
+EliteArchive::EliteArchive(const uz capacity)
+    : capacity_(capacity), snapshot_(std::make_shared<const Elites>()) {
+    assert(capacity > 0);
+    elites_.reserve(capacity + 1);
+}
+
+/**
+ * @brief Elites are ordered by score, then by layout, so that the content
+ *        of the archive does not depend on the order of insertions.
+ **/
+auto EliteArchive::isBetter(const Elite &lhs, const Elite &rhs) noexcept -> bool {
+    if (lhs.score != rhs.score) {
+        return lhs.score < rhs.score;
+    }
+    return lhs.layout < rhs.layout;
+}
+
+/**
+ * @brief Offer a layout to the archive.
+ * @param layout: a valid layout.
+ * @param score: score of the layout, the lower the better.
+ * @return true if the layout enters the archive.
+ * @note - Layouts worse than the current K-th best are rejected without
+ *         taking the lock or writing to any shared cache line.
+ * @note - A layout already in the archive is rejected.
+ **/
+auto EliteArchive::insert(const Layout &layout, const fz score) -> bool {
+    // fast path
+    if (not (score <= threshold_.load(std::memory_order_relaxed)) or score == INF) {
+        return false;
+    }
+
+    Elite elite{layout, score, layout.hash()};
+
+    const std::scoped_lock lock(mutex_);
+    if (elites_.size() == capacity_ and not isBetter(elite, elites_.back())) {
+        return false;
+    }
+    // The layouts are compared as well, so that a hash collision
+    // cannot make the content depend on the order of insertions.
+    if (std::ranges::any_of(elites_, [&elite](const Elite &e) -> bool {
+        return e.hash == elite.hash and e.layout == elite.layout;
+    })) {
+        return false;
+    }
+
+    const auto pos = std::ranges::upper_bound(elites_, elite, isBetter);
+    elites_.emplace(pos, std::move(elite));
+    if (elites_.size() > capacity_) {
+        elites_.pop_back();
+    }
+    if (elites_.size() == capacity_) {
+        threshold_.store(elites_.back().score, std::memory_order_relaxed);
+    }
+
+    // Publish a new immutable snapshot for the readers.
+    snapshot_.store(std::make_shared<const Elites>(elites_), std::memory_order_release);
+    return true;
+}
+
+/**
+ * @return the score a layout should not exceed to enter the archive.
+ **/
+auto EliteArchive::threshold() const noexcept -> fz {
+    return threshold_.load(std::memory_order_relaxed);
+}
+
+/**
+ * @return a consistent copy of the elites, sorted from the best to the worst.
+ * @note Taking a snapshot never blocks the writers, and
+ *       the snapshot is not affected by later insertions.
+ **/
+auto EliteArchive::snapshot() const noexcept -> std::shared_ptr<const Elites> {
+    return snapshot_.load(std::memory_order_acquire);
+}
+
+auto EliteArchive::size() const noexcept -> uz {
+    return snapshot()->size();
+}
+
+auto EliteArchive::capacity() const noexcept -> uz {
+    return capacity_;
+}
+
+}
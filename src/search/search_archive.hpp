@@ -0,0 +1,52 @@
+#ifndef JIANHAN_SEARCH_ARCHIVE_HPP
+#define JIANHAN_SEARCH_ARCHIVE_HPP
+
+#include <atomic>
+#include <mutex>
+
+#include "../layout/layout.hpp"
+
+namespace jianhan::v0::search {
+
+struct Elite final {
+    Layout layout;
+    fz score;
+    uint64_t hash;
+};
+
+// Immutable view of the archive, sorted from the best to the worst.
+using Elites = std::vector<Elite>;
+
+// The top K distinct layouts found by all the worker threads.
+class EliteArchive final {
+public:
+    explicit EliteArchive(uz capacity);
+
+    EliteArchive() = delete;
+
+    auto insert(const Layout &layout, fz score) -> bool;
+
+    [[nodiscard]] auto threshold() const noexcept -> fz;
+    [[nodiscard]] auto snapshot() const noexcept -> std::shared_ptr<const Elites>;
+    [[nodiscard]] auto size() const noexcept -> uz;
+    [[nodiscard]] auto capacity() const noexcept -> uz;
+
+    static constexpr fz INF = std::numeric_limits<fz>::infinity();
+
+protected:
+    // Score of the K-th best elite (or INF while the archive is not full),
+    // on its own cache line: most threads only ever read it.
+    alignas(64) std::atomic<fz> threshold_{INF};
+
+    alignas(64) std::mutex mutex_{};
+    Elites elites_{};
+    const uz capacity_;
+
+    std::atomic<std::shared_ptr<const Elites>> snapshot_;
+
+    [[nodiscard]] static auto isBetter(const Elite &lhs, const Elite &rhs) noexcept -> bool;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_ARCHIVE_HPP
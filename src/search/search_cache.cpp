@@ -0,0 +1,141 @@
+#include "search_cache.hpp"
+
+#include <bit>
+
+#include "../common/huge_pages.hpp"
+
+namespace jianhan::v0::search {
+
+/**
+ * @brief Construct an empty cache.
+ * @param capacity: minimum number of scores to be held,
+ *                  rounded up to a power of 2 number of buckets.
+ **/
+ScoreCache::ScoreCache(const uz capacity)
+    : num_buckets_(std::bit_ceil(std::max<uz>(1, (capacity + WAYS - 1) / WAYS))),
+      buckets_(nullptr, Unmap{num_buckets_ * sizeof(Bucket)}) {
+    // Lookups hit random buckets, huge pages save most of the TLB misses.
+    void *memory = allocateLarge(num_buckets_ * sizeof(Bucket));
+    if (memory == nullptr) { throw std::bad_alloc(); }
+    auto *buckets = static_cast<Bucket *>(memory);
+    std::uninitialized_default_construct_n(buckets, num_buckets_);
+    buckets_.reset(buckets);
+}
+
+auto ScoreCache::Unmap::operator()(Bucket *buckets) const noexcept -> void {
+    deallocateLarge(buckets, size); // buckets are trivially destructible
+}
+
+auto ScoreCache::capacity() const noexcept -> uz {
+    return num_buckets_ * WAYS;
+}
+
+auto ScoreCache::bucketOf(const uint64_t hash) const noexcept -> Bucket & {
+    return buckets_[hash & (num_buckets_ - 1)];
+}
+
+auto ScoreCache::pack(const fz score) noexcept -> uint64_t {
+    return std::bit_cast<uint32_t>(score) | VALID;
+}
+
+auto ScoreCache::unpack(const uint64_t data) noexcept -> fz {
+    return std::bit_cast<fz>(static_cast<uint32_t>(data));
+}
+
+/**
+ * @brief Look up a score by layout hash.
+ * @param hash: hash of the layout, see Layout::hash().
+ * @return the cached score, or std::nullopt on a miss.
+ * @note Only the bucket of the hash is probed, i.e. a single cache line.
+ **/
+auto ScoreCache::find(const uint64_t hash) noexcept -> std::optional<fz> {
+    Bucket &bucket = bucketOf(hash);
+    for (uz way = 0; way < WAYS; ++way) {
+        const Entry &entry = bucket.entries[way];
+        const uint64_t check = entry.check.load(std::memory_order_acquire);
+        const uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (not (data & VALID) or (check ^ data) != hash) {
+            continue;
+        }
+        // Mark as recently used, but avoid writing
+        // to a shared cache line when not necessary.
+        if (const uint64_t bit = 1ull << way;
+            not (bucket.clock.load(std::memory_order_relaxed) & bit)) {
+            bucket.clock.fetch_or(bit, std::memory_order_relaxed);
+        }
+        return unpack(data);
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Cache the score of a layout.
+ * @param hash: hash of the layout, see Layout::hash().
+ * @param score: score of the layout.
+ * @note When the bucket is full, an entry is evicted with the CLOCK
+ *       (second chance) policy.
+ **/
+auto ScoreCache::insert(const uint64_t hash, const fz score) noexcept -> void {
+    Bucket &bucket = bucketOf(hash);
+
+    // Overwrite the same hash if present, or take an empty entry.
+    uz target = WAYS;
+    for (uz way = 0; way < WAYS; ++way) {
+        const Entry &entry = bucket.entries[way];
+        const uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (not (data & VALID)) {
+            target = std::min(target, way);
+        } else if ((entry.check.load(std::memory_order_relaxed) ^ data) == hash) {
+            target = way;
+            break;
+        }
+    }
+    if (target == WAYS) {
+        target = victimOf(bucket);
+    }
+
+    Entry &entry = bucket.entries[target];
+    const uint64_t data = pack(score);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(hash ^ data, std::memory_order_release);
+}
+
+/**
+ * @brief Advance the CLOCK hand of a full bucket, clearing the reference
+ *        bits on its way, until an unreferenced entry is found.
+ * @return index of the entry to be evicted.
+ **/
+auto ScoreCache::victimOf(Bucket &bucket) noexcept -> uz {
+    uint64_t clock = bucket.clock.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t refs = clock & 0xff;
+        uz hand = (clock >> 8) & 0xff;
+        while (refs & (1ull << hand)) {
+            refs &= ~(1ull << hand);
+            hand = (hand + 1) % WAYS;
+        }
+        const uz victim = hand;
+        hand = (hand + 1) % WAYS;
+
+        const uint64_t next = refs | (hand << 8);
+        if (bucket.clock.compare_exchange_weak(clock, next, std::memory_order_relaxed)) {
+            return victim;
+        }
+    }
+}
+
+/**
+ * @brief Remove all the entries.
+ * @note Should not be called while other threads are using the cache.
+ **/
+auto ScoreCache::clear() noexcept -> void {
+    for (uz i = 0; i < num_buckets_; ++i) {
+        for (Entry &entry : buckets_[i].entries) {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+        buckets_[i].clock.store(0, std::memory_order_relaxed);
+    }
+}
+
+}
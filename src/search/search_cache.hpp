@@ -0,0 +1,77 @@
+#ifndef JIANHAN_SEARCH_CACHE_HPP
+#define JIANHAN_SEARCH_CACHE_HPP
+
+#include <atomic>
+#include <optional>
+
+#include "../layout/layout.hpp"
+
+namespace jianhan::v0::search {
+
+// Fixed-capacity, lock-free map from layout hash to score,
+// shared by all the worker threads of a search.
+class ScoreCache final {
+public:
+    explicit ScoreCache(uz capacity);
+
+    ScoreCache() = delete;
+
+    [[nodiscard]] auto find(uint64_t hash) noexcept -> std::optional<fz>;
+    auto insert(uint64_t hash, fz score) noexcept -> void;
+    auto clear() noexcept -> void;
+
+    [[nodiscard]] auto capacity() const noexcept -> uz;
+
+    /**
+     * @brief Look up the score of a layout, computing and caching it on a miss.
+     * @param layout: a valid layout.
+     * @param evaluate: callable as fz(const Layout &).
+     **/
+    template<typename F> auto findOrEvaluate(const Layout &layout, F &&evaluate) -> fz {
+        const uint64_t hash = layout.hash();
+        if (const auto score = find(hash)) {
+            return *score;
+        }
+        const fz score = evaluate(layout);
+        insert(hash, score);
+        return score;
+    }
+
+protected:
+    // Entries are verified with the xor trick: `check` holds hash ^ data,
+    // so a torn read (racing with a writer) is detected as a miss.
+    struct Entry final {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    static constexpr uz WAYS = 3;
+
+    // A bucket fits in a cache line, so that a lookup costs one probe.
+    struct alignas(64) Bucket final {
+        std::array<Entry, WAYS> entries{};
+        // bits [0, WAYS): CLOCK reference bits, bits [8, 16): CLOCK hand
+        std::atomic<uint64_t> clock{0};
+    };
+
+    struct Unmap final {
+        uz size;
+        auto operator()(Bucket *buckets) const noexcept -> void;
+    };
+
+    uz num_buckets_;
+    std::unique_ptr<Bucket[], Unmap> buckets_; // on huge pages when large enough
+
+    [[nodiscard]] auto bucketOf(uint64_t hash) const noexcept -> Bucket &;
+    static auto victimOf(Bucket &bucket) noexcept -> uz;
+
+private:
+    static constexpr uint64_t VALID = 1ull << 63;
+
+    static auto pack(fz score) noexcept -> uint64_t;
+    static auto unpack(uint64_t data) noexcept -> fz;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_CACHE_HPP
@@ -0,0 +1,413 @@
+#include "search_checkpoint.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace jianhan::v0::search {
+
+static_assert(std::endian::native == std::endian::little,
+              "checkpoints are stored in little-endian byte order");
+
+static constexpr std::array<char, 8> MAGIC{'J', 'H', 'C', 'K', 'P', 'T', '\0', '\0'};
+static constexpr uz HEADER_SIZE = 32;
+
+// FNV-1a, enough to detect truncated or corrupted files.
+static auto checksum(const std::span<const std::byte> bytes) noexcept -> uint64_t {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const std::byte byte : bytes) {
+        hash = (hash ^ std::to_integer<uint64_t>(byte)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+class Checkpoint::Writer final {
+public:
+    explicit Writer(std::vector<std::byte> &buffer) : buffer_(buffer) {}
+
+    template<typename T> auto put(const T &value) -> void {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto bytes = std::as_bytes(std::span(&value, 1));
+        buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+    }
+
+    auto putSize(const uz size) -> void {
+        put(static_cast<uint64_t>(size));
+    }
+
+    auto putLayout(const Layout &layout) -> void {
+        for (const char val : layout.toStr()) {
+            put(val);
+        }
+    }
+
+    auto putPositions(const std::vector<Position> &positions) -> void {
+        putSize(positions.size());
+        for (const Position pos : positions) {
+            put(static_cast<uint8_t>(pos));
+        }
+    }
+
+private:
+    std::vector<std::byte> &buffer_;
+};
+
+class Checkpoint::Reader final {
+public:
+    explicit Reader(const std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+    template<typename T> auto get() -> T {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    // Sizes are bounded by the remaining bytes to fail early on corrupted files.
+    auto getSize(const uz min_element_size = 1) -> uz {
+        const auto size = get<uint64_t>();
+        if (size > bytes_.size() / min_element_size) {
+            throw IllegalCheckpoint(fmt::format("size {} out of range", size));
+        }
+        return size;
+    }
+
+    auto getLayout() -> Layout {
+        const auto bytes = take(KEY_COUNT);
+        return Layout(std::string_view(reinterpret_cast<const char *>(bytes.data()), KEY_COUNT));
+    }
+
+    auto getPositions() -> std::vector<Position> {
+        std::vector<Position> positions(getSize());
+        for (Position &pos : positions) {
+            pos = get<uint8_t>();
+        }
+        return positions;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return bytes_.empty();
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+
+    auto take(const uz size) -> std::span<const std::byte> {
+        if (size > bytes_.size()) {
+            throw IllegalCheckpoint("unexpected end of data");
+        }
+        const auto bytes = bytes_.first(size);
+        bytes_ = bytes_.subspan(size);
+        return bytes;
+    }
+};
+
+/**
+ * @brief Serialize a search state (header included) into a buffer.
+ * @param state: the state to save.
+ * @param buffer: output, cleared first; its capacity is reused.
+ **/
+auto Checkpoint::serialize(const SearchState &state, std::vector<std::byte> &buffer) -> void {
+    buffer.clear();
+    buffer.resize(HEADER_SIZE);
+
+    Writer writer(buffer);
+    writer.put(state.iteration);
+    writer.put(state.temperature);
+
+    writer.putSize(state.populations.size());
+    for (const auto &[layouts, scores] : state.populations) {
+        writer.putSize(layouts.size());
+        for (const Layout &layout : layouts) { writer.putLayout(layout); }
+        writer.putSize(scores.size());
+        for (const fz score : scores) { writer.put(score); }
+    }
+
+    writer.putSize(state.elites.size());
+    for (const Elite &elite : state.elites) {
+        writer.putLayout(elite.layout);
+        writer.put(elite.score);
+    }
+
+    writer.putSize(state.managers.size());
+    for (const layout::ManagerState &manager : state.managers) {
+        writer.put(manager.prng);
+        writer.putSize(manager.idx);
+        writer.putSize(manager.area_ids.size());
+        for (const uz id : manager.area_ids) { writer.put(static_cast<uint8_t>(id)); }
+        writer.putSize(manager.area_positions.size());
+        for (uz i = 0; i < manager.area_positions.size(); ++i) {
+            writer.putPositions(manager.area_positions[i]);
+            writer.putSize(manager.area_idxs[i]);
+        }
+    }
+
+    writer.putSize(state.prngs.size());
+    for (const Prng::state_type &prng : state.prngs) { writer.put(prng); }
+
+    // header
+    const auto payload = std::span(buffer).subspan(HEADER_SIZE);
+    const uint32_t version = VERSION, reserved = 0;
+    const uint64_t size = payload.size(), sum = checksum(payload);
+    std::byte *header = buffer.data();
+    std::memcpy(header, MAGIC.data(), MAGIC.size());
+    std::memcpy(header + 8, &version, sizeof(version));
+    std::memcpy(header + 12, &reserved, sizeof(reserved));
+    std::memcpy(header + 16, &size, sizeof(size));
+    std::memcpy(header + 24, &sum, sizeof(sum));
+}
+
+/**
+ * @brief Parse a checkpoint produced by serialize().
+ * @note An exception is thrown if the data is truncated, corrupted
+ *       or written by another version of the format.
+ **/
+auto Checkpoint::deserialize(const std::span<const std::byte> bytes) -> SearchState {
+    Reader header(bytes);
+    if (header.get<std::array<char, 8>>() != MAGIC) {
+        throw IllegalCheckpoint("bad magic number");
+    }
+    if (const auto version = header.get<uint32_t>(); version != VERSION) {
+        throw IllegalCheckpoint(fmt::format("unsupported version {}", version));
+    }
+    header.get<uint32_t>(); // reserved
+    const auto size = header.get<uint64_t>();
+    const auto sum = header.get<uint64_t>();
+    const auto payload = bytes.subspan(HEADER_SIZE);
+    if (payload.size() != size) {
+        throw IllegalCheckpoint(fmt::format("expected {} bytes, got {}", size, payload.size()));
+    }
+    if (checksum(payload) != sum) {
+        throw IllegalCheckpoint("checksum mismatch");
+    }
+
+    SearchState state;
+    Reader reader(payload);
+    state.iteration = reader.get<uint64_t>();
+    state.temperature = reader.get<f64>();
+
+    state.populations.resize(reader.getSize());
+    for (auto &[layouts, scores] : state.populations) {
+        const uz num_layouts = reader.getSize(KEY_COUNT);
+        layouts.reserve(num_layouts);
+        for (uz i = 0; i < num_layouts; ++i) { layouts.emplace_back(reader.getLayout()); }
+        scores.resize(reader.getSize(sizeof(fz)));
+        for (fz &score : scores) { score = reader.get<fz>(); }
+    }
+
+    const uz num_elites = reader.getSize(KEY_COUNT + sizeof(fz));
+    state.elites.reserve(num_elites);
+    for (uz i = 0; i < num_elites; ++i) {
+        Layout layout = reader.getLayout();
+        const auto score = reader.get<fz>();
+        const uint64_t hash = layout.hash();
+        state.elites.push_back({std::move(layout), score, hash});
+    }
+
+    state.managers.resize(reader.getSize());
+    for (layout::ManagerState &manager : state.managers) {
+        manager.prng = reader.get<Prng::state_type>();
+        manager.idx = reader.get<uint64_t>();
+        manager.area_ids.resize(reader.getSize());
+        for (uz &id : manager.area_ids) { id = reader.get<uint8_t>(); }
+        const uz num_areas = reader.getSize();
+        for (uz i = 0; i < num_areas; ++i) {
+            manager.area_positions.emplace_back(reader.getPositions());
+            manager.area_idxs.emplace_back(reader.get<uint64_t>());
+        }
+    }
+
+    state.prngs.resize(reader.getSize(sizeof(Prng::state_type)));
+    for (Prng::state_type &prng : state.prngs) { prng = reader.get<Prng::state_type>(); }
+
+    if (not reader.empty()) {
+        throw IllegalCheckpoint("trailing bytes");
+    }
+    return state;
+}
+
+/**
+ * @brief Write bytes to a file atomically: a temporary file is written
+ *        and synced, then renamed over the target, and the directory synced.
+ * @note The temporary file is removed when it cannot be written or renamed.
+ **/
+auto Checkpoint::write(const std::filesystem::path &path, const std::span<const std::byte> bytes) -> void {
+    const std::filesystem::path tmp_path = path.string() + ".tmp";
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), tmp_path.string());
+    }
+    const auto fail = [&](const int error) -> void {
+        ::unlink(tmp_path.c_str());
+        throw std::system_error(error, std::generic_category(), tmp_path.string());
+    };
+
+    for (uz offset = 0; offset < bytes.size();) {
+        const ssize_t n = ::write(fd, bytes.data() + offset, bytes.size() - offset);
+        if (n < 0 and errno == EINTR) { continue; }
+        if (n < 0) {
+            const int error = errno;
+            ::close(fd);
+            fail(error);
+        }
+        offset += static_cast<uz>(n);
+    }
+    const int sync_error = ::fsync(fd) != 0 ? errno : 0;
+    const int close_error = ::close(fd) != 0 ? errno : 0;
+    if (sync_error != 0 or close_error != 0) {
+        fail(sync_error != 0 ? sync_error : close_error);
+    }
+    std::error_code rename_error;
+    std::filesystem::rename(tmp_path, path, rename_error);
+    if (rename_error) {
+        fail(rename_error.value());
+    }
+
+    // The rename itself is only durable once the directory is synced.
+    const std::filesystem::path dir_path = path.has_parent_path() ? path.parent_path() : ".";
+    const int dir_fd = ::open(dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), dir_path.string());
+    }
+    const int dir_error = ::fsync(dir_fd) != 0 ? errno : 0;
+    ::close(dir_fd);
+    if (dir_error != 0) {
+        throw std::system_error(dir_error, std::generic_category(), dir_path.string());
+    }
+}
+
+auto Checkpoint::save(const std::filesystem::path &path, const SearchState &state) -> void {
+    std::vector<std::byte> buffer;
+    serialize(state, buffer);
+    write(path, buffer);
+}
+
+auto Checkpoint::load(const std::filesystem::path &path) -> SearchState {
+    std::ifstream file(path, std::ios::binary);
+    if (not file) {
+        throw std::system_error(errno, std::generic_category(), path.string());
+    }
+    std::vector<std::byte> bytes(std::filesystem::file_size(path));
+    file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (file.gcount() != static_cast<std::streamsize>(bytes.size())) {
+        throw IllegalCheckpoint(fmt::format("cannot read \"{}\"", path.string()));
+    }
+    return deserialize(bytes);
+}
+
+/**
+ * @brief Start the writer thread.
+ * @param path: checkpoint file, overwritten by every save.
+ **/
+CheckpointWriter::CheckpointWriter(std::filesystem::path path)
+    : path_(std::move(path)),
+      thread_([this](std::stop_token stop_token) -> void { loop(std::move(stop_token)); }) {}
+
+/**
+ * @brief Write the last saved checkpoint, if any, then stop the thread.
+ * @note An error of the last write is lost: call close() to get it.
+ **/
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this]() -> bool { return not has_pending_ and not is_writing_; });
+    }
+    thread_.request_stop();
+}
+
+/**
+ * @brief Queue a checkpoint of the state.
+ * @note - Only the serialization runs on the calling thread.
+ * @note - An error of a previous background write is rethrown here.
+ **/
+auto CheckpointWriter::save(const SearchState &state) -> void {
+    {
+        const std::scoped_lock lock(mutex_);
+        rethrowError();
+        assert(thread_.joinable() and "save() after close()");
+        // The writer thread never touches the pending buffer, and it is
+        // only swapped under the lock, so it can be refilled in place.
+        Checkpoint::serialize(state, pending_);
+        num_superseded_ += has_pending_;
+        has_pending_ = true;
+    }
+    cv_.notify_all();
+}
+
+/**
+ * @brief Block until every queued checkpoint is on disk.
+ **/
+auto CheckpointWriter::flush() -> void {
+    std::unique_lock lock(mutex_);
+    cv_.wait(lock, [this]() -> bool { return not has_pending_ and not is_writing_; });
+    rethrowError();
+}
+
+/**
+ * @brief Write the last saved checkpoint, if any, then stop the thread.
+ * @note - An error of a background write, the last one included, is rethrown here.
+ * @note - No checkpoint can be saved afterwards.
+ **/
+auto CheckpointWriter::close() -> void {
+    {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [this]() -> bool { return not has_pending_ and not is_writing_; });
+    }
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+    const std::scoped_lock lock(mutex_);
+    rethrowError();
+}
+
+auto CheckpointWriter::numWritten() const noexcept -> uz {
+    const std::scoped_lock lock(mutex_);
+    return num_written_;
+}
+
+/**
+ * @return number of checkpoints replaced by a newer one before being written.
+ **/
+auto CheckpointWriter::numSuperseded() const noexcept -> uz {
+    const std::scoped_lock lock(mutex_);
+    return num_superseded_;
+}
+
+auto CheckpointWriter::loop(std::stop_token stop_token) -> void {
+    std::unique_lock lock(mutex_);
+    while (cv_.wait(lock, stop_token, [this]() -> bool { return has_pending_; })) {
+        std::swap(pending_, writing_);
+        has_pending_ = false;
+        is_writing_ = true;
+
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            Checkpoint::write(path_, writing_);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        is_writing_ = false;
+        if (error) {
+            error_ = error;
+        } else {
+            ++num_written_;
+        }
+        cv_.notify_all();
+    }
+}
+
+auto CheckpointWriter::rethrowError() -> void {
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef JIANHAN_SEARCH_CHECKPOINT_HPP
+#define JIANHAN_SEARCH_CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <thread>
+
+#include "search_archive.hpp"
+#include "../layout/layout_manager.hpp"
+
+namespace jianhan::v0::search {
+
+struct Population final {
+    std::vector<Layout> layouts{};
+    std::vector<fz> scores{};
+};
+
+// Complete state of a search, enough to resume it bit-exactly.
+struct SearchState final {
+    uint64_t iteration{0};
+    f64 temperature{0};
+    std::vector<Population> populations{};
+    Elites elites{};
+    std::vector<layout::ManagerState> managers{};
+    std::vector<Prng::state_type> prngs{}; // other generators, e.g. for acceptance
+};
+
+// Compact binary checkpoint (little-endian):
+//
+//   magic "JHCKPT\0\0" | version u32 | reserved u32 | payload size u64 | checksum u64
+//   payload: the fields of SearchState in order, layouts as 30 key values
+//
+// Files are written to a temporary file first, then renamed over
+// the target, so that a preempted write never corrupts a checkpoint.
+class Checkpoint final {
+public:
+    Checkpoint() = delete;
+
+    static auto serialize(const SearchState &state, std::vector<std::byte> &buffer) -> void;
+    [[nodiscard]] static auto deserialize(std::span<const std::byte> bytes) -> SearchState;
+
+    static auto save(const std::filesystem::path &path, const SearchState &state) -> void;
+    [[nodiscard]] static auto load(const std::filesystem::path &path) -> SearchState;
+
+    static auto write(const std::filesystem::path &path, std::span<const std::byte> bytes) -> void;
+
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    class Writer;
+    class Reader;
+
+    class IllegalCheckpoint final : public std::runtime_error {
+    public:
+        IllegalCheckpoint() = delete;
+        explicit IllegalCheckpoint(const std::string_view msg) noexcept
+            : runtime_error(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid checkpoint: {:s}"};
+    };
+};
+
+// Writes checkpoints on a background thread with two buffers: the search
+// only pays for the serialization, and a checkpoint saved while the
+// previous one is still queued replaces it (the latest state wins).
+// Write errors are rethrown by the next save(), flush() or close(); the
+// destructor swallows them, so finish with close() to be sure the last
+// checkpoint reached the disk.
+class CheckpointWriter final {
+public:
+    explicit CheckpointWriter(std::filesystem::path path);
+    ~CheckpointWriter();
+
+    CheckpointWriter() = delete;
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    auto operator=(const CheckpointWriter &) -> CheckpointWriter & = delete;
+
+    auto save(const SearchState &state) -> void;
+    auto flush() -> void;
+    auto close() -> void;
+
+    [[nodiscard]] auto numWritten() const noexcept -> uz;
+    [[nodiscard]] auto numSuperseded() const noexcept -> uz;
+
+protected:
+    const std::filesystem::path path_;
+
+    mutable std::mutex mutex_{};
+    std::condition_variable_any cv_{};
+    std::vector<std::byte> pending_{}; // filled by save()
+    std::vector<std::byte> writing_{}; // owned by the writer thread
+    bool has_pending_{false};
+    bool is_writing_{false};
+    std::exception_ptr error_{};
+
+    uz num_written_{0};
+    uz num_superseded_{0};
+
+    std::jthread thread_; // last: started after everything else is ready
+
+    auto loop(std::stop_token stop_token) -> void;
+    auto rethrowError() -> void;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_CHECKPOINT_HPP
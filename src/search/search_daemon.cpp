@@ -0,0 +1,630 @@
+#include "search_daemon.hpp"
+
+#include <bit>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "search_deterministic.hpp"
+
+namespace jianhan::v0::search {
+
+static_assert(std::endian::native == std::endian::little,
+              "daemon frames are in little-endian byte order");
+
+enum class FrameType : uint8_t {
+    Job = 1,
+    Progress = 2,
+    Result = 3,
+    Error = 4,
+};
+
+static constexpr uz HEADER_SIZE = 5;             // payload size and type
+static constexpr uz MAX_PAYLOAD = uz{1} << 24;   // configurations are small
+static constexpr uint32_t MAX_RESTARTS = 1 << 20;
+static constexpr uz MAX_QUEUED = uz{1} << 26;    // replies to a client that does not read
+static constexpr timeval SEND_TIMEOUT{.tv_sec = 10, .tv_usec = 0};
+
+struct Frame final {
+    FrameType type;
+    std::vector<std::byte> payload;
+};
+
+namespace {
+
+class FrameWriter final {
+public:
+    explicit FrameWriter(const FrameType type) : bytes_(HEADER_SIZE) {
+        bytes_[4] = static_cast<std::byte>(type);
+    }
+
+    template<typename T> auto put(const T &value) -> FrameWriter & {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto bytes = std::as_bytes(std::span(&value, 1));
+        bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+        return *this;
+    }
+
+    auto putBytes(const std::string_view str) -> FrameWriter & {
+        const auto bytes = std::as_bytes(std::span(str));
+        bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+        return *this;
+    }
+
+    // The frame, with its header.
+    auto bytes() -> std::span<const std::byte> {
+        const auto size = static_cast<uint32_t>(bytes_.size() - HEADER_SIZE);
+        std::memcpy(bytes_.data(), &size, sizeof(size));
+        return bytes_;
+    }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+class FrameReader final {
+public:
+    explicit FrameReader(const std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+    template<typename T> auto get() -> T {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    auto getBytes(const uz size) -> std::string_view {
+        const auto bytes = take(size);
+        return {reinterpret_cast<const char *>(bytes.data()), size};
+    }
+
+    auto rest() -> std::string_view {
+        return getBytes(bytes_.size());
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+
+    auto take(const uz size) -> std::span<const std::byte> {
+        if (size > bytes_.size()) {
+            throw std::invalid_argument("malformed daemon frame: unexpected end of data");
+        }
+        const auto bytes = bytes_.first(size);
+        bytes_ = bytes_.subspan(size);
+        return bytes;
+    }
+};
+
+auto sendAll(const int fd, std::span<const std::byte> bytes) noexcept -> bool {
+    while (not bytes.empty()) {
+        const ssize_t sent = ::send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+        if (sent < 0 and errno == EINTR) { continue; }
+        if (sent <= 0) { return false; }
+        bytes = bytes.subspan(static_cast<uz>(sent));
+    }
+    return true;
+}
+
+auto receiveAll(const int fd, std::span<std::byte> bytes) noexcept -> bool {
+    while (not bytes.empty()) {
+        const ssize_t received = ::recv(fd, bytes.data(), bytes.size(), 0);
+        if (received < 0 and errno == EINTR) { continue; }
+        if (received <= 0) { return false; }
+        bytes = bytes.subspan(static_cast<uz>(received));
+    }
+    return true;
+}
+
+// The next frame, nullopt once the peer is gone.
+auto receiveFrame(const int fd) -> std::optional<Frame> {
+    std::array<std::byte, HEADER_SIZE> header{};
+    if (not receiveAll(fd, header)) {
+        return std::nullopt;
+    }
+    uint32_t size;
+    std::memcpy(&size, header.data(), sizeof(size));
+    if (size > MAX_PAYLOAD) {
+        throw std::invalid_argument(fmt::format("malformed daemon frame: payload of {:d} bytes", size));
+    }
+    Frame frame{static_cast<FrameType>(header[4]), std::vector<std::byte>(size)};
+    if (not receiveAll(fd, frame.payload)) {
+        return std::nullopt;
+    }
+    return frame;
+}
+
+auto encodeError(const uint32_t job_id, const std::string_view msg) -> FrameWriter {
+    FrameWriter frame(FrameType::Error);
+    frame.put(job_id).putBytes(msg);
+    return frame;
+}
+
+}
+
+// A client socket with its own writer thread: the workers only queue
+// replies, so a client that stops reading cannot stall the shared pool.
+// It outlives its jobs, so only the thread serving it destroys it.
+struct Daemon::Connection final {
+    const int fd;
+    std::atomic<bool> closed{false}; // also stops the restarts of its jobs
+
+    std::mutex mutex{};
+    std::condition_variable_any cv{};
+    std::deque<std::vector<std::byte>> outbox{};
+    uz queued{0}; // bytes in the outbox
+
+    std::condition_variable jobs_cv{};
+    uz num_jobs{0}; // alive, see Job
+
+    std::jthread writer; // last: started after everything else is ready
+
+    explicit Connection(const int fd)
+        : fd(fd), writer([this](std::stop_token stop_token) -> void { write(std::move(stop_token)); }) {}
+
+    // The queued replies are still sent, a send blocks SEND_TIMEOUT at most.
+    ~Connection() {
+        writer.request_stop();
+        writer.join();
+        ::close(fd);
+    }
+
+    auto send(FrameWriter frame) -> void {
+        {
+            const std::scoped_lock lock(mutex);
+            const auto bytes = frame.bytes();
+            if (closed) { return; }
+            if (queued + bytes.size() > MAX_QUEUED) {
+                close();
+                return;
+            }
+            outbox.emplace_back(bytes.begin(), bytes.end());
+            queued += bytes.size();
+        }
+        cv.notify_one();
+    }
+
+    // Cancel the jobs and wake up the threads blocked on the socket.
+    auto close() noexcept -> void {
+        closed = true;
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    auto waitJobs() -> void {
+        std::unique_lock lock(mutex);
+        jobs_cv.wait(lock, [this]() -> bool { return num_jobs == 0; });
+    }
+
+    auto write(const std::stop_token stop_token) -> void {
+        std::unique_lock lock(mutex);
+        while (cv.wait(lock, stop_token, [this]() -> bool { return not outbox.empty(); })) {
+            const std::vector<std::byte> frame = std::move(outbox.front());
+            outbox.pop_front();
+
+            lock.unlock();
+            const bool sent = sendAll(fd, frame);
+            lock.lock();
+
+            queued -= frame.size();
+            if (not sent) {
+                closed = true;
+                outbox.clear();
+                queued = 0;
+            }
+        }
+    }
+};
+
+// Counted by its connection, which waits for its jobs before it is destroyed.
+struct Daemon::Job final {
+    JobRequest request;
+    Connection &connection;
+    std::shared_ptr<const layout::Config> config;
+    Annealer annealer;
+    EliteArchive elites;
+
+    uint32_t started{0}; // guarded by Daemon::jobs_mutex_
+
+    std::mutex mutex{};
+    uint32_t completed{0};
+    fz best_score{EliteArchive::INF};
+
+    Job(JobRequest request, Connection &connection,
+        std::shared_ptr<const layout::Config> config, Annealer annealer)
+        : request(std::move(request)), connection(connection), config(std::move(config)),
+          annealer(std::move(annealer)), elites(this->request.num_elites) {
+        const std::scoped_lock lock(connection.mutex);
+        ++connection.num_jobs;
+    }
+
+    Job(const Job &) = delete;
+    auto operator=(const Job &) -> Job & = delete;
+
+    ~Job() {
+        const std::scoped_lock lock(connection.mutex);
+        --connection.num_jobs;
+        connection.jobs_cv.notify_all();
+    }
+};
+
+/**
+ * @brief Start serving at options.path, replacing a stale socket there.
+ * @param evaluator: the scoring tables shared by all the jobs.
+ **/
+Daemon::Daemon(std::shared_ptr<const score::Evaluator> evaluator, DaemonOptions options)
+    : evaluator_(std::move(evaluator)), options_(std::move(options)),
+      default_config_(std::make_shared<const layout::Config>(
+          layout::Config::fromStatic<layout::static_config::DEFAULT>()
+      )) {
+    assert(evaluator_ != nullptr);
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options_.path.empty() or options_.path.size() >= sizeof(address.sun_path)) {
+        throw IllegalSocket(options_.path, "empty or too long path");
+    }
+    std::memcpy(address.sun_path, options_.path.data(), options_.path.size());
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw IllegalSocket(options_.path, std::strerror(errno));
+    }
+    ::unlink(options_.path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        or ::listen(listen_fd_, 64) != 0) {
+        const int error = errno;
+        ::close(listen_fd_);
+        throw IllegalSocket(options_.path, std::strerror(error));
+    }
+
+    workers_.reserve(std::max<uz>(1, options_.num_workers));
+    for (uz i = 0; i < std::max<uz>(1, options_.num_workers); ++i) {
+        workers_.emplace_back([this]() -> void { work(); });
+    }
+    acceptor_ = std::jthread([this]() -> void { accept(); });
+}
+
+Daemon::~Daemon() {
+    stop();
+}
+
+/**
+ * @brief Stop accepting connections, cancel the running jobs (their
+ *        clients get no result) and wait for all the threads.
+ **/
+auto Daemon::stop() noexcept -> void {
+    {
+        const std::scoped_lock lock(jobs_mutex_);
+        if (stopping_) { return; }
+        stopping_ = true;
+        jobs_.clear();
+    }
+    jobs_cv_.notify_all();
+
+    ::shutdown(listen_fd_, SHUT_RDWR); // wakes the acceptor up
+    if (acceptor_.joinable()) { acceptor_.join(); }
+
+    {
+        std::jthread last;
+        std::unique_lock lock(connections_mutex_);
+        for (const Client &client : connections_) {
+            client.connection->close();
+        }
+        connections_cv_.wait(lock, [this]() -> bool { return connections_.empty(); });
+        last = std::move(exited_);
+    }
+
+    for (std::jthread &worker : workers_) {
+        if (worker.joinable()) { worker.join(); }
+    }
+    ::close(listen_fd_);
+    ::unlink(options_.path.c_str());
+}
+
+auto Daemon::numCompletedJobs() const noexcept -> uz {
+    return num_completed_jobs_.load();
+}
+
+auto Daemon::numCachedConfigs() const -> uz {
+    const std::scoped_lock lock(cache_mutex_);
+    return configs_.size();
+}
+
+auto Daemon::numConnections() const -> uz {
+    const std::scoped_lock lock(connections_mutex_);
+    return connections_.size();
+}
+
+auto Daemon::accept() -> void {
+    while (true) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0 and errno == EINTR) { continue; }
+        if (fd < 0) { return; } // shut down
+
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &SEND_TIMEOUT, sizeof(SEND_TIMEOUT));
+
+        // The thread cannot release its connection before it is listed.
+        const std::scoped_lock lock(connections_mutex_);
+        auto connection = std::make_shared<Connection>(fd);
+        Client &client = connections_.emplace_back(connection);
+        client.thread = std::jthread([this, connection]() -> void {
+            serve(connection);
+            release(*connection);
+        });
+    }
+}
+
+/**
+ * @brief Forget a connection as soon as its client is served and its
+ *        jobs are gone; its socket is closed when the thread ends.
+ * @note Called last by the thread serving it, which cannot join itself:
+ *       it joins the previous such thread instead, and stop() the last.
+ **/
+auto Daemon::release(const Connection &connection) -> void {
+    std::jthread previous;
+    {
+        const std::scoped_lock lock(connections_mutex_);
+        const auto it = std::ranges::find_if(connections_, [&](const Client &client) -> bool {
+            return client.connection.get() == &connection;
+        });
+        previous = std::exchange(exited_, std::move(it->thread));
+        connections_.erase(it);
+    }
+    connections_cv_.notify_all();
+}
+
+/**
+ * @brief Read the jobs of a client until it leaves, which cancels
+ *        its jobs, or sends a malformed frame.
+ **/
+auto Daemon::serve(const std::shared_ptr<Connection> &connection) -> void {
+    try {
+        while (const auto frame = receiveFrame(connection->fd)) {
+            if (frame->type != FrameType::Job) {
+                throw std::invalid_argument(fmt::format(
+                    "malformed daemon frame: unexpected type {:d}", static_cast<int>(frame->type)
+                ));
+            }
+            FrameReader reader(frame->payload);
+            // The fields of a braced initializer are read in order.
+            submit(*connection, {
+                .job_id = reader.get<uint32_t>(),
+                .seed = reader.get<uint64_t>(),
+                .num_restarts = reader.get<uint32_t>(),
+                .num_steps = reader.get<uint32_t>(),
+                .num_elites = reader.get<uint32_t>(),
+                .start_temperature = reader.get<f64>(),
+                .end_temperature = reader.get<f64>(),
+                .config = std::string(reader.rest()),
+            });
+        }
+    } catch (const std::exception &e) {
+        connection->send(encodeError(0, e.what()));
+    }
+    connection->closed = true; // the queued replies are still sent
+    cancel(*connection);
+    connection->waitJobs(); // their running restarts stop soon
+}
+
+auto Daemon::submit(Connection &connection, JobRequest request) -> void {
+    std::shared_ptr<Job> job;
+    try {
+        if (request.num_restarts == 0 or request.num_restarts > MAX_RESTARTS or request.num_elites == 0) {
+            throw std::invalid_argument(fmt::format(
+                "invalid job: {:d} restarts and {:d} elites", request.num_restarts, request.num_elites
+            ));
+        }
+        auto config = compile(request.config);
+        Annealer annealer(*evaluator_, {
+            .num_steps = request.num_steps,
+            .start_temperature = request.start_temperature,
+            .end_temperature = request.end_temperature,
+        });
+        job = std::make_shared<Job>(std::move(request), connection, std::move(config), std::move(annealer));
+    } catch (const std::exception &e) {
+        connection.send(encodeError(request.job_id, e.what()));
+        return;
+    }
+
+    {
+        const std::scoped_lock lock(jobs_mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobs_cv_.notify_all();
+}
+
+/**
+ * @brief Drop the pending jobs of a connection, without waiting for
+ *        the workers to reach them.
+ **/
+auto Daemon::cancel(const Connection &connection) -> void {
+    std::deque<std::shared_ptr<Job>> cancelled; // destroyed after the lock is released
+    const std::scoped_lock lock(jobs_mutex_);
+    const auto kept = std::ranges::stable_partition(jobs_, [&](const std::shared_ptr<Job> &job) -> bool {
+        return &job->connection != &connection;
+    });
+    std::ranges::move(kept, std::back_inserter(cancelled));
+    jobs_.erase(kept.begin(), kept.end());
+}
+
+auto Daemon::work() -> void {
+    while (true) {
+        std::shared_ptr<Job> job;
+        uz restart;
+        {
+            std::unique_lock lock(jobs_mutex_);
+            jobs_cv_.wait(lock, [this]() -> bool { return stopping_ or not jobs_.empty(); });
+            if (stopping_) { return; }
+            // One restart of the front job, which then waits for its turn again.
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            restart = job->started++;
+            if (job->started < job->request.num_restarts and not job->connection.closed) {
+                jobs_.push_back(job);
+            }
+        }
+        runRestart(*job, restart);
+    }
+}
+
+/**
+ * @brief Run a restart of a job, then report to its client: the progress,
+ *        and the result after the last restart.
+ **/
+auto Daemon::runRestart(Job &job, const uz restart) -> void {
+    Connection &connection = job.connection;
+    if (connection.closed) {
+        return;
+    }
+
+    layout::Manager manager(*job.config);
+    manager.seed(streamSeed(job.request.seed, restart, 0));
+    Prng prng(streamSeed(job.request.seed, restart, 1));
+    const AnnealResult result = job.annealer.run(manager, prng, connection.closed);
+    job.elites.insert(result.best, result.score);
+
+    const std::scoped_lock lock(job.mutex);
+    job.best_score = std::min(job.best_score, result.score);
+    FrameWriter progress(FrameType::Progress);
+    progress.put(job.request.job_id).put(++job.completed).put(job.request.num_restarts).put(job.best_score);
+    connection.send(std::move(progress));
+
+    if (job.completed == job.request.num_restarts) {
+        const auto elites = job.elites.snapshot();
+        FrameWriter frame(FrameType::Result);
+        frame.put(job.request.job_id).put(static_cast<uint32_t>(elites->size()));
+        for (const Elite &elite : *elites) {
+            frame.putBytes(elite.layout.toStr()).put(elite.score);
+        }
+        num_completed_jobs_.fetch_add(1);
+        connection.send(std::move(frame));
+    }
+}
+
+/**
+ * @brief The compiled configuration of a TOML text, from the cache
+ *        when the same text was seen before.
+ **/
+auto Daemon::compile(const std::string &toml) -> std::shared_ptr<const layout::Config> {
+    if (toml.empty()) {
+        return default_config_;
+    }
+    {
+        const std::scoped_lock lock(cache_mutex_);
+        if (const auto it = configs_.find(toml); it != configs_.end()) {
+            return it->second;
+        }
+    }
+
+    auto config = std::make_shared<const layout::Config>(
+        toml::literals::operator""_toml(toml.data(), toml.size())
+    );
+
+    const std::scoped_lock lock(cache_mutex_);
+    if (configs_.emplace(toml, config).second) {
+        config_order_.push_back(toml);
+        if (config_order_.size() > std::max<uz>(1, options_.config_cache_capacity)) {
+            configs_.erase(config_order_.front());
+            config_order_.pop_front();
+        }
+    }
+    return config;
+}
+
+DaemonClient::DaemonClient(const std::string &path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error(fmt::format("daemon socket \"{:s}\": too long path", path));
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 or ::connect(fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        const int error = errno;
+        if (fd_ >= 0) { ::close(fd_); }
+        throw std::runtime_error(fmt::format("daemon socket \"{:s}\": {:s}", path, std::strerror(error)));
+    }
+}
+
+DaemonClient::~DaemonClient() {
+    ::close(fd_);
+}
+
+auto DaemonClient::submit(const JobRequest &request) -> void {
+    FrameWriter frame(FrameType::Job);
+    frame.put(request.job_id).put(request.seed)
+         .put(request.num_restarts).put(request.num_steps).put(request.num_elites)
+         .put(request.start_temperature).put(request.end_temperature)
+         .putBytes(request.config);
+    if (not sendAll(fd_, frame.bytes())) {
+        throw std::runtime_error("daemon connection lost");
+    }
+}
+
+/**
+ * @brief Wait for the next reply of the daemon, to any pending job.
+ * @note A job the daemon rejects gets a result with an error message.
+ **/
+auto DaemonClient::receive() -> JobReply {
+    const auto frame = receiveFrame(fd_);
+    if (not frame) {
+        throw std::runtime_error("daemon connection lost");
+    }
+
+    FrameReader reader(frame->payload);
+    const auto job_id = reader.get<uint32_t>();
+    switch (frame->type) {
+    case FrameType::Progress: {
+        const auto completed = reader.get<uint32_t>();
+        const auto total = reader.get<uint32_t>();
+        const auto best_score = reader.get<fz>();
+        return JobProgress{job_id, completed, total, best_score};
+    }
+    case FrameType::Result: {
+        const auto count = reader.get<uint32_t>();
+        Elites elites;
+        elites.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            const auto layout = Layout::parse(reader.getBytes(KEY_COUNT));
+            if (not layout) {
+                throw std::invalid_argument("malformed daemon frame: illegal layout");
+            }
+            const auto score = reader.get<fz>();
+            elites.push_back({*layout, score, layout->hash()});
+        }
+        return JobResult{job_id, std::move(elites), {}};
+    }
+    case FrameType::Error:
+        return JobResult{job_id, {}, std::string(reader.rest())};
+    default:
+        throw std::invalid_argument(fmt::format(
+            "malformed daemon frame: unexpected type {:d}", static_cast<int>(frame->type)
+        ));
+    }
+}
+
+/**
+ * @brief Submit a job and wait for its result.
+ * @param progress: called with each progress report of the job.
+ * @throw std::runtime_error if the daemon rejects the job.
+ **/
+auto DaemonClient::run(const JobRequest &request,
+                       const std::function<void(const JobProgress &)> &progress) -> JobResult {
+    submit(request);
+    while (true) {
+        JobReply reply = receive();
+        if (const auto *report = std::get_if<JobProgress>(&reply)) {
+            if (report->job_id == request.job_id and progress) {
+                progress(*report);
+            }
+        } else if (auto &result = std::get<JobResult>(reply); result.job_id == request.job_id) {
+            if (not result.error.empty()) {
+                throw std::runtime_error(result.error);
+            }
+            return std::move(result);
+        }
+    }
+}
+
+}
@@ -0,0 +1,168 @@
+#ifndef JIANHAN_SEARCH_DAEMON_HPP
+#define JIANHAN_SEARCH_DAEMON_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+
+#include "search_anneal.hpp"
+#include "search_archive.hpp"
+
+namespace jianhan::v0::search {
+
+// An optimization job: restarts of simulated annealing (see Annealer)
+// under a layout configuration, whose best layouts are merged.
+struct JobRequest final {
+    uint32_t job_id;          // chosen by the client, echoed by the replies
+    uint64_t seed = 42;
+    uint32_t num_restarts = 1;
+    uint32_t num_steps = 100'000;
+    uint32_t num_elites = 10;
+    f64 start_temperature = 0;
+    f64 end_temperature = 0;
+    std::string config{};     // TOML, empty for the built-in configuration
+};
+
+// Sent after each restart of a job.
+struct JobProgress final {
+    uint32_t job_id;
+    uint32_t completed;
+    uint32_t total;
+    fz best_score;
+};
+
+// Sent once per job, after its last restart or on failure.
+struct JobResult final {
+    uint32_t job_id;
+    Elites elites;     // from the best
+    std::string error; // empty on success
+};
+
+using JobReply = std::variant<JobProgress, JobResult>;
+
+struct DaemonOptions final {
+    std::string path;               // of the Unix domain socket
+    uz num_workers = 1;
+    uz config_cache_capacity = 256; // compiled configurations kept warm
+};
+
+// Long-running optimizer serving jobs over a local socket. The scoring
+// tables (an evaluator) are loaded once, configurations are compiled
+// once per distinct TOML text, and the restarts of all the jobs of all
+// the clients share a pool of worker threads: a job only costs its
+// restarts. The workers take a restart of each pending job in turn, so
+// a long job does not hold back the ones submitted after it.
+//
+// Frames are [payload size: u32][type: u8][payload], little-endian:
+//
+//   Job      (1)  job_id u32, seed u64, restarts u32, steps u32, elites u32,
+//                 start temperature f64, end temperature f64, TOML bytes
+//   Progress (2)  job_id u32, completed u32, total u32, best score f32
+//   Result   (3)  job_id u32, count u32, count * (layout string, score f32)
+//   Error    (4)  job_id u32, message bytes
+//
+// A client may pipeline jobs, the replies of different jobs interleave.
+// Closing the connection cancels its jobs; a client that stops reading
+// is dropped once too many replies are queued for it.
+// The restarts of a job are seeded as in DeterministicRun, so its result
+// does not depend on the load of the daemon.
+class Daemon final {
+public:
+    Daemon(std::shared_ptr<const score::Evaluator> evaluator, DaemonOptions options);
+    ~Daemon();
+
+    Daemon() = delete;
+    Daemon(const Daemon &) = delete;
+    auto operator=(const Daemon &) -> Daemon & = delete;
+
+    auto stop() noexcept -> void;
+
+    [[nodiscard]] auto numCompletedJobs() const noexcept -> uz;
+    [[nodiscard]] auto numCachedConfigs() const -> uz;
+    [[nodiscard]] auto numConnections() const -> uz;
+
+protected:
+    struct Connection;
+    struct Job;
+
+    // A connection with the thread reading it.
+    struct Client final {
+        std::shared_ptr<Connection> connection;
+        std::jthread thread{};
+    };
+
+    const std::shared_ptr<const score::Evaluator> evaluator_;
+    const DaemonOptions options_;
+    const std::shared_ptr<const layout::Config> default_config_;
+    int listen_fd_{-1};
+
+    // Compiled configurations by TOML text, the oldest evicted first.
+    mutable std::mutex cache_mutex_{};
+    std::unordered_map<std::string, std::shared_ptr<const layout::Config>> configs_{};
+    std::deque<std::string> config_order_{};
+
+    // Jobs with restarts left to start, the next one is taken from the front.
+    std::mutex jobs_mutex_{};
+    std::condition_variable jobs_cv_{};
+    std::deque<std::shared_ptr<Job>> jobs_{};
+    bool stopping_{false};
+
+    mutable std::mutex connections_mutex_{};
+    std::condition_variable connections_cv_{};
+    std::list<Client> connections_{};
+    std::jthread exited_{}; // the last thread that served a client
+
+    std::atomic<uz> num_completed_jobs_{0};
+
+    std::vector<std::jthread> workers_{};
+    std::jthread acceptor_{};
+
+    auto accept() -> void;
+    auto serve(const std::shared_ptr<Connection> &connection) -> void;
+    auto release(const Connection &connection) -> void;
+    auto submit(Connection &connection, JobRequest request) -> void;
+    auto cancel(const Connection &connection) -> void;
+    auto work() -> void;
+    auto runRestart(Job &job, uz restart) -> void;
+
+    auto compile(const std::string &toml) -> std::shared_ptr<const layout::Config>;
+
+private:
+    class IllegalSocket final : public std::runtime_error {
+    public:
+        IllegalSocket() = delete;
+        IllegalSocket(const std::string_view path, const std::string_view msg) noexcept
+            : runtime_error(fmt::format(WHAT, path, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"daemon socket \"{:s}\": {:s}"};
+    };
+};
+
+// Client side of the daemon protocol, for tools and tests.
+class DaemonClient final {
+public:
+    explicit DaemonClient(const std::string &path);
+    ~DaemonClient();
+
+    DaemonClient() = delete;
+    DaemonClient(const DaemonClient &) = delete;
+    auto operator=(const DaemonClient &) -> DaemonClient & = delete;
+
+    auto submit(const JobRequest &request) -> void;
+    auto receive() -> JobReply;
+
+    auto run(const JobRequest &request,
+             const std::function<void(const JobProgress &)> &progress = {}) -> JobResult;
+
+protected:
+    int fd_{-1};
+};
+
+}
+
+#endif // JIANHAN_SEARCH_DAEMON_HPP
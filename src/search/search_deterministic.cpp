@@ -0,0 +1,89 @@
+#include "search_deterministic.hpp"
+
+namespace jianhan::v0::search {
+
+/**
+ * @brief Derive the seed of a stream from a base seed, an item id and a lane.
+ * @note Each component goes through a SplitMix64 round, so that streams
+ *       of nearby ids (or lanes) are not correlated.
+ **/
+auto streamSeed(const uint64_t seed, const uz item_id, const uz lane) noexcept -> uint64_t {
+    SplitMix64 mixer(seed);
+    const uint64_t a = mixer() ^ static_cast<uint64_t>(item_id);
+    mixer.seed(a);
+    const uint64_t b = mixer() ^ static_cast<uint64_t>(lane);
+    mixer.seed(b);
+    return mixer();
+}
+
+Item::Item(const uz id, const uint64_t seed, const uz num_elites)
+    : id_(id), prng_(seed), elites_(num_elites) {}
+
+auto Item::id() const noexcept -> uz {
+    return id_;
+}
+
+/**
+ * @brief Auxiliary PRNG of the item, e.g. for acceptance tests.
+ **/
+auto Item::prng() noexcept -> Prng & {
+    return prng_;
+}
+
+/**
+ * @brief Offer a layout to the elites of the item.
+ * @return true if the layout enters them.
+ **/
+auto Item::offer(const Layout &layout, const fz score) -> bool {
+    return elites_.insert(layout, score);
+}
+
+DeterministicRun::DeterministicRun(DeterministicOptions options)
+    : options_(std::move(options)) {
+    assert(options_.num_elites > 0);
+}
+
+/**
+ * @brief Run all the items, then merge their elites.
+ * @param scheduler: any number of workers gives the same result. It must
+ *                   have no queued restarts, as the ids of the restarts
+ *                   are the ids of the items.
+ * @param job: called once per item. It must only use the given manager,
+ *             the item's PRNG and a fixed amount of work: time budgets
+ *             and cancellation make the result nondeterministic.
+ * @return the best elites over all the items, sorted from the best.
+ * @note The items skipped by a cancellation of the scheduler are silently
+ *       left out of the merge.
+ **/
+auto DeterministicRun::run(Scheduler &scheduler, const Job &job) -> Elites {
+    if (const uz num_queued = scheduler.numQueued(); num_queued != 0) {
+        throw IllegalScheduler(fmt::format("{:d} restarts already queued", num_queued));
+    }
+    std::vector<std::optional<Item>> items(options_.num_items);
+    for (uz i = 0; i < options_.num_items; ++i) {
+        scheduler.submit({
+            .id = i,
+            .seed = streamSeed(options_.seed, i, 0),
+            .config = options_.config,
+        });
+    }
+
+    // Each item owns its slot, so the workers never write the same memory.
+    scheduler.run([&](Worker &worker, const Restart &restart) -> void {
+        Item &item = items[restart.id].emplace(
+            restart.id, streamSeed(options_.seed, restart.id, 1), options_.num_elites
+        );
+        job(worker.manager(), item);
+    });
+
+    EliteArchive merged(options_.num_elites);
+    for (const auto &item : items) {
+        if (not item) { continue; }
+        for (const Elite &elite : *item->elites_.snapshot()) {
+            merged.insert(elite.layout, elite.score);
+        }
+    }
+    return *merged.snapshot();
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef JIANHAN_SEARCH_DETERMINISTIC_HPP
+#define JIANHAN_SEARCH_DETERMINISTIC_HPP
+
+#include "search_archive.hpp"
+#include "search_scheduler.hpp"
+
+namespace jianhan::v0::search {
+
+// Seed of the PRNG stream of a logical work item (restart, island,
+// replica...), independent of the thread that happens to run it.
+// Several streams (lanes) can be drawn for the same item.
+[[nodiscard]] auto streamSeed(uint64_t seed, uz item_id, uz lane = 0) noexcept -> uint64_t;
+
+struct DeterministicOptions final {
+    uz num_items;
+    uint64_t seed = 42;
+    uz num_elites = 16;
+    std::shared_ptr<const layout::Config> config{}; // nullptr: the default one
+};
+
+// Context of a logical work item: everything random comes from
+// the item's own streams, and elites are kept per item.
+class Item final {
+public:
+    Item(uz id, uint64_t seed, uz num_elites);
+
+    Item() = delete;
+
+    [[nodiscard]] auto id() const noexcept -> uz;
+    [[nodiscard]] auto prng() noexcept -> Prng &;
+
+    auto offer(const Layout &layout, fz score) -> bool;
+
+protected:
+    const uz id_;
+    Prng prng_;
+    EliteArchive elites_;
+
+    friend class DeterministicRun;
+};
+
+// Runs work items on a scheduler so that the result only depends on the
+// seed and the items, not on the number of threads or on the scheduling:
+//
+//   - the manager of item i is seeded with streamSeed(seed, i, 0),
+//     its auxiliary PRNG with streamSeed(seed, i, 1);
+//   - items never read shared state, so their trajectories are fixed;
+//   - the elites of the items are merged in item order at the end.
+//
+// Items share nothing while running, so the throughput is the one of
+// the nondeterministic mode minus the final merge, as compared by
+// "bench search::DeterministicRun".
+class DeterministicRun final {
+public:
+    using Job = std::function<void(layout::Manager &, Item &)>;
+
+    explicit DeterministicRun(DeterministicOptions options);
+
+    DeterministicRun() = delete;
+
+    auto run(Scheduler &scheduler, const Job &job) -> Elites;
+
+protected:
+    DeterministicOptions options_;
+
+private:
+    class IllegalScheduler final : public std::invalid_argument {
+    public:
+        IllegalScheduler() = delete;
+        explicit IllegalScheduler(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid argument in DeterministicRun::run(): {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_SEARCH_DETERMINISTIC_HPP
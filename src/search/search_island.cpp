@@ -0,0 +1,275 @@
+#include "search_island.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jianhan::v0::search {
+
+// The segment only holds plain integers, accessed through std::atomic_ref,
+// which is address-free (hence shared between processes) when lock-free.
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+
+template<typename T> static auto atomic(T &value) noexcept -> std::atomic_ref<T> {
+    return std::atomic_ref<T>(value);
+}
+
+static constexpr uint64_t MAGIC = 0x314E'414C'4948'4A; // "JHILAN1"
+
+struct IslandLink::Header final {
+    uint64_t magic;    // written last by the creator
+    uint64_t num_islands;
+    uint64_t capacity;
+    uint64_t attached; // number of attached links
+};
+
+struct IslandLink::Mailbox final {
+    struct Slot final {
+        uint64_t sequence;
+        uint64_t rank_lo;
+        uint64_t rank_hi;
+        fz score;
+        uint32_t from;
+    };
+
+    alignas(64) uint64_t ready; // set by the owner once initialized
+    alignas(64) uint64_t head;  // written by the owner only
+    alignas(64) uint64_t tail;  // claimed by the senders
+
+    // mask + 1 slots follow in the segment
+    auto slot(const uz i) noexcept -> Slot & {
+        return reinterpret_cast<Slot *>(reinterpret_cast<std::byte *>(this) + sizeof(Mailbox))[i];
+    }
+};
+
+static auto pageSize() noexcept -> uz {
+    return static_cast<uz>(sysconf(_SC_PAGESIZE));
+}
+
+static auto roundUp(const uz size, const uz alignment) noexcept -> uz {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Attach to the segment as an island, creating it if needed.
+ * @param options: must be the same for all the islands.
+ * @param island_id: in [0, num_islands), unique among the processes.
+ **/
+IslandLink::IslandLink(IslandOptions options, const uz island_id)
+    : options_(std::move(options)), island_id_(island_id),
+      mask_(std::bit_ceil(std::max<uz>(2, options_.mailbox_capacity)) - 1),
+      mailbox_size_(roundUp(sizeof(Mailbox) + (mask_ + 1) * sizeof(Mailbox::Slot), pageSize())),
+      segment_size_(pageSize() + options_.num_islands * mailbox_size_) {
+    if (island_id_ >= options_.num_islands) {
+        throw IllegalSegment(options_.name, fmt::format("island id {} out of range", island_id_));
+    }
+    attach();
+
+    // First touch of the own mailbox, from the (pinned) owner process.
+    Mailbox &own = mailbox(island_id_);
+    for (uz i = 0; i <= mask_; ++i) {
+        atomic(own.slot(i).sequence).store(i, std::memory_order_relaxed);
+    }
+    atomic(own.head).store(0, std::memory_order_relaxed);
+    atomic(own.tail).store(0, std::memory_order_relaxed);
+    atomic(own.ready).store(1, std::memory_order_release);
+}
+
+/**
+ * @brief Map the segment, creating it if needed, and count the link.
+ * @note The whole attachment runs under an exclusive flock() of the segment,
+ *       as does the last detachment, which removes it: a link either joins
+ *       a live segment or finds it unlinked (and retries), never both.
+ **/
+auto IslandLink::attach() -> void {
+    const auto deadline = std::chrono::steady_clock::now() + options_.attach_timeout;
+    struct stat st{};
+    while (true) {
+        fd_ = ::shm_open(options_.name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd_ < 0) {
+            throw IllegalSegment(options_.name, std::strerror(errno));
+        }
+        lock(deadline);
+        if (::fstat(fd_, &st) != 0) {
+            fail(std::strerror(errno));
+        }
+        if (st.st_nlink > 0) {
+            break;
+        }
+        // Removed by the last link between shm_open() and flock().
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    const bool is_creator = st.st_size == 0;
+    if (is_creator and ::ftruncate(fd_, static_cast<off_t>(segment_size_)) != 0) {
+        ::shm_unlink(options_.name.c_str());
+        fail(std::strerror(errno));
+    }
+    if (not is_creator and static_cast<uz>(st.st_size) != segment_size_) {
+        fail("size mismatch");
+    }
+
+    void *addr = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        fail(std::strerror(errno));
+    }
+    segment_ = static_cast<std::byte *>(addr);
+
+    // A creator that died before the magic left nothing else behind.
+    Header &h = header();
+    if (atomic(h.magic).load(std::memory_order_acquire) != MAGIC) {
+        h.num_islands = options_.num_islands;
+        h.capacity = mask_ + 1;
+        h.attached = 0;
+        atomic(h.magic).store(MAGIC, std::memory_order_release);
+    } else if (h.num_islands != options_.num_islands or h.capacity != mask_ + 1) {
+        ::munmap(segment_, segment_size_);
+        segment_ = nullptr;
+        fail("options mismatch");
+    }
+    atomic(h.attached).fetch_add(1, std::memory_order_acq_rel);
+    ::flock(fd_, LOCK_UN);
+}
+
+/**
+ * @brief Take the flock() of the segment, polling until the deadline.
+ **/
+auto IslandLink::lock(const std::chrono::steady_clock::time_point deadline) -> void {
+    while (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK and errno != EINTR) {
+            fail(std::strerror(errno));
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            fail("timed out waiting for the segment lock");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+auto IslandLink::fail(const std::string_view msg) -> void {
+    ::close(fd_);
+    fd_ = -1;
+    throw IllegalSegment(options_.name, msg);
+}
+
+/**
+ * @brief Detach from the segment, which is removed by the last island.
+ **/
+IslandLink::~IslandLink() {
+    atomic(mailbox(island_id_).ready).store(0, std::memory_order_release);
+    ::flock(fd_, LOCK_EX); // a link dying while holding it releases it
+    if (atomic(header().attached).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        ::shm_unlink(options_.name.c_str());
+    }
+    ::flock(fd_, LOCK_UN);
+    ::close(fd_);
+    ::munmap(segment_, segment_size_);
+}
+
+/**
+ * @brief Remove a segment left behind by crashed processes.
+ **/
+auto IslandLink::remove(const std::string &name) noexcept -> void {
+    ::shm_unlink(name.c_str());
+}
+
+auto IslandLink::header() const noexcept -> Header & {
+    return *reinterpret_cast<Header *>(segment_);
+}
+
+auto IslandLink::mailbox(const uz island_id) const noexcept -> Mailbox & {
+    return *reinterpret_cast<Mailbox *>(segment_ + pageSize() + island_id * mailbox_size_);
+}
+
+auto IslandLink::islandId() const noexcept -> uz {
+    return island_id_;
+}
+
+auto IslandLink::numIslands() const noexcept -> uz {
+    return options_.num_islands;
+}
+
+/**
+ * @return true if the island is attached and can receive migrants.
+ **/
+auto IslandLink::isReady(const uz island_id) const noexcept -> bool {
+    return atomic(mailbox(island_id).ready).load(std::memory_order_acquire) != 0;
+}
+
+/**
+ * @brief Send a migrant to an island.
+ * @param to: id of the receiving island.
+ * @param layout: a valid layout.
+ * @param score: score of the layout.
+ * @return false if the island is not ready or its mailbox is full,
+ *         in which case the migrant is dropped.
+ **/
+auto IslandLink::send(const uz to, const Layout &layout, const fz score) noexcept -> bool {
+    assert(to < options_.num_islands);
+    if (not isReady(to)) { return false; }
+
+    // Vyukov's bounded queue, as MpmcRing, with the sequence numbers in the segment.
+    Mailbox &box = mailbox(to);
+    uint64_t pos = atomic(box.tail).load(std::memory_order_relaxed);
+    while (true) {
+        Mailbox::Slot &slot = box.slot(pos & mask_);
+        const uint64_t seq = atomic(slot.sequence).load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (atomic(box.tail).compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                const layout::Rank rank = ranker_.rank(layout);
+                slot.rank_lo = static_cast<uint64_t>(rank);
+                slot.rank_hi = static_cast<uint64_t>(rank >> 64);
+                slot.score = score;
+                slot.from = static_cast<uint32_t>(island_id_);
+                atomic(slot.sequence).store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = atomic(box.tail).load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Send a migrant to all the other ready islands.
+ * @return number of islands that received it.
+ **/
+auto IslandLink::broadcast(const Layout &layout, const fz score) noexcept -> uz {
+    uz num_sent = 0;
+    for (uz to = 0; to < options_.num_islands; ++to) {
+        if (to != island_id_) {
+            num_sent += send(to, layout, score);
+        }
+    }
+    return num_sent;
+}
+
+/**
+ * @brief Take the oldest migrant of the own mailbox, if any.
+ **/
+auto IslandLink::receive() -> std::optional<Migrant> {
+    Mailbox &box = mailbox(island_id_);
+    const uint64_t pos = atomic(box.head).load(std::memory_order_relaxed);
+    Mailbox::Slot &slot = box.slot(pos & mask_);
+    if (atomic(slot.sequence).load(std::memory_order_acquire) != pos + 1) {
+        return std::nullopt; // empty, or the sender has not finished writing
+    }
+    const layout::Rank rank = static_cast<layout::Rank>(slot.rank_hi) << 64 | slot.rank_lo;
+    Migrant migrant{ranker_.unrank(rank), slot.score, slot.from};
+
+    atomic(slot.sequence).store(pos + mask_ + 1, std::memory_order_release);
+    atomic(box.head).store(pos + 1, std::memory_order_relaxed);
+    return migrant;
+}
+
+}
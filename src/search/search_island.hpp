@@ -0,0 +1,89 @@
+#ifndef JIANHAN_SEARCH_ISLAND_HPP
+#define JIANHAN_SEARCH_ISLAND_HPP
+
+#include <chrono>
+#include <optional>
+
+#include "../layout/layout_rank.hpp"
+
+namespace jianhan::v0::search {
+
+struct Migrant final {
+    Layout layout;
+    fz score;
+    uz from; // id of the sending island
+};
+
+struct IslandOptions final {
+    std::string name = "/jianhan-islands"; // POSIX shared memory object
+    uz num_islands = 2;
+    uz mailbox_capacity = 256; // migrants per island, rounded up to a power of 2
+    std::chrono::milliseconds attach_timeout{5'000}; // while another link holds the segment lock
+};
+
+// Migration link of an island (an optimizer process, typically one per
+// NUMA node) to the other islands of the same machine, through a POSIX
+// shared memory segment:
+//
+//   | header | mailbox of island 0 | mailbox of island 1 | ...
+//
+// Each mailbox is a lock-free bounded MPSC queue of compact records
+// (the 128-bit rank of the layout, its score and its sender), starting
+// on its own page. A mailbox is initialized by its owner, so that with
+// the first-touch policy its pages live on the owner's node: senders
+// pay for the remote writes, the owner reads locally.
+class IslandLink final {
+public:
+    IslandLink(IslandOptions options, uz island_id);
+    ~IslandLink();
+
+    IslandLink() = delete;
+    IslandLink(const IslandLink &) = delete;
+    auto operator=(const IslandLink &) -> IslandLink & = delete;
+
+    auto send(uz to, const Layout &layout, fz score) noexcept -> bool;
+    auto broadcast(const Layout &layout, fz score) noexcept -> uz;
+    auto receive() -> std::optional<Migrant>;
+
+    [[nodiscard]] auto islandId() const noexcept -> uz;
+    [[nodiscard]] auto numIslands() const noexcept -> uz;
+    [[nodiscard]] auto isReady(uz island_id) const noexcept -> bool;
+
+    static auto remove(const std::string &name) noexcept -> void;
+
+protected:
+    struct Header;
+    struct Mailbox;
+
+    const IslandOptions options_;
+    const uz island_id_;
+    const uz mask_;
+    const uz mailbox_size_; // in bytes, a multiple of the page size
+    const uz segment_size_;
+
+    std::byte *segment_{nullptr};
+    int fd_{-1}; // of the segment, kept open for its flock()
+    layout::Ranker ranker_{};
+
+    [[nodiscard]] auto header() const noexcept -> Header &;
+    [[nodiscard]] auto mailbox(uz island_id) const noexcept -> Mailbox &;
+
+    auto attach() -> void;
+    auto lock(std::chrono::steady_clock::time_point deadline) -> void;
+    [[noreturn]] auto fail(std::string_view msg) -> void;
+
+private:
+    class IllegalSegment final : public std::runtime_error {
+    public:
+        IllegalSegment() = delete;
+        IllegalSegment(const std::string_view name, const std::string_view msg) noexcept
+            : runtime_error(fmt::format(WHAT, name, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid island segment \"{:s}\": {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_SEARCH_ISLAND_HPP
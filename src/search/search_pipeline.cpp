@@ -0,0 +1,205 @@
+#include "search_pipeline.hpp"
+
+#include <thread>
+#include <unistd.h>
+
+namespace jianhan::v0::search {
+
+using Clock = std::chrono::steady_clock;
+
+auto StageStats::operator+=(const StageStats &other) noexcept -> StageStats & {
+    batches += other.batches;
+    layouts += other.layouts;
+    busy += other.busy;
+    waiting += other.waiting;
+    return *this;
+}
+
+auto StageStats::throughput() const noexcept -> f64 {
+    const f64 seconds = std::chrono::duration<f64>(busy).count();
+    return seconds > 0 ? static_cast<f64>(layouts) / seconds : 0;
+}
+
+/**
+ * @brief Number of layouts (with their scores) that fit in a quarter
+ *        of the L2 cache, leaving the rest to the scoring tables.
+ **/
+auto Pipeline::defaultBatchSize() noexcept -> uz {
+    static constexpr uz FALLBACK_L2_SIZE = 256 * 1024;
+    static constexpr uz MIN_BATCH_SIZE = 16;
+
+    const long l2_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    const uz bytes = l2_size > 0 ? static_cast<uz>(l2_size) : FALLBACK_L2_SIZE;
+    return std::max(MIN_BATCH_SIZE, bytes / 4 / (sizeof(Layout) + sizeof(fz)));
+}
+
+auto Pipeline::normalize(PipelineOptions options) noexcept -> PipelineOptions {
+    options.num_generators = std::max<uz>(1, options.num_generators);
+    options.num_evaluators = std::max<uz>(1, options.num_evaluators);
+    if (options.batch_size == 0) {
+        options.batch_size = defaultBatchSize();
+    }
+    if (options.num_batches == 0) {
+        options.num_batches = 4 * (options.num_generators + options.num_evaluators);
+    }
+    return options;
+}
+
+Pipeline::Pipeline(PipelineOptions options)
+    : options_(normalize(std::move(options))),
+      free_(options_.num_batches),
+      generated_(options_.num_batches) {
+    for (uz i = 0; i < options_.num_evaluators; ++i) {
+        evaluated_.emplace_back(std::make_unique<SpscRing<Batch *>>(options_.num_batches));
+    }
+
+    // Allocate all the batches once, they are recycled afterward.
+    layout::Manager manager = options_.config
+                                  ? layout::Manager(*options_.config)
+                                  : layout::Manager();
+    batches_.resize(options_.num_batches);
+    for (Batch &batch : batches_) {
+        batch.layouts.reserve(options_.batch_size);
+        for (uz i = 0; i < options_.batch_size; ++i) {
+            batch.layouts.emplace_back(manager.create());
+        }
+        batch.scores.assign(options_.batch_size, 0);
+    }
+}
+
+auto Pipeline::batchSize() const noexcept -> uz {
+    return options_.batch_size;
+}
+
+/**
+ * @brief Run the pipeline until the selection stage asks to stop.
+ * @param generate: fills the layouts of a batch in place, e.g. with
+ *                  Manager::mutate() or Manager::reinit().
+ * @param evaluate: scores a layout.
+ * @param select: consumes a batch of scored layouts, returns false
+ *                to stop the pipeline.
+ * @return per-stage statistics, summed over the threads of each stage.
+ * @note Batches still in flight when the pipeline stops are dropped.
+ **/
+auto Pipeline::run(const Generate &generate, const Evaluate &evaluate,
+                   const Select &select) -> PipelineStats {
+    // Collect the batches left in the rings by the previous run.
+    while (free_.tryPop()) {}
+    while (generated_.tryPop()) {}
+    for (const auto &ring : evaluated_) {
+        while (ring->tryPop()) {}
+    }
+    for (Batch &batch : batches_) {
+        free_.tryPush(&batch);
+    }
+    stop_.store(false);
+
+    std::vector<StageStats> generate_stats(options_.num_generators);
+    std::vector<StageStats> evaluate_stats(options_.num_evaluators);
+    PipelineStats stats{};
+    {
+        std::vector<std::jthread> threads;
+        for (uz i = 0; i < options_.num_generators; ++i) {
+            threads.emplace_back([&, i]() -> void {
+                generateLoop(i, generate, generate_stats[i]);
+            });
+        }
+        for (uz i = 0; i < options_.num_evaluators; ++i) {
+            threads.emplace_back([&, i]() -> void {
+                evaluateLoop(i, evaluate, evaluate_stats[i]);
+            });
+        }
+        selectLoop(select, stats.select);
+    } // join
+
+    for (const StageStats &s : generate_stats) { stats.generate += s; }
+    for (const StageStats &s : evaluate_stats) { stats.evaluate += s; }
+    return stats;
+}
+
+auto Pipeline::generateLoop(const uz id, const Generate &generate, StageStats &stats) -> void {
+    layout::Manager manager = options_.config
+                                  ? layout::Manager(*options_.config)
+                                  : layout::Manager();
+    manager.seed(options_.seed + id);
+
+    while (not stop_.load(std::memory_order_relaxed)) {
+        const auto t0 = Clock::now();
+        const auto batch = free_.tryPop();
+        if (not batch) {
+            std::this_thread::yield();
+            stats.waiting += Clock::now() - t0;
+            continue;
+        }
+
+        const auto t1 = Clock::now();
+        generate(manager, **batch);
+        const auto t2 = Clock::now();
+
+        while (not generated_.tryPush(*batch)) {
+            if (stop_.load(std::memory_order_relaxed)) { return; }
+            std::this_thread::yield();
+        }
+        stats.waiting += (t1 - t0) + (Clock::now() - t2);
+        stats.busy += t2 - t1;
+        stats.layouts += (*batch)->layouts.size();
+        ++stats.batches;
+    }
+}
+
+auto Pipeline::evaluateLoop(const uz id, const Evaluate &evaluate, StageStats &stats) -> void {
+    SpscRing<Batch *> &output = *evaluated_[id];
+
+    while (not stop_.load(std::memory_order_relaxed)) {
+        const auto t0 = Clock::now();
+        const auto batch = generated_.tryPop();
+        if (not batch) {
+            std::this_thread::yield();
+            stats.waiting += Clock::now() - t0;
+            continue;
+        }
+
+        const auto t1 = Clock::now();
+        Batch &b = **batch;
+        for (uz i = 0; i < b.layouts.size(); ++i) {
+            b.scores[i] = evaluate(b.layouts[i]);
+        }
+        const auto t2 = Clock::now();
+
+        while (not output.tryPush(*batch)) {
+            if (stop_.load(std::memory_order_relaxed)) { return; }
+            std::this_thread::yield();
+        }
+        stats.waiting += (t1 - t0) + (Clock::now() - t2);
+        stats.busy += t2 - t1;
+        stats.layouts += b.layouts.size();
+        ++stats.batches;
+    }
+}
+
+auto Pipeline::selectLoop(const Select &select, StageStats &stats) -> void {
+    for (uz next = 0; ; next = (next + 1) % evaluated_.size()) {
+        const auto t0 = Clock::now();
+        const auto batch = evaluated_[next]->tryPop();
+        if (not batch) {
+            if (next + 1 == evaluated_.size()) { std::this_thread::yield(); }
+            stats.waiting += Clock::now() - t0;
+            continue;
+        }
+
+        const auto t1 = Clock::now();
+        const bool go_on = select(**batch);
+        stats.busy += Clock::now() - t1;
+        stats.waiting += t1 - t0;
+        stats.layouts += (*batch)->layouts.size();
+        ++stats.batches;
+
+        free_.tryPush(*batch);
+        if (not go_on) {
+            stop_.store(true);
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef JIANHAN_SEARCH_PIPELINE_HPP
+#define JIANHAN_SEARCH_PIPELINE_HPP
+
+#include <chrono>
+#include <functional>
+
+#include "../common/ring_buffer.hpp"
+#include "../layout/layout_manager.hpp"
+
+namespace jianhan::v0::search {
+
+struct Batch final {
+    std::vector<Layout> layouts;
+    std::vector<fz> scores;
+};
+
+struct PipelineOptions final {
+    uz num_generators = 1;
+    uz num_evaluators = 1;
+    uz batch_size = 0;  // 0: as many layouts as fit in a quarter of the L2 cache
+    uz num_batches = 0; // 0: 4 batches in flight per thread
+    uint64_t seed = 42; // generator i is seeded with (seed + i)
+    std::shared_ptr<const layout::Config> config{}; // nullptr: the default one
+};
+
+struct StageStats final {
+    uz batches{0};
+    uz layouts{0};
+    std::chrono::nanoseconds busy{0};    // time spent in the callbacks
+    std::chrono::nanoseconds waiting{0}; // time spent waiting on the rings
+
+    auto operator+=(const StageStats &other) noexcept -> StageStats &;
+
+    [[nodiscard]] auto throughput() const noexcept -> f64; // layouts per busy second
+};
+
+struct PipelineStats final {
+    StageStats generate;
+    StageStats evaluate;
+    StageStats select;
+};
+
+// Decouples the mutation of layouts from their evaluation:
+//
+//   generators --(MPMC)--> evaluators --(SPSC each)--> selection
+//        ^                                                 |
+//        +--------------------(MPMC)-----------------------+
+//
+// Batches are allocated once and recycled through the rings,
+// the selection stage runs on the calling thread.
+class Pipeline final {
+public:
+    using Generate = std::function<void(layout::Manager &, Batch &)>;
+    using Evaluate = std::function<fz(const Layout &)>;
+    using Select = std::function<bool(const Batch &)>; // false: stop the pipeline
+
+    explicit Pipeline(PipelineOptions options);
+
+    Pipeline() = delete;
+
+    auto run(const Generate &generate, const Evaluate &evaluate,
+             const Select &select) -> PipelineStats;
+
+    [[nodiscard]] auto batchSize() const noexcept -> uz;
+
+    [[nodiscard]] static auto defaultBatchSize() noexcept -> uz;
+
+protected:
+    PipelineOptions options_;
+    std::vector<Batch> batches_{};
+
+    MpmcRing<Batch *> free_;
+    MpmcRing<Batch *> generated_;
+    std::vector<std::unique_ptr<SpscRing<Batch *>>> evaluated_{};
+
+    std::atomic<bool> stop_{false};
+
+    auto generateLoop(uz id, const Generate &generate, StageStats &stats) -> void;
+    auto evaluateLoop(uz id, const Evaluate &evaluate, StageStats &stats) -> void;
+    auto selectLoop(const Select &select, StageStats &stats) -> void;
+
+private:
+    static auto normalize(PipelineOptions options) noexcept -> PipelineOptions;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_PIPELINE_HPP
@@ -0,0 +1,209 @@
+#include "search_racing.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace jianhan::v0::search {
+
+Racing::Racing(const score::Evaluator &evaluator)
+    : Racing(evaluator, RacingOptions{}, 42) {}
+
+/**
+ * @brief Construct a racing evaluator over the samples of an evaluator.
+ * @param evaluator: full evaluator, which should outlive the racing evaluator.
+ * @param options: schedule of the subsamples and width of the bounds.
+ * @param seed: seed used to draw the samples inside each stratum.
+ **/
+Racing::Racing(const score::Evaluator &evaluator,
+               const RacingOptions options, const uint64_t seed)
+    : evaluator_(evaluator), options_(options) {
+    assert(options_.first_round > 0 and options_.growth > 1);
+    Prng prng(seed);
+    buildSampleOrder(prng);
+}
+
+/**
+ * @brief Samples are stratified by the magnitude of their frequencies,
+ *        each power of 2 (relative to the most frequent one) is a stratum.
+ **/
+auto Racing::stratumOf(const fz freq, const int max_exponent) noexcept -> u8 {
+    if (not (freq > 0)) {
+        return MAX_STRATA - 1;
+    }
+    const int stratum = max_exponent - std::ilogb(freq);
+    return static_cast<u8>(std::clamp(stratum, 0, static_cast<int>(MAX_STRATA - 1)));
+}
+
+auto Racing::buildSampleOrder(Prng &prng) -> void {
+    const auto samples = evaluator_.samples();
+    const uz num_samples = samples.size();
+
+    fz max_freq = 0;
+    for (const score::Bigram &bigram : samples) {
+        max_freq = std::max(max_freq, bigram.freq);
+    }
+    const int max_exponent = max_freq > 0 ? std::ilogb(max_freq) : 0;
+
+    // Split the samples into strata, then shuffle each stratum.
+    std::array<std::vector<uz>, MAX_STRATA> members;
+    for (uz i = 0; i < num_samples; ++i) {
+        members[stratumOf(samples[i].freq, max_exponent)].emplace_back(i);
+    }
+    for (std::vector<uz> &stratum : members) {
+        std::ranges::shuffle(stratum, prng);
+    }
+
+    num_strata_ = MAX_STRATA;
+    stratum_sizes_.assign(num_strata_, 0);
+    for (uz h = 0; h < num_strata_; ++h) {
+        stratum_sizes_[h] = static_cast<f64>(members[h].size());
+    }
+
+    order_.reserve(num_samples);
+    strata_.reserve(num_samples);
+    std::array<uz, MAX_STRATA> taken{};
+    auto take = [&](const uz h) -> void {
+        order_.emplace_back(members[h][taken[h]++]);
+        strata_.emplace_back(static_cast<u8>(h));
+    };
+
+    // Every non-empty stratum is visited twice first, so that
+    // its variance can be estimated from the very first round.
+    for (uz rep = 0; rep < 2; ++rep) {
+        for (uz h = 0; h < num_strata_; ++h) {
+            if (taken[h] < members[h].size()) { take(h); }
+        }
+    }
+
+    // The rest are interleaved in proportion to the size of
+    // each stratum, by always taking from the most lagging one.
+    const auto total = static_cast<f64>(num_samples);
+    while (order_.size() < num_samples) {
+        const auto next = static_cast<f64>(order_.size() + 1);
+        uz lagging = 0;
+        f64 max_deficit = -INF;
+        for (uz h = 0; h < num_strata_; ++h) {
+            if (taken[h] == members[h].size()) { continue; }
+            const f64 deficit = stratum_sizes_[h] * next / total - static_cast<f64>(taken[h]);
+            if (deficit > max_deficit) {
+                max_deficit = deficit;
+                lagging = h;
+            }
+        }
+        take(lagging);
+    }
+}
+
+/**
+ * @brief Race the candidates on growing subsamples of the corpus statistics,
+ *        then fully evaluate the candidates that survive the race.
+ * @param candidates: valid layouts to be evaluated.
+ * @param scores: output, the full score of each surviving candidate,
+ *                or INF if the candidate has been eliminated.
+ * @param incumbent: full score of the best known layout, if any.
+ * @return the number of survivors.
+ * @note A candidate is eliminated once the lower bound of its score is
+ *       greater than the upper bound of the best one (or the incumbent).
+ **/
+auto Racing::run(const std::span<const Layout> candidates,
+                 const std::span<fz> scores, const fz incumbent) -> uz {
+    assert(candidates.size() == scores.size());
+
+    const uz num_candidates = candidates.size();
+    const uz num_samples = order_.size();
+
+    sums_.assign(num_candidates * num_strata_, 0);
+    sq_sums_.assign(num_candidates * num_strata_, 0);
+    counts_.assign(num_strata_, 0);
+    alive_.resize(num_candidates);
+    std::iota(alive_.begin(), alive_.end(), uz{0});
+    samples_used_ = 0;
+
+    // A single candidate can only be beaten by the incumbent.
+    const uz min_alive = incumbent < INF ? 1 : 2;
+
+    uz prefix = 0;
+    uz next = std::min(options_.first_round, num_samples);
+    while (alive_.size() >= min_alive and prefix < num_samples) {
+        accumulate(candidates, prefix, next);
+        prefix = next;
+        eliminate(incumbent);
+
+        const auto grown = static_cast<f64>(prefix) * options_.growth;
+        next = std::min(static_cast<uz>(std::ceil(grown)), num_samples);
+    }
+
+    std::ranges::fill(scores, INF);
+    for (const uz c : alive_) {
+        scores[c] = evaluator_.score(candidates[c]);
+    }
+    samples_used_ += alive_.size() * num_samples;
+    return alive_.size();
+}
+
+auto Racing::accumulate(const std::span<const Layout> candidates,
+                        const uz beg, const uz end) -> void {
+    for (const uz c : alive_) {
+        const Layout &layout = candidates[c];
+        f64 *const sums = &sums_[c * num_strata_];
+        f64 *const sq_sums = &sq_sums_[c * num_strata_];
+        for (uz k = beg; k < end; ++k) {
+            const f64 v = evaluator_.cost(layout, order_[k]);
+            sums[strata_[k]] += v;
+            sq_sums[strata_[k]] += v * v;
+        }
+    }
+    for (uz k = beg; k < end; ++k) {
+        ++counts_[strata_[k]];
+    }
+    samples_used_ += alive_.size() * (end - beg);
+}
+
+/**
+ * @brief Stratified estimate of the full score of a candidate.
+ * @return the estimated score and its standard error.
+ **/
+auto Racing::estimate(const uz candidate) const noexcept -> std::pair<f64, f64> {
+    f64 total = 0, variance = 0;
+    for (uz h = 0; h < num_strata_; ++h) {
+        const uz n = counts_[h];
+        if (n == 0) { continue; }
+
+        const f64 size = stratum_sizes_[h];
+        const f64 sum = sums_[candidate * num_strata_ + h];
+        const f64 sq_sum = sq_sums_[candidate * num_strata_ + h];
+        const f64 mean = sum / static_cast<f64>(n);
+        total += size * mean;
+
+        if (n < 2) { continue; }
+        const f64 sample_var = std::max(0.0, (sq_sum - sum * mean) / static_cast<f64>(n - 1));
+        const f64 fpc = 1.0 - static_cast<f64>(n) / size; // finite population correction
+        variance += size * size * fpc * sample_var / static_cast<f64>(n);
+    }
+    return {total, std::sqrt(variance)};
+}
+
+auto Racing::eliminate(const fz incumbent) -> void {
+    const f64 z = options_.z_score;
+
+    f64 best_upper = incumbent;
+    for (const uz c : alive_) {
+        const auto [mean, std_err] = estimate(c);
+        best_upper = std::min(best_upper, mean + z * std_err);
+    }
+
+    std::erase_if(alive_, [&](const uz c) -> bool {
+        const auto [mean, std_err] = estimate(c);
+        return mean - z * std_err > best_upper;
+    });
+}
+
+/**
+ * @return the number of per-sample evaluations spent by the last run,
+ *         including the full evaluations of the survivors.
+ **/
+auto Racing::samplesUsed() const noexcept -> uz {
+    return samples_used_;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef JIANHAN_SEARCH_RACING_HPP
+#define JIANHAN_SEARCH_RACING_HPP
+
+#include "../score/score.hpp"
+
+namespace jianhan::v0::search {
+
+struct RacingOptions final {
+    uz first_round = 256; // number of samples evaluated in the first round
+    fz growth = 2.0f;     // growth factor of the subsample between rounds
+    fz z_score = 3.0f;    // half-width of the confidence bounds, in std devs
+};
+
+class Racing final {
+public:
+    explicit Racing(const score::Evaluator &evaluator);
+    Racing(const score::Evaluator &evaluator, RacingOptions options, uint64_t seed);
+
+    Racing() = delete;
+
+    auto run(std::span<const Layout> candidates, std::span<fz> scores,
+             fz incumbent = INF) -> uz;
+
+    [[nodiscard]] auto samplesUsed() const noexcept -> uz;
+
+    static constexpr fz INF = std::numeric_limits<fz>::infinity();
+
+protected:
+    const score::Evaluator &evaluator_;
+    const RacingOptions options_;
+
+    // The order in which samples are drawn, so that every prefix
+    // of it is a stratified subsample of the corpus statistics.
+    std::vector<uz> order_{};
+    std::vector<u8> strata_{}; // stratum of each entry of order_
+    std::vector<f64> stratum_sizes_{};
+    uz num_strata_{};
+
+    // Per-candidate, per-stratum sums of costs and squared costs
+    std::vector<f64> sums_{};
+    std::vector<f64> sq_sums_{};
+    std::vector<uz> counts_{};
+    std::vector<uz> alive_{};
+    uz samples_used_{};
+
+    auto buildSampleOrder(Prng &prng) -> void;
+    auto accumulate(std::span<const Layout> candidates, uz beg, uz end) -> void;
+    auto eliminate(fz incumbent) -> void;
+
+    [[nodiscard]] auto estimate(uz candidate) const noexcept -> std::pair<f64, f64>;
+
+private:
+    static constexpr uz MAX_STRATA = 32;
+
+    static auto stratumOf(fz freq, int max_exponent) noexcept -> u8;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_RACING_HPP
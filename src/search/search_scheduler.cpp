@@ -0,0 +1,231 @@
+#include "search_scheduler.hpp"
+
+#include <thread>
+
+namespace jianhan::v0::search {
+
+Worker::Worker(const uz id)
+    : id_(id), arena_(std::make_unique<Arena>()) {}
+
+auto Worker::id() const noexcept -> uz {
+    return id_;
+}
+
+/**
+ * @return index of the worker's NUMA node in the scheduler's topology
+ *         (0 without topology), e.g. to pick a NodeReplicas copy.
+ **/
+auto Worker::node() const noexcept -> uz {
+    return node_;
+}
+
+/**
+ * @return OS id of the worker's NUMA node, e.g. for a NodeAllocator,
+ *         or -1 if memory placement is left to the OS.
+ **/
+auto Worker::nodeId() const noexcept -> int {
+    return node_id_;
+}
+
+/**
+ * @brief Mutation context of the current restart, seeded by the restart.
+ **/
+auto Worker::manager() noexcept -> layout::Manager & {
+    assert(manager_.has_value());
+    return *manager_;
+}
+
+/**
+ * @brief Scoring scratch buffer, which is kept between restarts
+ *        to avoid reallocations.
+ **/
+auto Worker::scratch() noexcept -> std::vector<fz> & {
+    return scratch_;
+}
+
+/**
+ * @brief Arena for the children and batches of the current restart,
+ *        reset (keeping its memory) between restarts.
+ **/
+auto Worker::arena() noexcept -> Arena & {
+    return *arena_;
+}
+
+/**
+ * @return true if the scheduler is cancelled or the time budget
+ *         of the current restart is exhausted.
+ * @note Should be polled by long-running jobs, e.g. once per generation.
+ **/
+auto Worker::stopRequested() const noexcept -> bool {
+    return stop_token_.stop_requested() or Clock::now() >= deadline_;
+}
+
+auto Worker::prepare(const Restart &restart, std::stop_token stop_token) -> void {
+    manager_.reset();
+    if (restart.config) {
+        manager_.emplace(*restart.config);
+    } else {
+        manager_.emplace();
+    }
+    manager_->seed(restart.seed);
+    arena_->reset();
+
+    stop_token_ = std::move(stop_token);
+    const auto now = Clock::now();
+    deadline_ = restart.budget >= Clock::time_point::max() - now
+                    ? Clock::time_point::max()
+                    : now + restart.budget;
+}
+
+/**
+ * @brief Construct a scheduler.
+ * @param num_workers: number of worker threads (including the calling one),
+ *                     e.g. std::thread::hardware_concurrency().
+ **/
+Scheduler::Scheduler(const uz num_workers)
+    : queues_(std::make_unique<Queue[]>(std::max<uz>(1, num_workers))) {
+    workers_.reserve(std::max<uz>(1, num_workers));
+    for (uz i = 0; i < std::max<uz>(1, num_workers); ++i) {
+        workers_.emplace_back(i);
+    }
+}
+
+/**
+ * @brief Construct a scheduler whose workers are pinned to CPUs,
+ *        spread over the NUMA nodes of the topology.
+ * @param num_workers: number of worker threads (including the calling one).
+ * @param topology: e.g. NumaTopology(NumaMode::Local).
+ **/
+Scheduler::Scheduler(const uz num_workers, std::shared_ptr<const NumaTopology> topology)
+    : Scheduler(num_workers) {
+    topology_ = std::move(topology);
+    if (not topology_) { return; }
+    for (Worker &worker : workers_) {
+        worker.node_ = topology_->nodeOf(worker.id_);
+        worker.node_id_ = topology_->nodeId(worker.node_);
+    }
+}
+
+auto Scheduler::numWorkers() const noexcept -> uz {
+    return workers_.size();
+}
+
+/**
+ * @return number of restarts submitted and not yet run.
+ **/
+auto Scheduler::numQueued() const -> uz {
+    uz num_queued = 0;
+    for (uz i = 0; i < workers_.size(); ++i) {
+        const std::scoped_lock lock(queues_[i].mutex);
+        num_queued += queues_[i].restarts.size();
+    }
+    return num_queued;
+}
+
+/**
+ * @brief Queue a restart, restarts are dealt to the workers in turn.
+ * @note Should not be called while the scheduler is running.
+ **/
+auto Scheduler::submit(Restart restart) -> void {
+    Queue &queue = queues_[next_queue_];
+    next_queue_ = (next_queue_ + 1) % workers_.size();
+
+    const std::scoped_lock lock(queue.mutex);
+    queue.restarts.emplace_back(std::move(restart));
+}
+
+/**
+ * @brief Run all the queued restarts, blocking until the last one finishes.
+ * @param job: called once per restart, on the worker that runs it.
+ * @return the numbers of restarts completed, stolen and skipped because
+ *         of cancellation.
+ **/
+auto Scheduler::run(const Job &job) -> SchedulerStats {
+    completed_ = stolen_ = cancelled_ = 0;
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(workers_.size() - 1);
+        for (uz i = 1; i < workers_.size(); ++i) {
+            threads.emplace_back([this, i, &job]() -> void {
+                work(workers_[i], job);
+            });
+        }
+        work(workers_[0], job);
+    } // join
+
+    const std::scoped_lock lock(stop_mutex_);
+    stop_source_ = std::stop_source{};
+    return {completed_.load(), stolen_.load(), cancelled_.load()};
+}
+
+/**
+ * @brief Cancel the current run: running restarts see stopRequested(),
+ *        queued restarts are skipped.
+ * @note Can be called from any thread.
+ **/
+auto Scheduler::cancel() noexcept -> void {
+    const std::scoped_lock lock(stop_mutex_);
+    stop_source_.request_stop();
+}
+
+auto Scheduler::work(Worker &worker, const Job &job) -> void {
+    // Pinned for the whole run, the calling thread gets its affinity back.
+    std::optional<ScopedPin> pin;
+    if (topology_) {
+        pin.emplace(topology_->cpuOf(worker.id_));
+    }
+
+    std::stop_token stop_token;
+    {
+        const std::scoped_lock lock(stop_mutex_);
+        stop_token = stop_source_.get_token();
+    }
+
+    // Restarts never spawn restarts, so a worker can leave
+    // as soon as there is nothing left in any of the queues.
+    while (true) {
+        std::optional<Restart> restart = pop(worker.id_);
+        if (not restart) {
+            restart = steal(worker.id_);
+            if (not restart) { return; }
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (stop_token.stop_requested()) {
+            cancelled_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        worker.prepare(*restart, stop_token);
+        job(worker, *restart);
+        completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+auto Scheduler::pop(const uz queue_id) -> std::optional<Restart> {
+    Queue &queue = queues_[queue_id];
+    const std::scoped_lock lock(queue.mutex);
+    if (queue.restarts.empty()) {
+        return std::nullopt;
+    }
+    Restart restart = std::move(queue.restarts.back());
+    queue.restarts.pop_back();
+    return restart;
+}
+
+auto Scheduler::steal(const uz thief_id) -> std::optional<Restart> {
+    const uz num_queues = workers_.size();
+    for (uz i = 1; i < num_queues; ++i) {
+        Queue &queue = queues_[(thief_id + i) % num_queues];
+        const std::scoped_lock lock(queue.mutex);
+        if (not queue.restarts.empty()) {
+            Restart restart = std::move(queue.restarts.front());
+            queue.restarts.pop_front();
+            return restart;
+        }
+    }
+    return std::nullopt;
+}
+
+}
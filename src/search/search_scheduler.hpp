@@ -0,0 +1,111 @@
+#ifndef JIANHAN_SEARCH_SCHEDULER_HPP
+#define JIANHAN_SEARCH_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+
+#include "../common/arena.hpp"
+#include "../common/numa.hpp"
+#include "../layout/layout_manager.hpp"
+
+namespace jianhan::v0::search {
+
+using Clock = std::chrono::steady_clock;
+
+// An independent optimization run.
+struct Restart final {
+    uz id;
+    uint64_t seed;
+    std::shared_ptr<const layout::Config> config{}; // nullptr: the default one
+    Clock::duration budget{Clock::duration::max()};
+};
+
+class Scheduler;
+
+// Execution context of a restart, owned by a worker thread.
+class Worker final {
+public:
+    explicit Worker(uz id);
+
+    Worker() = delete;
+
+    [[nodiscard]] auto id() const noexcept -> uz;
+    [[nodiscard]] auto node() const noexcept -> uz;
+    [[nodiscard]] auto nodeId() const noexcept -> int;
+    [[nodiscard]] auto manager() noexcept -> layout::Manager &;
+    [[nodiscard]] auto scratch() noexcept -> std::vector<fz> &;
+    [[nodiscard]] auto arena() noexcept -> Arena &;
+    [[nodiscard]] auto stopRequested() const noexcept -> bool;
+
+protected:
+    const uz id_;
+    uz node_{0};
+    int node_id_{-1};
+    std::optional<layout::Manager> manager_{};
+    std::vector<fz> scratch_{};
+    std::unique_ptr<Arena> arena_;
+
+    std::stop_token stop_token_{};
+    Clock::time_point deadline_{};
+
+    auto prepare(const Restart &restart, std::stop_token stop_token) -> void;
+
+    friend class Scheduler;
+};
+
+struct SchedulerStats final {
+    uz completed;
+    uz stolen;
+    uz cancelled;
+};
+
+// Runs restarts on a fixed set of workers, each owning a deque of
+// restarts. Workers pop their own restarts from the back and steal
+// from the front of the others' deques when running out of work.
+class Scheduler final {
+public:
+    using Job = std::function<void(Worker &, const Restart &)>;
+
+    explicit Scheduler(uz num_workers);
+    Scheduler(uz num_workers, std::shared_ptr<const NumaTopology> topology);
+
+    Scheduler() = delete;
+
+    auto submit(Restart restart) -> void;
+    auto run(const Job &job) -> SchedulerStats;
+    auto cancel() noexcept -> void;
+
+    [[nodiscard]] auto numWorkers() const noexcept -> uz;
+    [[nodiscard]] auto numQueued() const -> uz;
+
+protected:
+    struct alignas(64) Queue final {
+        mutable std::mutex mutex;
+        std::deque<Restart> restarts;
+    };
+
+    std::vector<Worker> workers_{};
+    std::unique_ptr<Queue[]> queues_;
+    std::shared_ptr<const NumaTopology> topology_{}; // nullptr: no pinning
+    uz next_queue_{0};
+
+    std::mutex stop_mutex_{};
+    std::stop_source stop_source_{};
+
+    std::atomic<uz> completed_{0};
+    std::atomic<uz> stolen_{0};
+    std::atomic<uz> cancelled_{0};
+
+    auto work(Worker &worker, const Job &job) -> void;
+    auto pop(uz queue_id) -> std::optional<Restart>;
+    auto steal(uz thief_id) -> std::optional<Restart>;
+};
+
+}
+
+#endif // JIANHAN_SEARCH_SCHEDULER_HPP
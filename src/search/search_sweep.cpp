@@ -0,0 +1,122 @@
+#include "search_sweep.hpp"
+
+#include "search_deterministic.hpp"
+
+namespace jianhan::v0::search {
+
+/**
+ * @brief Construct an empty sweep.
+ * @param evaluator: shared by all the configurations, it should outlive the sweep.
+ **/
+Sweep::Sweep(const score::Evaluator &evaluator, SweepOptions options)
+    : options_(validateOptions(options)), annealer_(evaluator, options_.anneal) {}
+
+auto Sweep::validateOptions(const SweepOptions &options) -> const SweepOptions & {
+    if (options.num_restarts == 0 or options.num_elites == 0) {
+        throw IllegalOptions("num_restarts and num_elites must be positive");
+    }
+    return options;
+}
+
+/**
+ * @brief Add a configuration, compiled once here.
+ * @param name: its name in the table, e.g. the path of its file.
+ * @param config: e.g. a variation of conf/layouts.toml.
+ **/
+auto Sweep::add(std::string name, const layout::toml_t &config) -> void {
+    add(std::move(name), std::make_shared<const layout::Config>(config));
+}
+
+/**
+ * @brief Add a compiled configuration, nullptr for the built-in default
+ *        one (never the global configuration of Manager).
+ **/
+auto Sweep::add(std::string name, std::shared_ptr<const layout::Config> config) -> void {
+    if (config == nullptr) {
+        config = std::make_shared<const layout::Config>(
+            layout::Config::fromStatic<layout::static_config::DEFAULT>()
+        );
+    }
+    variants_.push_back({std::move(name), std::move(config)});
+}
+
+auto Sweep::size() const noexcept -> uz {
+    return variants_.size();
+}
+
+/**
+ * @brief Run the restarts of all the configurations.
+ * @param scheduler: any number of workers gives the same table, unless
+ *                   the annealing options have a deadline. It must have
+ *                   no queued restarts, the ids of the restarts index
+ *                   the results.
+ * @return one row per configuration, in the order they were added.
+ * @note The restarts skipped by a cancellation of the scheduler are
+ *       silently left out of the rows, see SweepRow::restarts.
+ **/
+auto Sweep::run(Scheduler &scheduler) -> std::vector<SweepRow> {
+    if (const uz num_queued = scheduler.numQueued(); num_queued != 0) {
+        throw IllegalScheduler(fmt::format("{:d} restarts already queued", num_queued));
+    }
+    const uz num_restarts = options_.num_restarts;
+    for (uz v = 0; v < variants_.size(); ++v) {
+        for (uz r = 0; r < num_restarts; ++r) {
+            scheduler.submit({
+                .id = v * num_restarts + r,
+                .seed = streamSeed(options_.seed, r, 0),
+                .config = variants_[v].config,
+            });
+        }
+    }
+
+    // Each restart owns its slot, so the workers never write the same memory.
+    std::vector<std::optional<AnnealResult>> results(variants_.size() * num_restarts);
+    const std::atomic<bool> stop{false};
+    scheduler.run([&](Worker &worker, const Restart &restart) -> void {
+        Prng prng(streamSeed(options_.seed, restart.id % num_restarts, 1));
+        results[restart.id] = annealer_.run(worker.manager(), prng, stop);
+    });
+
+    std::vector<SweepRow> rows;
+    rows.reserve(variants_.size());
+    for (uz v = 0; v < variants_.size(); ++v) {
+        EliteArchive elites(options_.num_elites);
+        SweepRow row{variants_[v].name, {}, EliteArchive::INF, 0, -EliteArchive::INF, 0, 0};
+        f64 sum = 0;
+        for (uz r = 0; r < num_restarts; ++r) {
+            const auto &result = results[v * num_restarts + r];
+            if (not result) { continue; }
+            elites.insert(result->best, result->score);
+            row.best_score = std::min(row.best_score, result->score);
+            row.worst_score = std::max(row.worst_score, result->score);
+            sum += result->score;
+            ++row.restarts;
+        }
+        row.elites = *elites.snapshot();
+        row.mean_score = row.restarts > 0 ? static_cast<fz>(sum / static_cast<f64>(row.restarts)) : EliteArchive::INF;
+        row.delta = row.best_score - (rows.empty() ? row.best_score : rows.front().best_score);
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+/**
+ * @brief Format rows as a plain text table, with the best layout of each.
+ **/
+auto Sweep::table(const std::span<const SweepRow> rows) -> std::string {
+    uz width = std::string_view("configuration").size();
+    for (const SweepRow &row : rows) {
+        width = std::max(width, row.name.size());
+    }
+
+    std::string out = fmt::format("{:<{}s}  {:>12s}  {:>12s}  {:>12s}  {:>12s}  {:>8s}  {:s}\n",
+                                  "configuration", width, "best", "delta", "mean", "worst", "restarts", "layout");
+    for (const SweepRow &row : rows) {
+        out += fmt::format("{:<{}s}  {:>12.6f}  {:>+12.6f}  {:>12.6f}  {:>12.6f}  {:>8d}  {:s}\n",
+                           row.name, width, row.best_score, row.delta, row.mean_score, row.worst_score,
+                           row.restarts, row.elites.empty() ? std::string("-") : row.elites.front().layout.toStr());
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef JIANHAN_SEARCH_SWEEP_HPP
+#define JIANHAN_SEARCH_SWEEP_HPP
+
+#include "search_anneal.hpp"
+#include "search_archive.hpp"
+#include "search_scheduler.hpp"
+
+namespace jianhan::v0::search {
+
+struct SweepOptions final {
+    uz num_restarts = 4;  // per configuration
+    uint64_t seed = 42;
+    uz num_elites = 1;    // per configuration
+    AnnealOptions anneal{.num_steps = 100'000};
+};
+
+// A line of the comparison, scores over the restarts of a configuration.
+struct SweepRow final {
+    std::string name;
+    Elites elites;       // from the best
+    fz best_score;
+    fz mean_score;
+    fz worst_score;
+    fz delta;            // best score minus the one of the first configuration
+    uz restarts;         // completed ones
+};
+
+// Optimizes a set of configuration variants (e.g. "fix a key here",
+// "allow an area there") with the same evaluator in a single run.
+// Each configuration is compiled once when added, then the restarts of
+// all of them share the scheduler's workers; managers are built from
+// their own configuration, never from the global one of Manager.
+//
+// Restart r of every configuration draws from the same streams, derived
+// from the seed as in DeterministicRun, so differences between rows come
+// from the configurations rather than from luck, and the table does not
+// depend on the number of workers.
+class Sweep final {
+public:
+    Sweep(const score::Evaluator &evaluator, SweepOptions options);
+
+    Sweep() = delete;
+
+    auto add(std::string name, const layout::toml_t &config) -> void;
+    auto add(std::string name, std::shared_ptr<const layout::Config> config) -> void;
+
+    auto run(Scheduler &scheduler) -> std::vector<SweepRow>;
+
+    [[nodiscard]] auto size() const noexcept -> uz;
+
+    [[nodiscard]] static auto table(std::span<const SweepRow> rows) -> std::string;
+
+protected:
+    struct Variant final {
+        std::string name;
+        std::shared_ptr<const layout::Config> config;
+    };
+
+    const SweepOptions options_;
+    const Annealer annealer_;
+    std::vector<Variant> variants_{};
+
+private:
+    static auto validateOptions(const SweepOptions &options) -> const SweepOptions &;
+
+    class IllegalOptions final : public std::invalid_argument {
+    public:
+        IllegalOptions() = delete;
+        explicit IllegalOptions(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid argument in Sweep(): {:s}"};
+    };
+
+    class IllegalScheduler final : public std::invalid_argument {
+    public:
+        IllegalScheduler() = delete;
+        explicit IllegalScheduler(const std::string_view msg) noexcept
+            : invalid_argument(fmt::format(WHAT, msg)) {}
+
+    private:
+        static constexpr auto WHAT{"invalid argument in Sweep::run(): {:s}"};
+    };
+};
+
+}
+
+#endif // JIANHAN_SEARCH_SWEEP_HPP
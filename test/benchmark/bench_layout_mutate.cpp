@@ -1,21 +1,26 @@
+#include <barrier>
 #include <omp.h>
 #include <thread>
 
 #include <nanobench.h>
 #include <doctest/doctest.h>
 
+#include "../../src/common/numa.hpp"
+#include "../../src/common/arena.hpp"
 #include "../../src/layout/layout_manager.hpp"
+#include "../../src/layout/layout_static.hpp"
 
 static constexpr size_t NUM_LAYOUTS = 1000;
 static constexpr size_t MAX_THREADS = 4;
+static constexpr size_t NUMA_SLICE = 4096; // layouts mutated per thread and epoch
 
 namespace jianhan::v0::layout::bench::mutate {
 
 TEST_SUITE("Bench layout::Manager::mutate()") {
 
-using Layouts = std::vector<std::unique_ptr<Layout>>;
+using Layouts = std::span<Layout>;
 
-auto checkRandomness(Layouts &l) -> void {
+auto checkRandomness(Layouts l) -> void {
     std::ranges::sort(l);
     uz num_duplicates = 0;
     for (uz i = 0; i < l.size() - 1; ++i) {
@@ -26,24 +31,65 @@ auto checkRandomness(Layouts &l) -> void {
     CHECK_LT(num_duplicates, 5);
 }
 
-auto createLayouts(Manager &manager) -> Layouts {
-    Layouts layouts;
-    for (uz i = 0; i < NUM_LAYOUTS * 2; ++i) {
-        const Layout lyt(manager.create());
-        layouts.emplace_back(std::make_unique<Layout>(lyt));
+auto createLayouts(Manager &manager, Arena &arena) -> Layouts {
+    Layouts layouts = arena.array(NUM_LAYOUTS * 2, manager.create());
+    for (Layout &layout : layouts) {
+        layout = manager.create();
     }
     return layouts;
 }
 
 auto baseline(ankerl::nanobench::Bench *const bench) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         "baseline (1)",
         [&]() -> void {
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.mutate(*layouts[i], *layouts[i + NUM_LAYOUTS]);
+                manager.mutate(layouts[i], layouts[i + NUM_LAYOUTS]);
+            }
+        }
+    );
+
+    checkRandomness(layouts);
+}
+
+// Hill-climb pattern: most moves are rejected, so they are applied
+// in place and undone instead of copying the parent into a child.
+auto baselineInPlace(ankerl::nanobench::Bench *const bench) -> void {
+    Manager manager;
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
+
+    bench->run(
+        "in place + undo (1)",
+        [&]() -> void {
+            for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+                const Move move = manager.mutate(layouts[i]);
+                manager.undo(layouts[i], move);
+            }
+        }
+    );
+
+    checkRandomness(layouts);
+}
+
+// Same configuration and moves as baseline(), known at compile time.
+auto baselineStaticManager(ankerl::nanobench::Bench *const bench) -> void {
+    StaticManager<static_config::DEFAULT> manager;
+    Arena arena;
+    Layouts layouts = arena.array(NUM_LAYOUTS * 2, manager.create());
+    for (Layout &layout : layouts) {
+        layout = manager.create();
+    }
+
+    bench->run(
+        "StaticManager (1)",
+        [&]() -> void {
+            for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+                manager.mutate(layouts[i], layouts[i + NUM_LAYOUTS]);
             }
         }
     );
@@ -53,14 +99,15 @@ auto baseline(ankerl::nanobench::Bench *const bench) -> void {
 
 auto benchOmpStatic(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         fmt::format("omp: static ({:d})", num_threads).c_str(),
         [&]() -> void {
 #pragma omp parallel for schedule(static) shared(layouts) private(manager) default (none)
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.mutate(*layouts[i], *layouts[i + NUM_LAYOUTS]);
+                manager.mutate(layouts[i], layouts[i + NUM_LAYOUTS]);
             }
         }
     );
@@ -70,14 +117,15 @@ auto benchOmpStatic(ankerl::nanobench::Bench *const bench, const uz num_threads)
 
 auto benchOmpGuided(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         fmt::format("omp: guided ({:d})", num_threads).c_str(),
         [&]() -> void {
 #pragma omp parallel for schedule(guided) shared(layouts) private(manager) default (none)
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.mutate(*layouts[i], *layouts[i + NUM_LAYOUTS]);
+                manager.mutate(layouts[i], layouts[i + NUM_LAYOUTS]);
             }
         }
     );
@@ -85,15 +133,16 @@ auto benchOmpGuided(ankerl::nanobench::Bench *const bench, const uz num_threads)
     checkRandomness(layouts);
 }
 
-auto processRange(Manager &manager, const Layouts &layouts, const uz beg, const uz end) -> void {
+auto processRange(Manager &manager, const Layouts layouts, const uz beg, const uz end) -> void {
     for (uz i = beg; i < end; ++i) {
-        manager.mutate(*layouts[i], *layouts[i + NUM_LAYOUTS]);
+        manager.mutate(layouts[i], layouts[i + NUM_LAYOUTS]);
     }
 }
 
 auto benchStdThread(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     std::vector managers(num_threads, Manager());
-    Layouts layouts = createLayouts(managers[0]);
+    Arena arena;
+    Layouts layouts = createLayouts(managers[0], arena);
 
     const uz range = NUM_LAYOUTS / num_threads;
     bench->run(
@@ -115,6 +164,59 @@ auto benchStdThread(ankerl::nanobench::Bench *const bench, const uz num_threads)
     checkRandomness(layouts);
 }
 
+// Each thread mutates its own population slice of NUMA_SLICE layouts,
+// allocated on its node (NumaMode::Local) or wherever the OS puts it
+// (NumaMode::SingleNode). The work per thread is fixed (weak scaling),
+// and the pinned threads live across the epochs, which only synchronize
+// on barriers: an epoch measures the mutations, not thread startup.
+auto benchNuma(ankerl::nanobench::Bench *const bench, const uz num_threads, const NumaMode mode) -> void {
+    using Slice = std::vector<Layout, NodeAllocator<Layout>>;
+
+    const NumaTopology topology(mode);
+    const bool local = topology.mode() == NumaMode::Local;
+    std::vector<std::unique_ptr<Slice>> slices(num_threads);
+    std::vector<Manager> managers(num_threads, Manager());
+
+    std::barrier start(static_cast<std::ptrdiff_t>(num_threads + 1));
+    std::barrier done(static_cast<std::ptrdiff_t>(num_threads + 1));
+    bool quit = false; // written before start, read after it
+
+    std::vector<std::jthread> threads;
+    for (uz t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() -> void {
+            const ScopedPin pin(topology.cpuOf(t));
+            // First touch of the slice by its pinned owner.
+            slices[t] = std::make_unique<Slice>(NodeAllocator<Layout>(topology.nodeId(topology.nodeOf(t))));
+            for (uz i = 0; i < NUMA_SLICE * 2; ++i) {
+                slices[t]->emplace_back(managers[t].create());
+            }
+            done.arrive_and_wait();
+
+            Slice &slice = *slices[t];
+            while (true) {
+                start.arrive_and_wait();
+                if (quit) { return; }
+                for (uz i = 0; i < NUMA_SLICE; ++i) {
+                    managers[t].mutate(slice[i], slice[i + NUMA_SLICE]);
+                }
+                done.arrive_and_wait();
+            }
+        });
+    }
+    done.arrive_and_wait();
+
+    bench->run(
+        fmt::format("{:s} ({:d})", local ? "numa: local" : "numa: single node", num_threads).c_str(),
+        [&]() -> void {
+            start.arrive_and_wait();
+            done.arrive_and_wait();
+        }
+    );
+
+    quit = true;
+    start.arrive_and_wait();
+}
+
 TEST_CASE("bench layout::Manager::mutate()") {
     REQUIRE_LE(MAX_THREADS, std::thread::hardware_concurrency());
     REQUIRE_GE(MAX_THREADS, 1);
@@ -128,6 +230,8 @@ TEST_CASE("bench layout::Manager::mutate()") {
     bench.performanceCounters(true);
 
     baseline(&bench);
+    baselineStaticManager(&bench);
+    baselineInPlace(&bench);
     for (uz i = 2; i <= MAX_THREADS; ++i) {
         omp_set_num_threads(static_cast<int>(i));
         benchOmpStatic(&bench, i);
@@ -136,6 +240,29 @@ TEST_CASE("bench layout::Manager::mutate()") {
     }
 }
 
+TEST_CASE("bench layout::Manager::mutate() NUMA scaling") {
+    const uz max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    ankerl::nanobench::Bench bench;
+    bench.title("mutate() on all hardware threads")
+         .unit("epoch")
+         .warmup(10)
+         .relative(true)
+         .minEpochIterations(100);
+
+    // 1, 2, 4, ..., then all the hardware threads
+    std::vector<uz> thread_counts;
+    for (uz i = 1; i < max_threads; i *= 2) {
+        thread_counts.emplace_back(i);
+    }
+    thread_counts.emplace_back(max_threads);
+
+    for (const uz num_threads : thread_counts) {
+        benchNuma(&bench, num_threads, NumaMode::SingleNode);
+        benchNuma(&bench, num_threads, NumaMode::Local);
+    }
+}
+
 }
 
 }
@@ -4,7 +4,9 @@
 #include <nanobench.h>
 #include <doctest/doctest.h>
 
+#include "../../src/common/arena.hpp"
 #include "../../src/layout/layout_manager.hpp"
+#include "../../src/layout/layout_static.hpp"
 
 static constexpr size_t NUM_LAYOUTS = 1000;
 static constexpr size_t MAX_THREADS = 8;
@@ -13,9 +15,9 @@ namespace jianhan::v0::layout::bench::reinit {
 
 TEST_SUITE("Bench layout::Manager::reinit()") {
 
-using Layouts = std::vector<std::unique_ptr<Layout>>;
+using Layouts = std::span<Layout>;
 
-auto checkRandomness(Layouts &l) -> void {
+auto checkRandomness(Layouts l) -> void {
     std::ranges::sort(l);
     uz num_duplicates = 0;
     for (uz i = 0; i < l.size() - 1; ++i) {
@@ -26,24 +28,24 @@ auto checkRandomness(Layouts &l) -> void {
     CHECK_LT(num_duplicates, 5);
 }
 
-auto createLayouts(Manager &manager) -> Layouts {
-    Layouts layouts;
-    for (uz i = 0; i < NUM_LAYOUTS * 2; ++i) {
-        const Layout lyt(manager.create());
-        layouts.emplace_back(std::make_unique<Layout>(lyt));
+auto createLayouts(Manager &manager, Arena &arena) -> Layouts {
+    Layouts layouts = arena.array(NUM_LAYOUTS * 2, manager.create());
+    for (Layout &layout : layouts) {
+        layout = manager.create();
     }
     return layouts;
 }
 
 auto baseline(ankerl::nanobench::Bench *const bench) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         "baseline (1)",
         [&]() -> void {
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.reinit(*layouts[i]);
+                manager.reinit(layouts[i]);
             }
         }
     );
@@ -51,16 +53,56 @@ auto baseline(ankerl::nanobench::Bench *const bench) -> void {
     checkRandomness(layouts);
 }
 
+// Same configuration as baseline(), known at compile time.
+auto baselineStaticManager(ankerl::nanobench::Bench *const bench) -> void {
+    StaticManager<static_config::DEFAULT> manager;
+    Arena arena;
+    Layouts layouts = arena.array(NUM_LAYOUTS * 2, manager.create());
+    for (Layout &layout : layouts) {
+        layout = manager.create();
+    }
+
+    bench->run(
+        "StaticManager (1)",
+        [&]() -> void {
+            for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+                manager.reinit(layouts[i]);
+            }
+        }
+    );
+
+    checkRandomness(layouts);
+}
+
+// The 64-lane path, with the number row.
+auto baselineGeometry40(ankerl::nanobench::Bench *const bench) -> void {
+    BasicManager<Geometry40> manager;
+    std::vector<BasicLayout<Geometry40>> layouts(NUM_LAYOUTS, manager.create());
+
+    bench->run(
+        "Geometry40 (1)",
+        [&]() -> void {
+            for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+                manager.reinit(layouts[i]);
+            }
+        }
+    );
+
+    std::ranges::sort(layouts);
+    CHECK_EQ(std::ranges::adjacent_find(layouts), layouts.end());
+}
+
 auto benchOmpStatic(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         fmt::format("omp: static ({:d})", num_threads).c_str(),
         [&]() -> void {
 #pragma omp parallel for schedule(static) shared(layouts) private(manager) default (none)
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.reinit(*layouts[i]);
+                manager.reinit(layouts[i]);
             }
         }
     );
@@ -70,14 +112,15 @@ auto benchOmpStatic(ankerl::nanobench::Bench *const bench, const uz num_threads)
 
 auto benchOmpGuided(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     Manager manager;
-    Layouts layouts = createLayouts(manager);
+    Arena arena;
+    Layouts layouts = createLayouts(manager, arena);
 
     bench->run(
         fmt::format("omp: guided ({:d})", num_threads).c_str(),
         [&]() -> void {
 #pragma omp parallel for schedule(guided) shared(layouts) private(manager) default (none)
             for (uz i = 0; i < NUM_LAYOUTS; ++i) {
-                manager.reinit(*layouts[i]);
+                manager.reinit(layouts[i]);
             }
         }
     );
@@ -85,15 +128,16 @@ auto benchOmpGuided(ankerl::nanobench::Bench *const bench, const uz num_threads)
     checkRandomness(layouts);
 }
 
-void processRange(Manager &manager, const Layouts &layouts, const uz beg, const uz end) {
+void processRange(Manager &manager, const Layouts layouts, const uz beg, const uz end) {
     for (uz i = beg; i < end; ++i) {
-        manager.reinit(*layouts[i]);
+        manager.reinit(layouts[i]);
     }
 }
 
 auto benchStdThread(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
     std::vector managers(num_threads, Manager());
-    Layouts layouts = createLayouts(managers[0]);
+    Arena arena;
+    Layouts layouts = createLayouts(managers[0], arena);
 
     const uz range = NUM_LAYOUTS / num_threads;
     bench->run(
@@ -128,6 +172,8 @@ TEST_CASE("bench layout::Manager::reinit()") {
     bench.performanceCounters(true);
 
     baseline(&bench);
+    baselineStaticManager(&bench);
+    baselineGeometry40(&bench);
     for (uz i = 2; i <= MAX_THREADS; ++i) {
         omp_set_num_threads(static_cast<int>(i));
         benchOmpStatic(&bench, i);
@@ -0,0 +1,84 @@
+#include <thread>
+
+#include <nanobench.h>
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_anneal.hpp"
+#include "../../src/search/search_deterministic.hpp"
+#include "../search/search_fixtures.hpp"
+
+static constexpr size_t NUM_RESTARTS = 64;
+static constexpr size_t MAX_THREADS = 8;
+
+namespace jianhan::v0::search::bench::deterministic {
+
+TEST_SUITE("Bench search::DeterministicRun") {
+
+using tests::TOY_EVALUATOR;
+
+static const Annealer ANNEALER(TOY_EVALUATOR, {.num_steps = 20'000, .start_temperature = 2, .end_temperature = 0.01});
+
+// The restarts on the workers' own managers, offering to a shared archive.
+auto baseline(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
+    Scheduler scheduler(num_threads);
+    const std::atomic<bool> stop{false};
+
+    bench->run(
+        fmt::format("Scheduler ({:d})", num_threads).c_str(),
+        [&]() -> void {
+            EliteArchive elites(16);
+            for (uz i = 0; i < NUM_RESTARTS; ++i) {
+                scheduler.submit({.id = i, .seed = i});
+            }
+            scheduler.run([&](Worker &worker, const Restart &restart) -> void {
+                Prng prng(restart.seed);
+                const AnnealResult result = ANNEALER.run(worker.manager(), prng, stop);
+                elites.insert(result.best, result.score);
+            });
+            ankerl::nanobench::doNotOptimizeAway(elites.snapshot());
+        }
+    );
+}
+
+// The same restarts as items, with their own streams and elites.
+auto benchDeterministic(ankerl::nanobench::Bench *const bench, const uz num_threads) -> void {
+    Scheduler scheduler(num_threads);
+    const std::atomic<bool> stop{false};
+    DeterministicRun deterministic({.num_items = NUM_RESTARTS, .seed = 42, .num_elites = 16});
+
+    Elites elites;
+    bench->run(
+        fmt::format("DeterministicRun ({:d})", num_threads).c_str(),
+        [&]() -> void {
+            elites = deterministic.run(scheduler, [&](layout::Manager &manager, Item &item) -> void {
+                const AnnealResult result = ANNEALER.run(manager, item.prng(), stop);
+                item.offer(result.best, result.score);
+            });
+        }
+    );
+
+    CHECK_EQ(elites.size(), 16);
+}
+
+// DeterministicRun should keep at least 90% of the throughput of the
+// free-running scheduler with the same number of workers.
+TEST_CASE("bench search::DeterministicRun") {
+    REQUIRE_LE(MAX_THREADS, std::thread::hardware_concurrency());
+
+    for (uz num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2) {
+        ankerl::nanobench::Bench bench;
+        bench.title(fmt::format("restarts ({:d} threads)", num_threads))
+             .unit("restart")
+             .batch(NUM_RESTARTS)
+             .warmup(1)
+             .relative(true);
+        bench.performanceCounters(true);
+
+        baseline(&bench, num_threads);
+        benchDeterministic(&bench, num_threads);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,100 @@
+#include <doctest/doctest.h>
+
+#include "../../src/common/arena.hpp"
+#include "../../src/layout/layout_manager.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test Arena") {
+
+TEST_CASE("test Arena::allocate()") {
+    Arena arena(1024);
+
+    SUBCASE("alignment") {
+        for (const uz alignment : {1, 2, 8, 16, 64}) {
+            std::ignore = arena.allocate(3, 1);
+            const void *ptr = arena.allocate(8, alignment);
+            CHECK_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+        }
+    }
+
+    SUBCASE("growth and bulk reset") {
+        std::ignore = arena.allocate(1000, 8);
+        std::ignore = arena.allocate(1000, 8); // second block
+        std::ignore = arena.allocate(5000, 8); // oversized block
+        CHECK_GE(arena.used(), 7000);
+        CHECK_GE(arena.reserved(), 7000);
+
+        arena.reset();
+        CHECK_EQ(arena.used(), 0);
+        const uz reserved = arena.reserved();
+        const void *first = arena.allocate(1000, 8);
+        std::ignore = arena.allocate(1000, 8);
+        std::ignore = arena.allocate(5000, 8);
+        CHECK_EQ(arena.reserved(), reserved); // merged into one block
+
+        arena.reset();
+        CHECK_EQ(arena.allocate(1000, 8), first);
+    }
+
+    SUBCASE("pmr containers") {
+        std::pmr::vector<int> values(&arena);
+        for (int i = 0; i < 100; ++i) {
+            values.emplace_back(i);
+        }
+        CHECK_EQ(values[99], 99);
+        CHECK_GE(arena.used(), 100 * sizeof(int));
+    }
+}
+
+TEST_CASE("test Arena::array()") {
+    Arena arena;
+    layout::Manager manager;
+    const Layout parent = manager.create();
+    const auto layouts = arena.array(1000, parent);
+    REQUIRE_EQ(layouts.size(), 1000);
+    for (Layout &layout : layouts) {
+        manager.mutate(layout, parent);
+        CHECK(layout.valid());
+    }
+}
+
+TEST_CASE("test NoAllocationScope") {
+    layout::Manager manager;
+    const Layout parent = manager.create();
+    Arena &arena = Arena::local();
+
+    auto generation = [&]() -> uz {
+        arena.reset();
+        const auto children = arena.array(500, parent);
+        uz num_valid = 0;
+        for (Layout &child : children) {
+            manager.mutate(child, parent);
+            num_valid += manager.canManage(child);
+        }
+        return num_valid;
+    };
+
+    REQUIRE_EQ(generation(), 500); // warm-up
+    // steady state: one generation of children per iteration
+    for (uz i = 0; i < 10; ++i) {
+        uz num_valid, num_allocations;
+        {
+            const NoAllocationScope scope;
+            num_valid = generation();
+            num_allocations = scope.allocations();
+        }
+        CHECK_EQ(num_valid, 500);
+        CHECK_EQ(num_allocations, 0);
+    }
+
+#ifdef JIANHAN_COUNT_ALLOCATIONS
+    const uz before = heapAllocations();
+    const auto vector = std::make_unique<std::vector<int>>(10);
+    CHECK_EQ(heapAllocations() - before, 2);
+#endif
+}
+
+}
+
+}
@@ -0,0 +1,51 @@
+#include <doctest/doctest.h>
+
+#include "../../src/common/utils.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test Geometry") {
+
+TEST_CASE("test BasicUtil<Geometry30>") {
+    for (const Position pos : POSITIONS) {
+        REQUIRE_EQ(Util::pos2row(pos), pos / COL_COUNT);
+        REQUIRE_EQ(Util::pos2col(pos), pos % COL_COUNT);
+        REQUIRE_EQ(Util::coord2pos(Util::pos2row(pos), Util::pos2col(pos)), pos);
+    }
+    for (uz val = 0; val < MAX_KEY_CODE; ++val) {
+        const bool legal = ('A' <= val and val <= 'Z') or val == ',' or val == '.'
+                           or val == '/' or val == ';';
+        REQUIRE_EQ(Util::isKeyValueLegal(static_cast<KeyValue>(val)), legal);
+    }
+    CHECK_FALSE(Util::isPositionLegal(KEY_COUNT));
+}
+
+TEST_CASE("test BasicUtil<Geometry40>") {
+    using Util40 = BasicUtil<Geometry40>;
+    CHECK(Util40::isKeyValueLegal('0'));
+    CHECK(Util40::isKeyValueLegal('Z'));
+    CHECK_FALSE(Util40::isKeyValueLegal('-'));
+    CHECK(Util40::isPositionLegal(39));
+    CHECK_FALSE(Util40::isPositionLegal(40));
+    CHECK_EQ(Util40::pos2row(39), 3);
+    CHECK_EQ(Util40::coord2pos(1, 0), 10);
+}
+
+TEST_CASE("test BasicUtil<GeometrySplit34>") {
+    using UtilSplit = BasicUtil<GeometrySplit34>;
+    CHECK(UtilSplit::isKeyValueLegal('['));
+    CHECK(UtilSplit::isKeyValueLegal('\\'));
+    CHECK_FALSE(UtilSplit::isKeyValueLegal('0'));
+
+    // thumb keys below the inner columns
+    for (const Position pos : {30, 31, 32, 33}) {
+        CHECK_EQ(UtilSplit::pos2row(pos), 3);
+        CHECK_EQ(UtilSplit::coord2pos(3, UtilSplit::pos2col(pos)), pos);
+    }
+    CHECK_EQ(UtilSplit::pos2col(30), 3);
+    CHECK_EQ(UtilSplit::pos2col(33), 6);
+}
+
+}
+
+}
@@ -0,0 +1,57 @@
+#include <doctest/doctest.h>
+#include <vector>
+
+#include "../../src/common/huge_pages.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test huge pages") {
+
+TEST_CASE("test allocateLarge()") {
+
+    SUBCASE("large allocations") {
+        static constexpr uz SIZE = 3 * HUGE_PAGE_SIZE + 123;
+        const HugePageStats before = hugePageStats();
+
+        auto *bytes = static_cast<std::byte *>(allocateLarge(SIZE));
+        REQUIRE_NE(bytes, nullptr);
+        CHECK_EQ(reinterpret_cast<uintptr_t>(bytes) % HUGE_PAGE_SIZE, 0);
+        CHECK(std::all_of(bytes, bytes + SIZE, [](const std::byte b) { return b == std::byte{0}; }));
+        std::fill(bytes, bytes + SIZE, std::byte{1}); // touch every page
+
+        const HugePageStats after = hugePageStats();
+        CHECK_EQ(after.hugetlb + after.transparent + after.fallback,
+                 before.hugetlb + before.transparent + before.fallback + 1);
+        CHECK_EQ(after.small, before.small);
+
+        CHECK_EQ(largeMappingSize(SIZE), 4 * HUGE_PAGE_SIZE);
+        const uz huge_bytes = hugePageBytes(bytes);
+        CHECK_LE(huge_bytes, largeMappingSize(SIZE));
+        MESSAGE(fmt::format("{} MB on huge pages (hugetlb: {}, transparent: {}, fallback: {})",
+                            huge_bytes >> 20, after.hugetlb, after.transparent, after.fallback));
+
+        deallocateLarge(bytes, SIZE);
+    }
+
+    SUBCASE("small allocations") {
+        const uz num_small = hugePageStats().small;
+        void *addr = allocateLarge(100);
+        REQUIRE_NE(addr, nullptr);
+        CHECK_EQ(hugePageStats().small, num_small + 1);
+        CHECK_EQ(largeMappingSize(100), 100);
+        deallocateLarge(addr, 100);
+    }
+}
+
+TEST_CASE("test HugePageAllocator") {
+    std::vector<uint64_t, HugePageAllocator<uint64_t>> values;
+    for (uint64_t i = 0; i < 1'000'000; ++i) {
+        values.emplace_back(i);
+    }
+    CHECK_EQ(values[999'999], 999'999);
+    CHECK_EQ(values.front(), 0);
+}
+
+}
+
+}
@@ -0,0 +1,76 @@
+#include <doctest/doctest.h>
+#include <sched.h>
+
+#include "../../src/common/numa.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test NUMA placement") {
+
+TEST_CASE("test NumaTopology::parseCpuList()") {
+    using V = std::vector<unsigned>;
+    CHECK_EQ(NumaTopology::parseCpuList("0-3"), (V{0, 1, 2, 3}));
+    CHECK_EQ(NumaTopology::parseCpuList("8,0-1,10-11\n"), (V{0, 1, 8, 10, 11}));
+    CHECK_EQ(NumaTopology::parseCpuList("5"), (V{5}));
+    CHECK(NumaTopology::parseCpuList("").empty());
+}
+
+TEST_CASE("test NumaTopology") {
+    for (const NumaMode mode : {NumaMode::SingleNode, NumaMode::Local}) {
+        const NumaTopology topology(mode);
+        REQUIRE_GE(topology.numNodes(), 1);
+        REQUIRE_GE(topology.numCpus(), 1);
+        if (mode == NumaMode::SingleNode) {
+            CHECK_EQ(topology.numNodes(), 1);
+            CHECK_EQ(topology.nodeId(0), -1);
+        }
+
+        // Workers are spread over all the nodes and CPUs.
+        std::vector<unsigned> used;
+        for (uz worker = 0; worker < topology.numCpus(); ++worker) {
+            const uz node = topology.nodeOf(worker);
+            REQUIRE_LT(node, topology.numNodes());
+            CHECK(std::ranges::binary_search(topology.cpus(node), topology.cpuOf(worker)));
+            used.emplace_back(topology.cpuOf(worker));
+        }
+        std::ranges::sort(used);
+        CHECK(std::ranges::adjacent_find(used) == used.end());
+    }
+}
+
+TEST_CASE("test ScopedPin") {
+    const NumaTopology topology;
+    const unsigned cpu = topology.cpuOf(0);
+    cpu_set_t before;
+    sched_getaffinity(0, sizeof(before), &before);
+    {
+        const ScopedPin pin(cpu);
+        REQUIRE(pin.pinned());
+        CHECK_EQ(sched_getcpu(), static_cast<int>(cpu));
+    }
+    cpu_set_t after;
+    sched_getaffinity(0, sizeof(after), &after);
+    CHECK(CPU_EQUAL(&after, &before));
+}
+
+TEST_CASE("test NodeAllocator and NodeReplicas") {
+    const NumaTopology topology;
+
+    std::vector<uint64_t, NodeAllocator<uint64_t>> values(NodeAllocator<uint64_t>(topology.nodeId(0)));
+    for (uint64_t i = 0; i < 100'000; ++i) {
+        values.emplace_back(i);
+    }
+    CHECK_EQ(values[99'999], 99'999);
+
+    const std::vector<int> table{1, 2, 3};
+    const NodeReplicas replicas(topology, table);
+    REQUIRE_EQ(replicas.size(), topology.numNodes());
+    for (uz node = 0; node < replicas.size(); ++node) {
+        CHECK_EQ(replicas.get(node), table);
+        CHECK_NE(replicas.get(node).data(), table.data());
+    }
+}
+
+}
+
+}
@@ -0,0 +1,95 @@
+#include <doctest/doctest.h>
+#include <thread>
+
+#include "../../src/common/ring_buffer.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test ring buffers") {
+
+static constexpr uz NUM_ITEMS = 100'000;
+
+TEST_CASE("test SpscRing") {
+
+    SUBCASE("bounded") {
+        SpscRing<uz> ring(4);
+        REQUIRE_EQ(ring.capacity(), 4);
+        for (uz i = 0; i < 4; ++i) {
+            REQUIRE(ring.tryPush(i));
+        }
+        CHECK_FALSE(ring.tryPush(4));
+        for (uz i = 0; i < 4; ++i) {
+            CHECK_EQ(ring.tryPop(), i);
+        }
+        CHECK_FALSE(ring.tryPop().has_value());
+    }
+
+    SUBCASE("concurrent, in order") {
+        SpscRing<uz> ring(64);
+        std::jthread producer([&ring]() -> void {
+            for (uz i = 0; i < NUM_ITEMS; ++i) {
+                while (not ring.tryPush(i)) { std::this_thread::yield(); }
+            }
+        });
+
+        uz num_wrong = 0;
+        for (uz expected = 0; expected < NUM_ITEMS;) {
+            if (const auto value = ring.tryPop()) {
+                num_wrong += *value != expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        CHECK_EQ(num_wrong, 0);
+    }
+}
+
+TEST_CASE("test MpmcRing") {
+    static constexpr uz NUM_THREADS = 4;
+
+    SUBCASE("bounded") {
+        MpmcRing<uz> ring(3);
+        REQUIRE_EQ(ring.capacity(), 4);
+        for (uz i = 0; i < 4; ++i) {
+            REQUIRE(ring.tryPush(i));
+        }
+        CHECK_FALSE(ring.tryPush(4));
+        for (uz i = 0; i < 4; ++i) {
+            CHECK_EQ(ring.tryPop(), i);
+        }
+        CHECK_FALSE(ring.tryPop().has_value());
+    }
+
+    SUBCASE("concurrent, no loss and no duplicate") {
+        MpmcRing<uz> ring(64);
+        std::vector<std::atomic<uz>> received(NUM_ITEMS * NUM_THREADS);
+        std::atomic<uz> num_received{0};
+        {
+            std::vector<std::jthread> threads;
+            for (uz t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&ring, t]() -> void {
+                    for (uz i = 0; i < NUM_ITEMS; ++i) {
+                        while (not ring.tryPush(t * NUM_ITEMS + i)) { std::this_thread::yield(); }
+                    }
+                });
+                threads.emplace_back([&]() -> void {
+                    while (num_received.load() < NUM_ITEMS * NUM_THREADS) {
+                        if (const auto value = ring.tryPop()) {
+                            received[*value].fetch_add(1);
+                            num_received.fetch_add(1);
+                        } else {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+        }
+        CHECK(std::ranges::all_of(received, [](const auto &n) -> bool {
+            return n.load() == 1;
+        }));
+    }
+}
+
+}
+
+}
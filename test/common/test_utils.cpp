@@ -12,6 +12,16 @@ TEST_CASE("test Util::buildAbsPath(string)") {
     REQUIRE_NOTHROW(Util::mkAbsPath(SUB_PATH));
 }
 
+TEST_CASE("test Util::setProjectDirectory(string)") {
+    const std::string root = Util::mkAbsPath("");
+    Util::setProjectDirectory("/opt/jianhan");
+    CHECK_EQ(Util::mkAbsPath(SUB_PATH), "/opt/jianhan/sth/dummy.anytype");
+    CHECK_EQ(BasicUtil<Geometry40>::mkAbsPath(SUB_PATH), "/opt/jianhan/sth/dummy.anytype");
+
+    Util::setProjectDirectory(std::string_view(root).substr(0, root.size() - 1));
+    CHECK_EQ(Util::mkAbsPath(""), root);
+}
+
 TEST_CASE("show Util::buildAbsPath(string)") {
     const std::string abs_path = Util::mkAbsPath(SUB_PATH);
     fmt::println(stderr, "\nRelative Path: {}", SUB_PATH);
@@ -98,6 +98,108 @@ TEST_CASE("test Layout comparison") {
 
 }
 
+TEST_CASE("test Layout::hash()") {
+    Layout l1("QWERTYUIOPASDFGHJKL;ZXCVBNM,./"); // QW...
+    Layout l2("QWERTYUIOPASDFGHJKL;ZXCVBNM,./"); // QW...
+    Layout l3("WQERTYUIOPASDFGHJKL;ZXCVBNM,./"); // WQ...
+    CHECK_EQ(l1.hash(), l2.hash());
+    CHECK_NE(l1.hash(), l3.hash());
+    CHECK_EQ(std::hash<Layout>{}(l1), l1.hash());
+
+    // Every single swap should give a distinct hash.
+    std::vector<uint64_t> hashes{l1.hash()};
+    for (uz i = 0; i < KEY_COUNT; ++i) {
+        for (uz j = i + 1; j < KEY_COUNT; ++j) {
+            std::string str = l1.toStr();
+            std::swap(str[i], str[j]);
+            hashes.emplace_back(Layout(str).hash());
+        }
+    }
+    std::ranges::sort(hashes);
+    CHECK_EQ(std::ranges::adjacent_find(hashes), hashes.end());
+}
+
+TEST_CASE("test BasicLayout<Geometry40>") {
+    using Layout40 = BasicLayout<Geometry40>;
+    const Layout40 qwerty("1234567890QWERTYUIOPASDFGHJKL;ZXCVBNM,./");
+    CHECK_EQ(qwerty.getPos('1'), 0);
+    CHECK_EQ(qwerty.getVal(10), 'Q');
+    CHECK(qwerty.valid());
+    CHECK_EQ(qwerty.hash(), Layout40(qwerty.toStr()).hash());
+    CHECK_NE(qwerty.hash(), Layout40("2134567890QWERTYUIOPASDFGHJKL;ZXCVBNM,./").hash());
+
+    REQUIRE_THROWS_AS((Layout40("QWERTYUIOPASDFGHJKL;ZXCVBNM,./")), std::exception);
+    REQUIRE_THROWS_AS((Layout40("1134567890QWERTYUIOPASDFGHJKL;ZXCVBNM,./")), std::exception);
+    REQUIRE_THROWS_AS((Layout40("-234567890QWERTYUIOPASDFGHJKL;ZXCVBNM,./")), std::exception);
+}
+
+TEST_CASE("test Layout::parse()") {
+    static constexpr std::string_view QWERTY = "QWERTYUIOPASDFGHJKL;ZXCVBNM,./";
+
+    const auto layout = Layout::parse(QWERTY);
+    REQUIRE(layout.has_value());
+    CHECK_EQ(*layout, Layout(QWERTY));
+
+    CHECK_EQ(Layout::parse("QWERTYUIOPASDFGHJKL;ZXCVBNM,.").error(), ParseError::Length);
+    CHECK_EQ(Layout::parse("qWERTYUIOPASDFGHJKL;ZXCVBNM,./").error(), ParseError::IllegalKey);
+    CHECK_EQ(Layout::parse("QWERTYUIOPASDFGHJKL;ZXCVBNM,.\xff").error(), ParseError::IllegalKey);
+    CHECK_EQ(Layout::parse("QWERTYUIOPASDFGHJKL;ZXCVBNM,.-").error(), ParseError::IllegalKey);
+    CHECK_EQ(Layout::parse("QQERTYUIOPASDFGHJKL;ZXCVBNM,./").error(), ParseError::DuplicateKey);
+
+    // Every legal string is accepted and every single illegal byte rejected.
+    for (uz i = 0; i < KEY_COUNT; ++i) {
+        for (uz ch = 0; ch < 256; ++ch) {
+            std::string str(QWERTY);
+            const bool same = str[i] == static_cast<char>(ch);
+            str[i] = static_cast<char>(ch);
+            const auto parsed = Layout::parse(str);
+            if (same) {
+                REQUIRE(parsed.has_value());
+            } else if (Util::isKeyValueLegal(static_cast<KeyValue>(ch))) {
+                REQUIRE_EQ(parsed.error(), ParseError::DuplicateKey);
+            } else {
+                REQUIRE_EQ(parsed.error(), ParseError::IllegalKey);
+            }
+        }
+    }
+
+    using Layout40 = BasicLayout<Geometry40>;
+    CHECK(Layout40::parse("1234567890QWERTYUIOPASDFGHJKL;ZXCVBNM,./").has_value());
+    CHECK_EQ(Layout40::parse("1234567890QWERTYUIOPASDFGHJKL;ZXCVBNM,.-").error(), ParseError::IllegalKey);
+    CHECK_EQ(Layout40::parse("1234567890QWERTYUIOPASDFGHJKL;ZXCVBNM,.1").error(), ParseError::DuplicateKey);
+}
+
+TEST_CASE("test parseLayouts() and writeLayouts()") {
+    static constexpr std::string_view TEXT =
+        "QWERTYUIOPASDFGHJKL;ZXCVBNM,./\n"
+        "/,.PYFGCRLAOEUIDHTNS;QJKXBMWVZ\r\n"
+        "\n"
+        "QWFPGJLUY;ARSTDHNEIOZXCVBKM,./";
+
+    std::vector<Layout> layouts;
+    REQUIRE_EQ(parseLayouts(TEXT, layouts), 3);
+    CHECK_EQ(layouts[1], Layout("/,.PYFGCRLAOEUIDHTNS;QJKXBMWVZ"));
+
+    // Whole lines only.
+    std::array<char, 3 * (KEY_COUNT + 1) - 1> small{};
+    CHECK_EQ(writeLayouts(std::span<const Layout>(layouts), small), 2);
+
+    std::array<char, 3 * (KEY_COUNT + 1)> buffer{};
+    REQUIRE_EQ(writeLayouts(std::span<const Layout>(layouts), buffer), 3);
+    std::vector<Layout> round_trip;
+    REQUIRE_EQ(parseLayouts(std::string_view(buffer.data(), buffer.size()), round_trip), 3);
+    CHECK_EQ(round_trip, layouts);
+
+    SUBCASE("rejected line") {
+        std::vector<Layout> some;
+        const auto parsed = parseLayouts("QWERTYUIOPASDFGHJKL;ZXCVBNM,./\n\nQWERTY\n", some);
+        REQUIRE_FALSE(parsed.has_value());
+        CHECK_EQ(parsed.error().line, 3);
+        CHECK_EQ(parsed.error().error, ParseError::Length);
+        CHECK_EQ(some.size(), 1);
+    }
+}
+
 }
 
 }
@@ -52,6 +52,28 @@ TEST_CASE("test layout::Area::assign()") {
     CHECK_LT(counter, EXPECTION + TOLERANCE);
 }
 
+TEST_CASE("test layout::Area::assign() keeps the layout consistent") {
+    // Keys on both sides of the vectorized blocks: [44, 60), [60, 76), [76, 92).
+    const auto config = u8R"(
+        val = [",", "/", ";", "A", "K", "L", "Z", "Y"]
+        pos = [27, 29, 19, 10, 17, 18, 20, 5]
+    )"_toml;
+    Area wide_area(config);
+
+    Layout layout(QWERTY);
+    for (uz i = 0; i < 1'000; ++i) {
+        wide_area.assign(layout, prng);
+        REQUIRE(layout.valid());
+        REQUIRE(wide_area.isCompatible(layout));
+        for (const Position pos : {0, 1, 2, 3, 4, 6, 7, 8, 9, 11}) {
+            REQUIRE_EQ(layout.getVal(pos), QWERTY.getVal(pos));
+        }
+        for (const Position pos : POSITIONS) {
+            REQUIRE_EQ(layout.getPos(layout.getVal(pos)), pos);
+        }
+    }
+}
+
 static auto munOfDiffKeys(const Layout &lyt_1, const Layout &lyt_2) -> uz {
     uz counter = 0;
     for (auto [ch1, ch2]
@@ -0,0 +1,99 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_manager.hpp"
+
+namespace jianhan::v0::layout::tests {
+
+TEST_SUITE("Test layout::Bandit") {
+
+TEST_CASE("test layout::AliasTable::sample()") {
+    static constexpr uz SAMPLES = 100'000;
+    static constexpr std::array<fz, 5> WEIGHTS{4, 0, 1, 2, 3};
+
+    Prng prng(1);
+    AliasTable table(WEIGHTS);
+    REQUIRE_EQ(table.size(), WEIGHTS.size());
+
+    std::array<uz, WEIGHTS.size()> counts{};
+    for (uz i = 0; i < SAMPLES; ++i) {
+        ++counts[table.sample(prng)];
+    }
+    CHECK_EQ(counts[1], 0);
+    for (uz i = 0; i < WEIGHTS.size(); ++i) {
+        const f64 expected = SAMPLES * WEIGHTS[i] / 10.0;
+        CHECK_LE(std::abs(static_cast<f64>(counts[i]) - expected), 0.05 * SAMPLES);
+    }
+
+    SUBCASE("rebuild()") {
+        static constexpr std::array<fz, 5> ONLY_LAST{0, 0, 0, 0, 1};
+        table.rebuild(ONLY_LAST);
+        for (uz i = 0; i < 1'000; ++i) {
+            REQUIRE_EQ(table.sample(prng), 4);
+        }
+    }
+}
+
+TEST_CASE("test layout::Bandit construction") {
+    REQUIRE_NOTHROW((Bandit(std::array<fz, 2>{1, 0}, {})));
+    CHECK_THROWS_AS((Bandit(std::span<const fz>{}, {})), std::invalid_argument);
+    CHECK_THROWS_AS((Bandit(std::array<fz, 2>{0, 0}, {})), std::invalid_argument);
+    CHECK_THROWS_AS((Bandit(std::array<fz, 2>{1, -1}, {})), std::invalid_argument);
+    CHECK_THROWS_AS((Bandit(std::array<fz, 2>{1, 1}, {.decay = 0})), std::invalid_argument);
+    CHECK_THROWS_AS((Bandit(std::array<fz, 2>{1, 1}, {.exploration = 2})), std::invalid_argument);
+}
+
+TEST_CASE("test layout::Bandit::reward()") {
+    static constexpr BanditOptions OPTIONS{.decay = 0.9f, .period = 64, .exploration = 0.1f};
+
+    Prng prng(2);
+    Bandit bandit(std::array<fz, 3>{1, 1, 2}, OPTIONS);
+    CHECK_EQ(bandit.probabilities(), (std::vector<fz>{0.25f, 0.25f, 0.5f}));
+
+    // Only the first arm pays off.
+    for (uz i = 0; i < 5'000; ++i) {
+        const uz arm = bandit.select(prng);
+        bandit.reward(arm, arm == 0 ? 1.0f : 0.0f);
+    }
+    auto probabilities = bandit.probabilities();
+    CHECK_GT(probabilities[0], 0.8f);
+    CHECK_GE(probabilities[1], 0.1f * 0.25f * 0.99f); // exploration floor
+
+    // Then only the second one: the old statistics fade out.
+    for (uz i = 0; i < 5'000; ++i) {
+        const uz arm = bandit.select(prng);
+        bandit.reward(arm, arm == 1 ? 1.0f : 0.0f);
+    }
+    probabilities = bandit.probabilities();
+    CHECK_GT(probabilities[1], 0.8f);
+}
+
+TEST_CASE("test layout::Manager adaptive selection") {
+    Manager manager;
+    manager.seed(5);
+    manager.setOperatorWeights({1, 1, 0, 1, 0});
+    const auto area_priors = manager.areaProbabilities();
+    REQUIRE_GT(area_priors.size(), 1);
+
+    manager.enableAdaptiveSelection({.period = 32});
+    CHECK_EQ(manager.operatorProbabilities()[static_cast<uz>(Operator::KSwap)], 0.0f);
+
+    // Reward the reversals in the last (default) area only.
+    const uz last = area_priors.size() - 1;
+    Layout layout = manager.create();
+    for (uz i = 0; i < 5'000; ++i) {
+        const Move move = manager.mutate(layout);
+        REQUIRE_NE(move.op, Operator::KSwap);
+        const bool good = move.area == last and move.op == Operator::Reverse;
+        manager.reward(move, good ? 1.0f : 0.0f);
+        REQUIRE(manager.canManage(layout));
+    }
+    CHECK_GT(manager.areaProbabilities()[last], area_priors[last]);
+    CHECK_GT(manager.operatorProbabilities()[static_cast<uz>(Operator::Reverse)], 0.5f);
+
+    manager.disableAdaptiveSelection();
+    CHECK_EQ(manager.areaProbabilities(), area_priors);
+}
+
+}
+
+}
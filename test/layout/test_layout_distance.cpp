@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_distance.hpp"
+
+namespace jianhan::v0::layout::tests {
+
+TEST_SUITE("Test layout::Distance") {
+
+static const auto QWERTY = Layout(""
+    "QWERTYUIOP"
+    "ASDFGHJKL;"
+    "ZXCVBNM,./"
+);
+
+TEST_CASE("test layout::Distance::hamming()") {
+    CHECK_EQ(Distance::hamming(QWERTY, QWERTY), 0);
+    CHECK_EQ(Distance::hamming(QWERTY, Layout("WQERTYUIOPASDFGHJKL;ZXCVBNM,./")), 2);
+    CHECK_EQ(Distance::hamming(QWERTY, Layout("WEQRTYUIOPASDFGHJKL;ZXCVBNM,./")), 3);
+    CHECK_EQ(Distance::mismatches(QWERTY, Layout("WQERTYUIOPASDFGHJKL;ZXCVBNM,./")), 0b11u);
+}
+
+TEST_CASE("test layout::Distance::swap()") {
+    CHECK_EQ(Distance::swap(QWERTY, QWERTY), 0);
+    CHECK_EQ(Distance::swap(QWERTY, Layout("WQERTYUIOPASDFGHJKL;ZXCVBNM,./")), 1);
+    CHECK_EQ(Distance::swap(QWERTY, Layout("WEQRTYUIOPASDFGHJKL;ZXCVBNM,./")), 2);
+    CHECK_EQ(Distance::swap(QWERTY, Layout("WQREYTUIOPASDFGHJKL;ZXCVBNM,./")), 3);
+
+    SUBCASE("consistent with mutations") {
+        Manager manager;
+        const Layout parent = manager.create();
+        Layout child = parent;
+        for (uz i = 1; i <= 5; ++i) {
+            manager.mutate(child, Layout(child));
+            CHECK_LE(Distance::swap(parent, child), i);
+            CHECK_EQ(Distance::swap(parent, child), Distance::swap(child, parent));
+        }
+    }
+}
+
+TEST_CASE("test layout::Distance::perArea()") {
+    Manager manager;
+    const Distance distance(manager);
+    REQUIRE_GE(distance.numAreas(), 1);
+
+    const Layout lhs = manager.create();
+    const Layout rhs = manager.create();
+    std::vector<uz> distances(distance.numAreas());
+    distance.perArea(lhs, rhs, distances);
+
+    uz total = 0;
+    for (const uz d : distances) {
+        total += d;
+    }
+    CHECK_EQ(total, Distance::hamming(lhs, rhs));
+}
+
+TEST_CASE("test layout::Distance::allPairs()") {
+    static constexpr uz NUM_LAYOUTS = 150; // not a multiple of the tile size
+
+    Manager manager;
+    std::vector<Layout> layouts;
+    for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+        layouts.emplace_back(manager.create());
+    }
+
+    for (const Metric metric : {Metric::Hamming, Metric::Swap}) {
+        const auto distances = Distance::allPairs(layouts, metric);
+        REQUIRE_EQ(distances.size(), NUM_LAYOUTS * NUM_LAYOUTS);
+
+        uz num_wrong = 0;
+        for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+            for (uz j = 0; j < NUM_LAYOUTS; ++j) {
+                const uz expected = metric == Metric::Hamming
+                                        ? Distance::hamming(layouts[i], layouts[j])
+                                        : Distance::swap(layouts[i], layouts[j]);
+                num_wrong += distances[i * NUM_LAYOUTS + j] != expected;
+            }
+        }
+        CHECK_EQ(num_wrong, 0);
+    }
+}
+
+}
+
+}
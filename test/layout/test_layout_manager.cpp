@@ -175,6 +175,197 @@ TEST_CASE("show layout::Manager::mutate()") {
     }
 }
 
+TEST_CASE("test layout::Manager::mutate() in place and undo()") {
+    static constexpr uz STEPS = 1'000;
+
+    Manager copying, in_place;
+    copying.seed(7), in_place.seed(7);
+    const Layout start = copying.create();
+    std::ignore = in_place.create();
+
+    SUBCASE("same moves as mutate(target, parent)") {
+        Layout parent = start, child = start, layout = start;
+        for (uz i = 0; i < STEPS; ++i) {
+            copying.mutate(child, parent);
+            const Move move = in_place.mutate(layout);
+            REQUIRE_EQ(layout, child);
+            REQUIRE_EQ(move.op, Operator::Swap);
+            REQUIRE_EQ(move.num_swaps, 1);
+            const auto [pos1, pos2] = move.swaps[0];
+            REQUIRE_NE(pos1, pos2);
+            REQUIRE_EQ(layout.getVal(pos1), parent.getVal(pos2));
+            parent = child;
+        }
+    }
+
+    SUBCASE("undo() reverts the moves") {
+        Layout layout = start;
+        std::vector<Move> moves;
+        std::vector<Layout> history;
+        for (uz i = 0; i < STEPS; ++i) {
+            history.emplace_back(layout);
+            moves.emplace_back(in_place.mutate(layout));
+        }
+        for (uz i = STEPS; i-- > 0;) {
+            in_place.undo(layout, moves[i]);
+            REQUIRE_EQ(layout, history[i]);
+        }
+        CHECK_EQ(layout, start);
+    }
+}
+
+TEST_CASE("test layout::Manager move operators") {
+    static constexpr uz STEPS = 1'000;
+
+    Manager manager;
+    manager.seed(11);
+    const Layout start = manager.create();
+
+    for (uz i = 0; i < NUM_OPERATORS; ++i) {
+        const auto op = static_cast<Operator>(i);
+
+        Layout layout = start;
+        std::vector<Move> moves;
+        std::vector<Layout> history;
+        for (uz step = 0; step < STEPS; ++step) {
+            history.emplace_back(layout);
+            const Move move = manager.mutate(layout, op);
+            REQUIRE_EQ(move.op, op);
+            REQUIRE_GE(move.num_swaps, 1);
+            REQUIRE(layout.valid());
+            REQUIRE(manager.canManage(layout));
+            moves.emplace_back(move);
+        }
+        for (uz step = STEPS; step-- > 0;) {
+            manager.undo(layout, moves[step]);
+            REQUIRE_EQ(layout, history[step]);
+        }
+    }
+}
+
+TEST_CASE("test layout::Manager::setOperatorWeights()") {
+    static constexpr OperatorWeights ONLY_SWAPS{1, 0, 0, 0, 0};
+
+    Manager manager;
+    CHECK_EQ(manager.operatorWeights(), ONLY_SWAPS);
+
+    CHECK_THROWS_AS((manager.setOperatorWeights(OperatorWeights{0, 0, 0, 0, 0})), std::invalid_argument);
+    CHECK_THROWS_AS((manager.setOperatorWeights(OperatorWeights{1, -1, 0, 0, 0})), std::invalid_argument);
+    CHECK_THROWS_AS((manager.setOperatorWeights(OperatorWeights{1, NAN, 0, 0, 0})), std::invalid_argument);
+    CHECK_EQ(manager.operatorWeights(), ONLY_SWAPS);
+
+    manager.setOperatorWeights({0, 1, 0, 0, 0});
+    Layout layout = manager.create();
+    CHECK_EQ(manager.mutate(layout).op, Operator::Cycle);
+
+    manager.setOperatorWeights({1, 1, 1, 1, 1});
+    std::array<uz, NUM_OPERATORS> counts{};
+    for (uz i = 0; i < 5'000; ++i) {
+        const Move move = manager.mutate(layout);
+        ++counts[static_cast<uz>(move.op)];
+        manager.undo(layout, move);
+    }
+    for (const uz count : counts) {
+        CHECK_GT(count, 800);
+    }
+}
+
+// Both tables of the key mappings describe the same assignment.
+template<Geometry G> static auto isConsistent(const BasicLayout<G> &layout) -> bool {
+    return std::ranges::all_of(BasicUtil<G>::POSITIONS, [&](const Position pos) {
+        return layout.getPos(layout.getVal(pos)) == pos;
+    });
+}
+
+template<Geometry G> static auto checkGeometry() -> void {
+    static constexpr uz STEPS = 1'000;
+
+    // A small area, the others keys in the default area (more than 32 keys).
+    const auto config = u8R"(
+        [[mutable_area]]
+        val = [",", ".", "/"]
+        pos = [0, 1, 2]
+    )"_toml;
+
+    BasicManager<G> manager{BasicConfig<G>(config)};
+    manager.seed(13);
+    manager.setOperatorWeights({1, 1, 1, 1, 1});
+
+    auto layout = manager.create();
+    REQUIRE(layout.valid());
+    REQUIRE(isConsistent(layout));
+    REQUIRE(manager.canManage(layout));
+    REQUIRE_EQ(layout.toStr().size(), G::KEY_COUNT);
+    CHECK_EQ(BasicLayout<G>(layout.toStr()), layout);
+
+    for (uz i = 0; i < STEPS; ++i) {
+        const auto before = layout;
+        const Move move = manager.mutate(layout);
+        REQUIRE(layout.valid());
+        REQUIRE(manager.canManage(layout));
+        if (i % 2 == 0) {
+            manager.undo(layout, move);
+            REQUIRE_EQ(layout, before);
+        }
+    }
+
+    for (uz i = 0; i < STEPS; ++i) {
+        manager.reinit(layout);
+        REQUIRE(layout.valid());
+        REQUIRE(isConsistent(layout));
+        REQUIRE(manager.canManage(layout));
+    }
+}
+
+TEST_CASE("test layout::BasicManager<Geometry40>") {
+    checkGeometry<Geometry40>();
+}
+
+TEST_CASE("test layout::BasicManager<GeometrySplit34>") {
+    checkGeometry<GeometrySplit34>();
+}
+
+TEST_CASE("test layout::Manager::state() and restore()") {
+    static constexpr uz STEPS = 1'000;
+
+    Manager original;
+    original.seed(2024);
+    Layout layout = original.create();
+    for (uz i = 0; i < STEPS; ++i) {
+        original.mutate(layout, layout);
+    }
+    const ManagerState state = original.state();
+    const Layout checkpoint = layout;
+
+    std::vector<Layout> expected;
+    for (uz i = 0; i < STEPS; ++i) {
+        original.mutate(layout, layout);
+        expected.emplace_back(layout);
+    }
+
+    SUBCASE("resume bit-exactly") {
+        Manager resumed;
+        resumed.restore(state);
+        layout = checkpoint;
+        for (uz i = 0; i < STEPS; ++i) {
+            resumed.mutate(layout, layout);
+            REQUIRE_EQ(layout, expected[i]);
+        }
+        CHECK_EQ(resumed.state().prng, original.state().prng);
+    }
+
+    SUBCASE("reject mismatched states") {
+        Manager other;
+        ManagerState bad = state;
+        bad.area_positions.pop_back();
+        CHECK_THROWS_AS(other.restore(bad), std::invalid_argument);
+
+        bad = state;
+        bad.area_positions.front().front() = 255;
+        CHECK_THROWS_AS(other.restore(bad), std::invalid_argument);
+    }
+}
+
 TEST_CASE("test reinit() and mutate() assertions") {
 
     // Generate a layout that conflicts with the manager.
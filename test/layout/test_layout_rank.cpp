@@ -0,0 +1,68 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_rank.hpp"
+
+namespace jianhan::v0::layout::tests {
+
+TEST_SUITE("Test layout::Ranker") {
+
+static const auto QWERTY = Layout(""
+    "QWERTYUIOP"
+    "ASDFGHJKL;"
+    "ZXCVBNM,./"
+);
+
+TEST_CASE("test layout::Ranker::rank()") {
+    const Ranker ranker;
+    REQUIRE_EQ(ranker.bits(), 108);
+
+    SUBCASE("first and last") {
+        const std::string first{KEY_CODES.begin(), KEY_CODES.end()};
+        const std::string last{KEY_CODES.rbegin(), KEY_CODES.rend()};
+        CHECK((ranker.rank(Layout(first)) == 0));
+        CHECK((ranker.rank(Layout(last)) == ranker.count() - 1));
+    }
+
+    SUBCASE("consistent with operator<=>") {
+        const Layout l1("ABCDEFGHIJKLMNOPQRSTUVWXYZ,./;");
+        const Layout l2("ABCDEFGHIJKLMNOPQRSTUVWXYZ,.;/");
+        const Layout l3("BCDEFGHIJKLMNOPQRSTUVWXYZA,.;/");
+        CHECK((ranker.rank(l1) < ranker.rank(l2)));
+        CHECK((ranker.rank(l2) < ranker.rank(l3)));
+    }
+}
+
+TEST_CASE("test layout::Ranker::unrank()") {
+
+    SUBCASE("whole layout") {
+        const Ranker ranker;
+        CHECK_EQ(ranker.unrank(ranker.rank(QWERTY)), QWERTY);
+
+        auto key_vals{KEY_CODES};
+        Prng prng(2024);
+        for (uz i = 0; i < 1'000; ++i) {
+            std::ranges::shuffle(key_vals, prng);
+            const Layout layout(std::string_view{
+                reinterpret_cast<const char *>(key_vals.data()), key_vals.size()
+            });
+            CHECK_EQ(ranker.unrank(ranker.rank(layout)), layout);
+        }
+    }
+
+    SUBCASE("relative to the areas of a manager") {
+        Manager manager;
+        const Ranker ranker(manager);
+        CHECK_LT(ranker.bits(), Ranker().bits());
+
+        for (uz i = 0; i < 1'000; ++i) {
+            const Layout layout = manager.create();
+            const Rank rank = ranker.rank(layout);
+            REQUIRE((rank < ranker.count()));
+            CHECK_EQ(ranker.unrank(rank), layout);
+        }
+    }
+}
+
+}
+
+}
@@ -0,0 +1,96 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_manager.hpp"
+#include "../../src/layout/layout_static.hpp"
+
+namespace jianhan::v0::layout::tests {
+
+TEST_SUITE("Test layout::StaticManager") {
+
+static constexpr StaticConfig<0, 30> ONE_AREA{
+    .fixed_keys{},
+    .vals = KEY_CODES,
+    .positions = POSITIONS,
+};
+
+static_assert(static_config::DEFAULT.valid());
+static_assert(ONE_AREA.valid());
+static_assert(not StaticConfig<0, 1, 29>{.fixed_keys{}, .vals = KEY_CODES, .positions = POSITIONS}.valid());
+static_assert(not StaticConfig<1, 30>{.fixed_keys{{{',', 0}}}, .vals = KEY_CODES, .positions = POSITIONS}.valid());
+static_assert(not ONE_AREA.valid<Geometry40>());
+
+// The same managers, given the same seed, create the same layouts.
+template<Geometry G> auto checkSameManagers(const BasicConfig<G> &lhs, const BasicConfig<G> &rhs) -> void {
+    BasicManager<G> expected(lhs), manager(rhs);
+    expected.seed(3), manager.seed(3);
+
+    auto expected_layout = expected.create();
+    auto layout = manager.create();
+    REQUIRE_EQ(layout, expected_layout);
+    for (uz i = 0; i < 1'000; ++i) {
+        const Move expected_move = expected.mutate(expected_layout);
+        const Move move = manager.mutate(layout);
+        REQUIRE_EQ(layout, expected_layout);
+        REQUIRE_EQ(move.area, expected_move.area);
+    }
+}
+
+TEST_CASE("test layout::StaticManager matches layout::Manager") {
+    static constexpr uz STEPS = 1'000;
+
+    Manager dynamic(Config(default_config::toml()));
+    StaticManager<static_config::DEFAULT> fixed;
+    dynamic.seed(9), fixed.seed(9);
+
+    Layout expected = dynamic.create();
+    Layout layout = fixed.create();
+    REQUIRE_EQ(layout, expected);
+    REQUIRE(fixed.canManage(layout));
+
+    for (uz i = 0; i < STEPS; ++i) {
+        const Move expected_move = dynamic.mutate(expected);
+        const Move move = fixed.mutate(layout);
+        REQUIRE_EQ(layout, expected);
+        REQUIRE_EQ(move.area, expected_move.area);
+    }
+
+    dynamic.reinit(expected), fixed.reinit(layout);
+    CHECK_EQ(layout, expected);
+
+    const Layout before = layout;
+    const Move move = fixed.mutate(layout);
+    fixed.undo(layout, move);
+    CHECK_EQ(layout, before);
+}
+
+TEST_CASE("test layout::StaticManager with a single area") {
+    StaticManager<ONE_AREA> manager;
+    Layout parent = manager.create();
+    Layout child = manager.create();
+    for (uz i = 0; i < 100; ++i) {
+        manager.mutate(child, parent);
+        REQUIRE(child.valid());
+        REQUIRE(manager.canManage(child));
+        REQUIRE_NE(child, parent);
+        parent = child;
+    }
+}
+
+TEST_CASE("test layout::Config::fromStatic()") {
+    using namespace toml::literals::toml_literals;
+
+    checkSameManagers(Config(default_config::toml()), Config::fromStatic<static_config::DEFAULT>());
+    checkSameManagers(Config(u8R"()"_toml), Config::fromStatic<ONE_AREA>());
+}
+
+TEST_CASE("test layout::Config::allMutable()") {
+    using namespace toml::literals::toml_literals;
+
+    checkSameManagers(Config(u8R"()"_toml), Config::allMutable());
+    checkSameManagers(BasicConfig<Geometry40>(u8R"()"_toml), BasicConfig<Geometry40>::allMutable());
+    checkSameManagers(BasicConfig<GeometrySplit34>(u8R"()"_toml), BasicConfig<GeometrySplit34>::allMutable());
+}
+
+}
+
+}
@@ -0,0 +1,62 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_manager.hpp"
+#include "../../src/score/score.hpp"
+
+namespace jianhan::v0::score::tests {
+
+TEST_SUITE("Test score::Evaluator") {
+
+static const auto QWERTY = Layout(""
+    "QWERTYUIOP"
+    "ASDFGHJKL;"
+    "ZXCVBNM,./"
+);
+
+TEST_CASE("test score::Evaluator construction") {
+    REQUIRE_NOTHROW((Evaluator({{'Q', 'W', 1.0f}}, gridDistanceCosts())));
+    REQUIRE_THROWS_AS((Evaluator({{'Q', '1', 1.0f}}, gridDistanceCosts())), std::invalid_argument);
+    REQUIRE_THROWS_AS((Evaluator({{'Q', 'W', -1.0f}}, gridDistanceCosts())), std::invalid_argument);
+}
+
+TEST_CASE("test score::Evaluator::score()") {
+    const Evaluator evaluator({
+        {'Q', 'W', 2.0f}, // distance 1
+        {'Q', 'Z', 1.0f}, // distance 2
+        {'P', 'A', 0.5f}, // distance 10
+    }, gridDistanceCosts());
+
+    REQUIRE_EQ(evaluator.size(), 3);
+    CHECK_EQ(evaluator.cost(QWERTY, 0), 2.0f);
+    CHECK_EQ(evaluator.cost(QWERTY, 1), 2.0f);
+    CHECK_EQ(evaluator.cost(QWERTY, 2), 5.0f);
+    CHECK_EQ(evaluator.score(QWERTY), 9.0f);
+}
+
+TEST_CASE("test score::Evaluator::delta()") {
+    static constexpr uz STEPS = 500;
+
+    Prng prng(3);
+    std::vector<Bigram> bigrams;
+    for (const KeyValue first : QWERTY.toStr()) {
+        for (const KeyValue second : QWERTY.toStr()) {
+            bigrams.push_back({first, second, std::uniform_real_distribution<fz>(0, 1)(prng)});
+        }
+    }
+    const Evaluator evaluator(std::move(bigrams), gridDistanceCosts());
+
+    layout::Manager manager;
+    manager.seed(3);
+    manager.setOperatorWeights({1, 1, 1, 1, 1});
+    Layout layout = manager.create();
+    for (uz i = 0; i < STEPS; ++i) {
+        const fz before = evaluator.score(layout);
+        const layout::Move move = manager.mutate(layout);
+        const fz after = evaluator.score(layout);
+        REQUIRE_LE(std::abs(evaluator.delta(layout, move) - (after - before)), 1e-5f * before);
+    }
+}
+
+}
+
+}
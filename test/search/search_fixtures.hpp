@@ -0,0 +1,18 @@
+#ifndef JIANHAN_TEST_SEARCH_FIXTURES_HPP
+#define JIANHAN_TEST_SEARCH_FIXTURES_HPP
+
+#include "../../src/score/score.hpp"
+
+namespace jianhan::v0::search::tests {
+
+// A toy corpus, whose best score with grid distance costs is 10:
+// every bigram on neighbouring keys.
+inline auto toyBigrams() -> std::vector<score::Bigram> {
+    return {{'T', 'H', 3.0f}, {'H', 'E', 2.5f}, {'A', 'N', 2.0f}, {'I', 'N', 1.5f}, {'E', 'R', 1.0f}};
+}
+
+inline const score::Evaluator TOY_EVALUATOR(toyBigrams(), score::gridDistanceCosts());
+
+}
+
+#endif // JIANHAN_TEST_SEARCH_FIXTURES_HPP
@@ -0,0 +1,59 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_anneal.hpp"
+#include "search_fixtures.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Annealer") {
+
+TEST_CASE("test search::Annealer construction") {
+    REQUIRE_NOTHROW((Annealer(TOY_EVALUATOR, {.num_steps = 10})));
+    REQUIRE_NOTHROW((Annealer(TOY_EVALUATOR, {.num_steps = 10, .start_temperature = 1, .end_temperature = 1})));
+    CHECK_THROWS_AS((Annealer(TOY_EVALUATOR, {.num_steps = 10, .start_temperature = 1})), std::invalid_argument);
+    CHECK_THROWS_AS((Annealer(TOY_EVALUATOR, {.num_steps = 10, .start_temperature = 1, .end_temperature = 2})),
+                    std::invalid_argument);
+}
+
+TEST_CASE("test search::Annealer::run()") {
+    const std::atomic<bool> stop{false};
+
+    auto anneal = [&](const AnnealOptions &options) -> AnnealResult {
+        layout::Manager manager;
+        manager.seed(5);
+        Prng prng(6);
+        return Annealer(TOY_EVALUATOR, options).run(manager, prng, stop);
+    };
+
+    const AnnealResult climbed = anneal({.num_steps = 5'000});
+    CHECK_EQ(climbed.moves, 5'000);
+    CHECK_LE(climbed.accepted, climbed.moves);
+    CHECK_EQ(climbed.score, TOY_EVALUATOR.score(climbed.best));
+    CHECK_LT(climbed.score, 15.0f); // 10 with every bigram on neighbouring keys
+
+    const AnnealResult annealed = anneal({.num_steps = 5'000, .start_temperature = 2, .end_temperature = 0.01});
+    CHECK_LT(std::abs(annealed.score - 10.0f), 1e-4f);
+    CHECK_GT(annealed.accepted, climbed.accepted); // uphill moves too
+
+    SUBCASE("deadline") {
+        const AnnealResult late = anneal({.num_steps = 5'000, .deadline = std::chrono::steady_clock::now()});
+        CHECK_EQ(late.moves, 0);
+    }
+
+    SUBCASE("adaptive selection") {
+        layout::Manager manager;
+        manager.seed(5);
+        Prng prng(6);
+        const auto priors = manager.areaProbabilities();
+        const AnnealResult adaptive = Annealer(TOY_EVALUATOR, {
+            .num_steps = 5'000, .start_temperature = 2, .end_temperature = 0.01,
+            .adaptive = layout::BanditOptions{.period = 64},
+        }).run(manager, prng, stop);
+        CHECK_LT(std::abs(adaptive.score - 10.0f), 1e-4f);
+        CHECK_NE(manager.areaProbabilities(), priors); // learned from the rewards
+    }
+}
+
+}
+
+}
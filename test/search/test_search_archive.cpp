@@ -0,0 +1,102 @@
+#include <doctest/doctest.h>
+#include <omp.h>
+
+#include "../../src/layout/layout_manager.hpp"
+#include "../../src/search/search_archive.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::EliteArchive") {
+
+static auto makeLayouts(const uz num_layouts) -> std::vector<Layout> {
+    layout::Manager manager;
+    std::vector<Layout> layouts;
+    for (uz i = 0; i < num_layouts; ++i) {
+        layouts.emplace_back(manager.create());
+    }
+    return layouts;
+}
+
+static auto scoreOf(const Layout &layout) -> fz {
+    return static_cast<fz>(layout.hash() % 10'000);
+}
+
+TEST_CASE("test search::EliteArchive::insert()") {
+    static constexpr uz K = 8;
+
+    const std::vector<Layout> layouts = makeLayouts(100);
+    EliteArchive archive(K);
+    REQUIRE_EQ(archive.threshold(), EliteArchive::INF);
+
+    SUBCASE("keep the top K") {
+        for (const Layout &layout : layouts) {
+            archive.insert(layout, scoreOf(layout));
+        }
+        REQUIRE_EQ(archive.size(), K);
+
+        std::vector<fz> scores;
+        for (const Layout &layout : layouts) {
+            scores.emplace_back(scoreOf(layout));
+        }
+        std::ranges::sort(scores);
+
+        const auto elites = archive.snapshot();
+        for (uz i = 0; i < K; ++i) {
+            CHECK_EQ((*elites)[i].score, scores[i]);
+        }
+        CHECK_EQ(archive.threshold(), scores[K - 1]);
+    }
+
+    SUBCASE("reject duplicates") {
+        CHECK(archive.insert(layouts[0], 1.0f));
+        CHECK_FALSE(archive.insert(layouts[0], 1.0f));
+        CHECK_EQ(archive.size(), 1);
+    }
+
+    SUBCASE("reject worse than the K-th best") {
+        for (uz i = 0; i < K; ++i) {
+            REQUIRE(archive.insert(layouts[i], 1.0f));
+        }
+        CHECK_FALSE(archive.insert(layouts[K], 2.0f));
+        CHECK(archive.insert(layouts[K], 0.5f));
+        CHECK_EQ(archive.snapshot()->front().layout, layouts[K]);
+    }
+
+    SUBCASE("snapshots are immutable") {
+        archive.insert(layouts[0], 1.0f);
+        const auto before = archive.snapshot();
+        archive.insert(layouts[1], 0.5f);
+        CHECK_EQ(before->size(), 1);
+        CHECK_EQ(archive.snapshot()->size(), 2);
+    }
+}
+
+TEST_CASE("test search::EliteArchive concurrent insertions") {
+    static constexpr uz K = 16;
+    static constexpr uz NUM_LAYOUTS = 2'000;
+
+    const std::vector<Layout> layouts = makeLayouts(NUM_LAYOUTS);
+
+    EliteArchive sequential(K);
+    for (const Layout &layout : layouts | std::views::reverse) {
+        sequential.insert(layout, scoreOf(layout));
+    }
+
+    EliteArchive concurrent(K);
+#pragma omp parallel for default(shared)
+    for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+        concurrent.insert(layouts[i], scoreOf(layouts[i]));
+    }
+
+    // The content of the archive does not depend on the insertion order.
+    const auto expected = sequential.snapshot();
+    const auto actual = concurrent.snapshot();
+    REQUIRE_EQ(actual->size(), K);
+    for (uz i = 0; i < K; ++i) {
+        CHECK_EQ((*actual)[i].layout, (*expected)[i].layout);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,93 @@
+#include <doctest/doctest.h>
+#include <omp.h>
+
+#include "../../src/layout/layout_manager.hpp"
+#include "../../src/search/search_cache.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::ScoreCache") {
+
+TEST_CASE("test search::ScoreCache construction") {
+    CHECK_GE(ScoreCache(1).capacity(), 1);
+    CHECK_GE(ScoreCache(1000).capacity(), 1000);
+}
+
+TEST_CASE("test search::ScoreCache::find() and insert()") {
+    ScoreCache cache(64);
+
+    SUBCASE("miss") {
+        CHECK_FALSE(cache.find(42).has_value());
+    }
+
+    SUBCASE("hit") {
+        cache.insert(42, 1.5f);
+        REQUIRE(cache.find(42).has_value());
+        CHECK_EQ(*cache.find(42), 1.5f);
+    }
+
+    SUBCASE("overwrite") {
+        cache.insert(42, 1.5f);
+        cache.insert(42, 2.5f);
+        CHECK_EQ(*cache.find(42), 2.5f);
+    }
+
+    SUBCASE("clear") {
+        cache.insert(42, 1.5f);
+        cache.clear();
+        CHECK_FALSE(cache.find(42).has_value());
+    }
+}
+
+TEST_CASE("test search::ScoreCache eviction") {
+
+    // Keys colliding in the same bucket: the most recently
+    // referenced ones should survive the eviction.
+
+    ScoreCache cache(1);
+    const uz ways = cache.capacity();
+    for (uint64_t key = 1; key <= ways; ++key) {
+        cache.insert(key, static_cast<fz>(key));
+    }
+    for (uint64_t key = 1; key <= ways; ++key) {
+        REQUIRE(cache.find(key).has_value());
+    }
+
+    cache.insert(ways + 1, 0.0f);
+    REQUIRE(cache.find(ways + 1).has_value());
+
+    uz num_found = 0;
+    for (uint64_t key = 1; key <= ways; ++key) {
+        num_found += cache.find(key).has_value();
+    }
+    CHECK_EQ(num_found, ways - 1);
+}
+
+TEST_CASE("test search::ScoreCache concurrent use") {
+    static constexpr uz NUM_LAYOUTS = 1'000;
+
+    layout::Manager manager;
+    std::vector<Layout> layouts;
+    for (uz i = 0; i < NUM_LAYOUTS; ++i) {
+        layouts.emplace_back(manager.create());
+    }
+
+    auto evaluate = [](const Layout &layout) -> fz {
+        return static_cast<fz>(layout.hash() % 1'000);
+    };
+
+    ScoreCache cache(NUM_LAYOUTS * 4);
+    uz num_wrong = 0;
+#pragma omp parallel for reduction(+:num_wrong) default(shared)
+    for (uz i = 0; i < NUM_LAYOUTS * 8; ++i) {
+        const Layout &layout = layouts[i % NUM_LAYOUTS];
+        if (cache.findOrEvaluate(layout, evaluate) != evaluate(layout)) {
+            ++num_wrong;
+        }
+    }
+    CHECK_EQ(num_wrong, 0);
+}
+
+}
+
+}
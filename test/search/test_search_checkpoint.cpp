@@ -0,0 +1,156 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_checkpoint.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Checkpoint") {
+
+static auto tmpPath(const std::string_view name) -> std::filesystem::path {
+    return std::filesystem::temp_directory_path() / fmt::format("jianhan_{}_{}", name, ::getpid());
+}
+
+// A toy annealing search: mutate, accept with a probability
+// drawn from its own PRNG, cool down, record the elites.
+struct ToySearch final {
+    layout::Manager manager{};
+    Prng acceptance{7};
+    SearchState state{};
+    EliteArchive archive{8};
+
+    ToySearch() {
+        manager.seed(2024);
+        state.temperature = 1;
+        const Layout layout = manager.create();
+        state.populations.push_back({{layout}, {score(layout)}});
+    }
+
+    static auto score(const Layout &layout) -> fz {
+        return static_cast<fz>(layout.hash() % 10'000);
+    }
+
+    auto step() -> void {
+        Population &population = state.populations[0];
+        Layout candidate = population.layouts[0];
+        manager.mutate(candidate, population.layouts[0]);
+        const fz s = score(candidate);
+        const f64 u = static_cast<f64>(acceptance() >> 11) * 0x1.0p-53;
+        if (s < population.scores[0] or u < state.temperature * 0.5) {
+            population.layouts[0] = candidate;
+            population.scores[0] = s;
+        }
+        archive.insert(candidate, s);
+        state.temperature *= 0.999;
+        ++state.iteration;
+    }
+
+    auto capture() -> SearchState {
+        state.elites = *archive.snapshot();
+        state.managers = {manager.state()};
+        state.prngs = {acceptance.state()};
+        return state;
+    }
+
+    auto resume(SearchState saved) -> void {
+        state = std::move(saved);
+        manager.restore(state.managers[0]);
+        acceptance.setState(state.prngs[0]);
+        for (const Elite &elite : state.elites) {
+            archive.insert(elite.layout, elite.score);
+        }
+    }
+};
+
+TEST_CASE("test search::Checkpoint::serialize() and deserialize()") {
+    ToySearch search;
+    for (uz i = 0; i < 500; ++i) { search.step(); }
+    const SearchState state = search.capture();
+
+    std::vector<std::byte> bytes;
+    Checkpoint::serialize(state, bytes);
+    const SearchState loaded = Checkpoint::deserialize(bytes);
+
+    CHECK_EQ(loaded.iteration, state.iteration);
+    CHECK_EQ(loaded.temperature, state.temperature);
+    REQUIRE_EQ(loaded.populations.size(), 1);
+    CHECK_EQ(loaded.populations[0].layouts, state.populations[0].layouts);
+    CHECK_EQ(loaded.populations[0].scores, state.populations[0].scores);
+    REQUIRE_EQ(loaded.elites.size(), state.elites.size());
+    for (uz i = 0; i < state.elites.size(); ++i) {
+        CHECK_EQ(loaded.elites[i].layout, state.elites[i].layout);
+        CHECK_EQ(loaded.elites[i].score, state.elites[i].score);
+        CHECK_EQ(loaded.elites[i].hash, state.elites[i].hash);
+    }
+    CHECK_EQ(loaded.managers[0].prng, state.managers[0].prng);
+    CHECK_EQ(loaded.managers[0].area_positions, state.managers[0].area_positions);
+    CHECK_EQ(loaded.prngs, state.prngs);
+
+    SUBCASE("corrupted data") {
+        auto corrupted = bytes;
+        corrupted.back() ^= std::byte{1};
+        CHECK_THROWS_AS(std::ignore = Checkpoint::deserialize(corrupted), std::runtime_error);
+
+        auto truncated = std::span(bytes).first(bytes.size() - 1);
+        CHECK_THROWS_AS(std::ignore = Checkpoint::deserialize(truncated), std::runtime_error);
+
+        auto bad_magic = bytes;
+        bad_magic[0] = std::byte{'X'};
+        CHECK_THROWS_AS(std::ignore = Checkpoint::deserialize(bad_magic), std::runtime_error);
+    }
+}
+
+TEST_CASE("test search::CheckpointWriter resume") {
+    static constexpr uz STEPS = 2'000;
+    const auto path = tmpPath("checkpoint");
+
+    ToySearch uninterrupted;
+    {
+        CheckpointWriter writer(path);
+        for (uz i = 0; i < STEPS; ++i) {
+            uninterrupted.step();
+            if (i % 100 == 99) { writer.save(uninterrupted.capture()); }
+        }
+        writer.close();
+        CHECK_GT(writer.numWritten(), 0);
+        CHECK_EQ(writer.numWritten() + writer.numSuperseded(), STEPS / 100);
+        CHECK_NOTHROW(writer.close());
+    }
+    for (uz i = 0; i < STEPS; ++i) { uninterrupted.step(); }
+
+    // "Preempted" after the last checkpoint, then resumed from the file.
+    ToySearch resumed;
+    resumed.resume(Checkpoint::load(path));
+    REQUIRE_EQ(resumed.state.iteration, STEPS);
+    for (uz i = 0; i < STEPS; ++i) { resumed.step(); }
+
+    const SearchState lhs = uninterrupted.capture(), rhs = resumed.capture();
+    CHECK_EQ(lhs.iteration, rhs.iteration);
+    CHECK_EQ(lhs.temperature, rhs.temperature);
+    CHECK_EQ(lhs.populations[0].layouts, rhs.populations[0].layouts);
+    CHECK_EQ(lhs.managers[0].prng, rhs.managers[0].prng);
+    CHECK_EQ(lhs.prngs, rhs.prngs);
+    REQUIRE_EQ(lhs.elites.size(), rhs.elites.size());
+    for (uz i = 0; i < lhs.elites.size(); ++i) {
+        CHECK_EQ(lhs.elites[i].layout, rhs.elites[i].layout);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("test search::CheckpointWriter errors") {
+    CheckpointWriter writer(tmpPath("missing-directory") / "checkpoint");
+    writer.save(ToySearch().capture());
+    CHECK_THROWS_AS(writer.close(), std::system_error);
+    CHECK_EQ(writer.numWritten(), 0);
+
+    // A checkpoint cannot replace a directory, nor leave its temporary file.
+    const std::filesystem::path directory = tmpPath("directory");
+    std::filesystem::create_directory(directory);
+    CHECK_THROWS_AS(Checkpoint::save(directory, ToySearch().capture()), std::system_error);
+    CHECK_FALSE(std::filesystem::exists(directory.string() + ".tmp"));
+    std::filesystem::remove(directory);
+}
+
+}
+
+}
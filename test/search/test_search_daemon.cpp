@@ -0,0 +1,124 @@
+#include <doctest/doctest.h>
+
+#include <set>
+#include <unistd.h>
+
+#include "../../src/search/search_daemon.hpp"
+#include "search_fixtures.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Daemon") {
+
+static auto socketPath() -> std::string {
+    return fmt::format("/tmp/jianhan-test-{:d}.sock", ::getpid());
+}
+
+TEST_CASE("test search::Daemon jobs") {
+    Daemon daemon(std::make_shared<const score::Evaluator>(toyBigrams(), score::gridDistanceCosts()),
+                  {.path = socketPath(), .num_workers = 3});
+
+    const JobRequest request{
+        .job_id = 1, .seed = 9, .num_restarts = 6, .num_steps = 2'000, .num_elites = 3,
+        .start_temperature = 2, .end_temperature = 0.01,
+    };
+
+    DaemonClient client(socketPath());
+    uz num_progress = 0;
+    const JobResult result = client.run(request, [&](const JobProgress &progress) -> void {
+        CHECK_EQ(progress.job_id, 1);
+        CHECK_EQ(progress.total, 6);
+        CHECK_EQ(progress.completed, ++num_progress);
+    });
+    CHECK_EQ(num_progress, 6);
+    REQUIRE_EQ(result.elites.size(), 3);
+    CHECK(result.error.empty());
+    CHECK_LT(result.elites.front().score, 15.0f);
+
+    // Same result from another client, whatever the order of the restarts.
+    DaemonClient other(socketPath());
+    const JobResult again = other.run(request);
+    REQUIRE_EQ(again.elites.size(), 3);
+    for (uz i = 0; i < 3; ++i) {
+        CHECK_EQ(again.elites[i].layout, result.elites[i].layout);
+        CHECK_EQ(again.elites[i].score, result.elites[i].score);
+    }
+
+    SUBCASE("configurations") {
+        JobRequest fixed = request;
+        fixed.config = "[[fixed_key]]\nval = \"T\"\npos = 29\n";
+        for (uint32_t job_id = 2; job_id < 4; ++job_id) {
+            fixed.job_id = job_id;
+            for (const Elite &elite : client.run(fixed).elites) {
+                CHECK_EQ(elite.layout.getVal(29), 'T');
+            }
+        }
+        CHECK_EQ(daemon.numCachedConfigs(), 1);
+
+        fixed.config = "[[fixed_key]]\nval = \"T\"\npos = 40\n"; // no such position
+        CHECK_THROWS_AS(client.run(fixed), std::runtime_error);
+        fixed.config.clear();
+        fixed.num_restarts = 0;
+        CHECK_THROWS_AS(client.run(fixed), std::runtime_error);
+    }
+
+    SUBCASE("pipelined jobs") {
+        for (uint32_t job_id = 10; job_id < 13; ++job_id) {
+            JobRequest pipelined = request;
+            pipelined.job_id = job_id;
+            client.submit(pipelined);
+        }
+        std::set<uint32_t> finished;
+        while (finished.size() < 3) {
+            const JobReply reply = client.receive();
+            if (const auto *finished_job = std::get_if<JobResult>(&reply)) {
+                CHECK_EQ(finished_job->elites.front().score, result.elites.front().score);
+                finished.insert(finished_job->job_id);
+            }
+        }
+        CHECK((finished == std::set<uint32_t>{10, 11, 12}));
+        CHECK_GE(daemon.numCompletedJobs(), 5);
+    }
+
+    SUBCASE("a long job") {
+        DaemonClient busy(socketPath());
+        JobRequest long_job = request;
+        long_job.job_id = 30;
+        long_job.num_restarts = 1'000'000; // hours of restarts
+        busy.submit(long_job);
+
+        JobRequest other = request;
+        other.job_id = 31;
+        CHECK_EQ(client.run(other).elites.front().score, result.elites.front().score);
+    }
+
+    SUBCASE("a client that does not read") {
+        {
+            DaemonClient flooding(socketPath());
+            JobRequest flood = request;
+            flood.job_id = 20;
+            flood.num_restarts = 50'000; // progress frames beyond the socket buffer
+            flood.num_steps = 1;
+            flood.start_temperature = flood.end_temperature = 0;
+            flooding.submit(flood);
+
+            JobRequest other = request;
+            other.job_id = 21;
+            CHECK_EQ(client.run(other).elites.front().score, result.elites.front().score);
+            CHECK_EQ(daemon.numConnections(), 3);
+        }
+
+        // Its connection is released without waiting for another client.
+        for (int i = 0; i < 500 and daemon.numConnections() > 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CHECK_EQ(daemon.numConnections(), 2);
+    }
+
+    daemon.stop();
+    CHECK_THROWS_AS((DaemonClient(socketPath())), std::runtime_error);
+}
+
+}
+
+}
@@ -0,0 +1,75 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_deterministic.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::DeterministicRun") {
+
+TEST_CASE("test search::streamSeed()") {
+    CHECK_EQ(streamSeed(42, 7), streamSeed(42, 7, 0));
+    CHECK_NE(streamSeed(42, 7), streamSeed(43, 7));
+    CHECK_NE(streamSeed(42, 7), streamSeed(42, 8));
+    CHECK_NE(streamSeed(42, 7, 0), streamSeed(42, 7, 1));
+    CHECK_NE(streamSeed(42, 7, 1), streamSeed(42, 8, 0));
+}
+
+// Random walk with a hash-based score and a PRNG-driven acceptance.
+static auto walk(layout::Manager &manager, Item &item) -> void {
+    Layout current = manager.create();
+    Layout candidate = current;
+    for (uz i = 0; i < 500 + item.id() % 13 * 50; ++i) {
+        manager.mutate(candidate, current);
+        const auto score = static_cast<fz>(candidate.hash() % 100'000);
+        item.offer(candidate, score);
+        if (item.prng()() % 4 != 0) {
+            current = candidate;
+        }
+    }
+}
+
+TEST_CASE("test search::DeterministicRun::run()") {
+    static constexpr uz NUM_ITEMS = 40;
+
+    const DeterministicOptions options{.num_items = NUM_ITEMS, .seed = 2024, .num_elites = 10};
+    auto run = [&options](const uz num_workers) -> Elites {
+        Scheduler scheduler(num_workers);
+        return DeterministicRun(options).run(scheduler, walk);
+    };
+
+    const Elites expected = run(1);
+    REQUIRE_EQ(expected.size(), 10);
+    CHECK(std::ranges::is_sorted(expected, {}, &Elite::score));
+
+    for (const uz num_workers : {2, 3, 8}) {
+        const Elites elites = run(num_workers);
+        REQUIRE_EQ(elites.size(), expected.size());
+        for (uz i = 0; i < elites.size(); ++i) {
+            CHECK_EQ(elites[i].layout, expected[i].layout);
+            CHECK_EQ(elites[i].score, expected[i].score);
+        }
+    }
+
+    SUBCASE("the seed matters") {
+        DeterministicOptions other = options;
+        other.seed = 2025;
+        Scheduler scheduler(2);
+        const Elites elites = DeterministicRun(other).run(scheduler, walk);
+        CHECK_NE(elites.front().layout, expected.front().layout);
+    }
+
+    SUBCASE("the scheduler must have no queued restarts") {
+        Scheduler scheduler(2);
+        scheduler.submit({.id = 1'000, .seed = 1});
+        CHECK_EQ(scheduler.numQueued(), 1);
+        CHECK_THROWS_AS(DeterministicRun(options).run(scheduler, walk), std::invalid_argument);
+
+        scheduler.run([](Worker &, const Restart &) -> void {});
+        CHECK_EQ(scheduler.numQueued(), 0);
+        CHECK_EQ(DeterministicRun(options).run(scheduler, walk).size(), 10); // reused
+    }
+}
+
+}
+
+}
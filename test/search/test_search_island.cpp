@@ -0,0 +1,141 @@
+#include <doctest/doctest.h>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../src/search/search_island.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::IslandLink") {
+
+static auto options(const std::string_view name, const uz capacity = 8) -> IslandOptions {
+    return {
+        .name = fmt::format("/jianhan-test-{}-{}", name, ::getpid()),
+        .num_islands = 3,
+        .mailbox_capacity = capacity,
+    };
+}
+
+TEST_CASE("test search::IslandLink::send() and receive()") {
+    const IslandOptions opts = options("local");
+    IslandLink island_0(opts, 0), island_1(opts, 1);
+    REQUIRE(island_0.isReady(1));
+    REQUIRE_FALSE(island_0.isReady(2));
+
+    layout::Manager manager;
+    const Layout layout = manager.create();
+
+    SUBCASE("migrants keep their layout, score and origin") {
+        CHECK(island_0.send(1, layout, 1.5f));
+        CHECK_FALSE(island_0.send(2, layout, 1.5f)); // island 2 not attached
+
+        const auto migrant = island_1.receive();
+        REQUIRE(migrant.has_value());
+        CHECK_EQ(migrant->layout, layout);
+        CHECK_EQ(migrant->score, 1.5f);
+        CHECK_EQ(migrant->from, 0);
+        CHECK_FALSE(island_1.receive().has_value());
+        CHECK_FALSE(island_0.receive().has_value());
+    }
+
+    SUBCASE("bounded mailbox") {
+        for (uz i = 0; i < 8; ++i) {
+            REQUIRE(island_1.send(0, layout, static_cast<fz>(i)));
+        }
+        CHECK_FALSE(island_1.send(0, layout, 8));
+        for (uz i = 0; i < 8; ++i) {
+            CHECK_EQ(island_0.receive()->score, static_cast<fz>(i));
+        }
+    }
+
+    SUBCASE("broadcast") {
+        IslandLink island_2(opts, 2);
+        CHECK_EQ(island_2.broadcast(layout, 3), 2);
+        CHECK_EQ(island_0.receive()->from, 2);
+        CHECK_EQ(island_1.receive()->from, 2);
+        CHECK_FALSE(island_2.receive().has_value());
+    }
+
+    SUBCASE("mismatched options") {
+        IslandOptions other = opts;
+        other.mailbox_capacity = 1024;
+        CHECK_THROWS_AS(IslandLink(other, 2), std::runtime_error);
+        CHECK_THROWS_AS(IslandLink(opts, 3), std::runtime_error);
+    }
+}
+
+TEST_CASE("test search::IslandLink attachment") {
+    IslandOptions opts = options("attach");
+
+    SUBCASE("the last link removes the segment") {
+        {
+            IslandLink island_0(opts, 0);
+            IslandLink island_1(opts, 1);
+        }
+        const int fd = ::shm_open(opts.name.c_str(), O_RDWR, 0600);
+        CHECK_LT(fd, 0);
+        IslandLink island_0(opts, 0); // a new segment
+        CHECK_FALSE(island_0.isReady(1));
+    }
+
+    SUBCASE("bounded wait for the segment lock") {
+        IslandLink island_0(opts, 0);
+        const int fd = ::shm_open(opts.name.c_str(), O_RDWR, 0600);
+        REQUIRE_GE(fd, 0);
+        REQUIRE_EQ(::flock(fd, LOCK_EX), 0);
+        opts.attach_timeout = std::chrono::milliseconds(20);
+        CHECK_THROWS_AS(IslandLink(opts, 1), std::runtime_error);
+        ::close(fd);
+        CHECK_NOTHROW(IslandLink(opts, 1));
+    }
+}
+
+TEST_CASE("test search::IslandLink across processes") {
+    static constexpr uz NUM_MIGRANTS = 1'000;
+
+    const IslandOptions opts = options("fork", 64);
+    IslandLink island_0(opts, 0);
+
+    const pid_t pid = ::fork();
+    REQUIRE_GE(pid, 0);
+    if (pid == 0) {
+        // child: island 1 sends its layouts, sorted by score
+        int status = 0;
+        {
+            IslandLink island_1(opts, 1);
+            layout::Manager manager;
+            manager.seed(1);
+            for (uz i = 0; i < NUM_MIGRANTS; ++i) {
+                const Layout layout = manager.create();
+                while (not island_1.send(0, layout, static_cast<fz>(i))) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        ::_exit(status);
+    }
+
+    layout::Manager manager;
+    manager.seed(1);
+    uz num_wrong = 0;
+    for (uz i = 0; i < NUM_MIGRANTS;) {
+        if (const auto migrant = island_0.receive()) {
+            num_wrong += migrant->layout != manager.create();
+            num_wrong += migrant->score != static_cast<fz>(i++);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    CHECK_EQ(status, 0);
+    CHECK_EQ(num_wrong, 0);
+}
+
+}
+
+}
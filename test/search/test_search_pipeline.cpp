@@ -0,0 +1,61 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_pipeline.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Pipeline") {
+
+static auto evaluate(const Layout &layout) -> fz {
+    return static_cast<fz>(layout.hash() % 1'000);
+}
+
+TEST_CASE("test search::Pipeline::defaultBatchSize()") {
+    const uz batch_size = Pipeline::defaultBatchSize();
+    CHECK_GE(batch_size, 16);
+    CHECK_LE(batch_size * sizeof(Layout), 64 * 1024 * 1024);
+}
+
+TEST_CASE("test search::Pipeline::run()") {
+    static constexpr uz NUM_BATCHES = 50;
+
+    Pipeline pipeline({
+        .num_generators = 2,
+        .num_evaluators = 2,
+        .batch_size = 64,
+    });
+    REQUIRE_EQ(pipeline.batchSize(), 64);
+
+    const Layout parent = layout::Manager().create();
+    auto generate = [&parent](layout::Manager &manager, Batch &batch) -> void {
+        for (Layout &layout : batch.layouts) {
+            manager.mutate(layout, parent);
+        }
+    };
+
+    uz num_selected = 0;
+    uz num_wrong = 0;
+    auto select = [&](const Batch &batch) -> bool {
+        for (uz i = 0; i < batch.layouts.size(); ++i) {
+            num_wrong += batch.scores[i] != evaluate(batch.layouts[i]);
+            num_wrong += not batch.layouts[i].valid();
+        }
+        return ++num_selected < NUM_BATCHES;
+    };
+
+    for (uz round = 0; round < 2; ++round) {
+        num_selected = 0;
+        const auto stats = pipeline.run(generate, evaluate, select);
+
+        CHECK_EQ(num_wrong, 0);
+        CHECK_EQ(stats.select.batches, NUM_BATCHES);
+        CHECK_GE(stats.generate.batches, NUM_BATCHES);
+        CHECK_GE(stats.evaluate.batches, NUM_BATCHES);
+        CHECK_EQ(stats.select.layouts, NUM_BATCHES * 64);
+        CHECK_GT(stats.generate.throughput(), 0);
+    }
+}
+
+}
+
+}
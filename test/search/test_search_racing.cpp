@@ -0,0 +1,89 @@
+#include <doctest/doctest.h>
+
+#include "../../src/layout/layout_manager.hpp"
+#include "../../src/search/search_racing.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Racing") {
+
+static auto makeEvaluator(const uz num_bigrams) -> score::Evaluator {
+    Prng prng(2024);
+    std::uniform_int_distribution<uz> key(0, KEY_COUNT - 1);
+    std::uniform_real_distribution<fz> unit(0.0f, 1.0f);
+
+    // Zipf-like frequencies, as observed in real corpora
+    std::vector<score::Bigram> bigrams;
+    for (uz i = 0; i < num_bigrams; ++i) {
+        const fz freq = 1.0f / static_cast<fz>(i + 1);
+        bigrams.emplace_back(KEY_CODES[key(prng)], KEY_CODES[key(prng)], freq);
+    }
+
+    score::CostMatrix costs{};
+    for (fz &cost : costs) {
+        cost = unit(prng);
+    }
+    return {std::move(bigrams), costs};
+}
+
+static auto makeCandidates(const uz num_candidates) -> std::vector<Layout> {
+    layout::Manager manager;
+    std::vector<Layout> candidates;
+    for (uz i = 0; i < num_candidates; ++i) {
+        candidates.emplace_back(manager.create());
+    }
+    return candidates;
+}
+
+TEST_CASE("test search::Racing::run()") {
+    static constexpr uz NUM_BIGRAMS = 20'000;
+    static constexpr uz NUM_CANDIDATES = 64;
+
+    const score::Evaluator evaluator = makeEvaluator(NUM_BIGRAMS);
+    const std::vector<Layout> candidates = makeCandidates(NUM_CANDIDATES);
+
+    std::vector<fz> exact(NUM_CANDIDATES);
+    for (uz i = 0; i < NUM_CANDIDATES; ++i) {
+        exact[i] = evaluator.score(candidates[i]);
+    }
+    const uz best = std::ranges::min_element(exact) - exact.begin();
+
+    Racing racing(evaluator);
+    std::vector<fz> scores(NUM_CANDIDATES);
+    const uz num_survivors = racing.run(candidates, scores);
+
+    SUBCASE("the best candidate survives") {
+        REQUIRE_GE(num_survivors, 1);
+        CHECK_EQ(scores[best], exact[best]);
+    }
+
+    SUBCASE("survivors are fully evaluated") {
+        uz counter = 0;
+        for (uz i = 0; i < NUM_CANDIDATES; ++i) {
+            if (scores[i] < Racing::INF) {
+                CHECK_EQ(scores[i], exact[i]);
+                ++counter;
+            }
+        }
+        CHECK_EQ(counter, num_survivors);
+    }
+
+    SUBCASE("racing saves evaluations") {
+        CHECK_LT(num_survivors, NUM_CANDIDATES);
+        CHECK_LT(racing.samplesUsed(), NUM_CANDIDATES * NUM_BIGRAMS);
+    }
+
+    SUBCASE("incumbent eliminates worse candidates") {
+        std::vector<fz> others(NUM_CANDIDATES);
+        racing.run(candidates, others, exact[best]);
+        for (uz i = 0; i < NUM_CANDIDATES; ++i) {
+            if (others[i] < Racing::INF) {
+                CHECK_LE(exact[i], exact[best] * 1.1f);
+            }
+        }
+    }
+}
+
+}
+
+}
@@ -0,0 +1,124 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_scheduler.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Scheduler") {
+
+using namespace toml::literals::toml_literals;
+using namespace std::chrono_literals;
+
+static constexpr uz NUM_WORKERS = 4;
+static constexpr uz NUM_RESTARTS = 64;
+
+TEST_CASE("test search::Scheduler::run()") {
+    Scheduler scheduler(NUM_WORKERS);
+    REQUIRE_EQ(scheduler.numWorkers(), NUM_WORKERS);
+
+    for (uz i = 0; i < NUM_RESTARTS; ++i) {
+        scheduler.submit({.id = i, .seed = i});
+    }
+
+    std::vector<std::atomic<uz>> runs(NUM_RESTARTS);
+    std::vector<std::string> results(NUM_RESTARTS);
+    const auto stats = scheduler.run([&](Worker &worker, const Restart &restart) -> void {
+        runs[restart.id].fetch_add(1);
+        // Heterogeneous run times
+        std::this_thread::sleep_for(std::chrono::microseconds(restart.id % 7 * 100));
+        results[restart.id] = worker.manager().create().toStr();
+    });
+
+    SUBCASE("every restart runs exactly once") {
+        CHECK_EQ(stats.completed, NUM_RESTARTS);
+        CHECK_EQ(stats.cancelled, 0);
+        for (const auto &counter : runs) {
+            CHECK_EQ(counter.load(), 1);
+        }
+    }
+
+    SUBCASE("managers are seeded by restarts") {
+        for (uz i = 0; i < NUM_RESTARTS; ++i) {
+            layout::Manager manager;
+            manager.seed(i);
+            CHECK_EQ(manager.create().toStr(), results[i]);
+        }
+    }
+}
+
+TEST_CASE("test search::Scheduler per-restart configuration") {
+    const auto config = std::make_shared<const layout::Config>(u8R"(
+        [[mutable_area]]
+        val = ["A", "B", "C"]
+        pos = [0, 1, 2]
+    )"_toml);
+
+    Scheduler scheduler(NUM_WORKERS);
+    for (uz i = 0; i < NUM_RESTARTS; ++i) {
+        scheduler.submit({.id = i, .seed = i, .config = i % 2 ? config : nullptr});
+    }
+
+    std::vector<std::string> prefixes(NUM_RESTARTS);
+    scheduler.run([&](Worker &worker, const Restart &restart) -> void {
+        prefixes[restart.id] = worker.manager().create().toStr().substr(0, 3);
+    });
+
+    for (uz i = 1; i < NUM_RESTARTS; i += 2) {
+        std::ranges::sort(prefixes[i]);
+        CHECK_EQ(prefixes[i], "ABC");
+    }
+}
+
+TEST_CASE("test search::Scheduler deadlines and cancellation") {
+
+    SUBCASE("time budget") {
+        Scheduler scheduler(NUM_WORKERS);
+        for (uz i = 0; i < NUM_WORKERS * 2; ++i) {
+            scheduler.submit({.id = i, .seed = i, .budget = 5ms});
+        }
+
+        const auto start = Clock::now();
+        const auto stats = scheduler.run([](Worker &worker, const Restart &) -> void {
+            while (not worker.stopRequested()) {
+                std::this_thread::yield();
+            }
+        });
+        CHECK_EQ(stats.completed, NUM_WORKERS * 2);
+        CHECK_LT(Clock::now() - start, 5s);
+    }
+
+    SUBCASE("cancel()") {
+        Scheduler scheduler(1);
+        for (uz i = 0; i < NUM_RESTARTS; ++i) {
+            scheduler.submit({.id = i, .seed = i});
+        }
+
+        const auto stats = scheduler.run([&](Worker &worker, const Restart &) -> void {
+            scheduler.cancel();
+            CHECK(worker.stopRequested());
+        });
+        CHECK_EQ(stats.completed, 1);
+        CHECK_EQ(stats.cancelled, NUM_RESTARTS - 1);
+    }
+}
+
+TEST_CASE("test search::Scheduler NUMA pinning") {
+    const auto topology = std::make_shared<const NumaTopology>(NumaMode::Local);
+    Scheduler scheduler(NUM_WORKERS, topology);
+    for (uz i = 0; i < NUM_RESTARTS; ++i) {
+        scheduler.submit({.id = i, .seed = i});
+    }
+
+    std::atomic<uz> num_misplaced{0};
+    const auto stats = scheduler.run([&](Worker &worker, const Restart &) -> void {
+        num_misplaced += worker.node() != topology->nodeOf(worker.id());
+        num_misplaced += worker.nodeId() != topology->nodeId(worker.node());
+        num_misplaced += sched_getcpu() != static_cast<int>(topology->cpuOf(worker.id()));
+    });
+    CHECK_EQ(stats.completed, NUM_RESTARTS);
+    CHECK_EQ(num_misplaced.load(), 0);
+}
+
+}
+
+}
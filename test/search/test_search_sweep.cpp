@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+
+#include "../../src/search/search_sweep.hpp"
+#include "search_fixtures.hpp"
+
+namespace jianhan::v0::search::tests {
+
+TEST_SUITE("Test search::Sweep") {
+
+using namespace toml::literals::toml_literals;
+
+static constexpr SweepOptions OPTIONS{
+    .num_restarts = 5, .seed = 3, .num_elites = 2,
+    .anneal = {.num_steps = 3'000, .start_temperature = 2, .end_temperature = 0.01},
+};
+
+TEST_CASE("test search::Sweep construction") {
+    CHECK_THROWS_AS((Sweep(TOY_EVALUATOR, {.num_restarts = 0})), std::invalid_argument);
+    CHECK_THROWS_AS((Sweep(TOY_EVALUATOR, {.num_elites = 0})), std::invalid_argument);
+    CHECK_THROWS_AS((Sweep(TOY_EVALUATOR, {.anneal = {.num_steps = 1, .start_temperature = 1}})), std::invalid_argument);
+
+    Sweep sweep(TOY_EVALUATOR, OPTIONS);
+    CHECK_THROWS_AS(sweep.add("illegal", u8R"(
+        [[fixed_key]]
+        val = "T"
+        pos = 40
+    )"_toml), std::invalid_argument);
+    CHECK_EQ(sweep.size(), 0);
+}
+
+TEST_CASE("test search::Sweep::run()") {
+    auto sweep = [](const uz num_workers) -> std::vector<SweepRow> {
+        Sweep s(TOY_EVALUATOR, OPTIONS);
+        s.add("default", nullptr);
+        s.add("T far", u8R"(
+            [[fixed_key]]
+            val = "T"
+            pos = 0
+            [[fixed_key]]
+            val = "H"
+            pos = 29
+        )"_toml);
+        Scheduler scheduler(num_workers);
+        return s.run(scheduler);
+    };
+
+    const std::vector<SweepRow> rows = sweep(1);
+    REQUIRE_EQ(rows.size(), 2);
+    CHECK_EQ(rows[0].name, "default");
+    CHECK_EQ(rows[1].name, "T far");
+
+    for (const SweepRow &row : rows) {
+        CHECK_EQ(row.restarts, 5);
+        REQUIRE_EQ(row.elites.size(), 2);
+        CHECK_EQ(row.elites.front().score, row.best_score);
+        CHECK_LE(row.best_score, row.mean_score);
+        CHECK_LE(row.mean_score, row.worst_score);
+    }
+    for (const Elite &elite : rows[1].elites) {
+        CHECK_EQ(elite.layout.getVal(0), 'T');
+        CHECK_EQ(elite.layout.getVal(29), 'H');
+    }
+    CHECK_EQ(rows[0].delta, 0);
+    CHECK_GT(rows[1].delta, 0); // TH costs 7 instead of 1
+
+    const std::vector<SweepRow> parallel = sweep(3);
+    for (uz i = 0; i < rows.size(); ++i) {
+        CHECK_EQ(parallel[i].elites.front().layout, rows[i].elites.front().layout);
+        CHECK_EQ(parallel[i].mean_score, rows[i].mean_score);
+    }
+
+    Sweep other(TOY_EVALUATOR, OPTIONS);
+    other.add("default", nullptr);
+    Scheduler busy(2);
+    busy.submit({.id = 1'000, .seed = 1});
+    CHECK_THROWS_AS(other.run(busy), std::invalid_argument);
+
+    const std::string table = Sweep::table(rows);
+    CHECK_EQ(std::ranges::count(table, '\n'), 3);
+    CHECK_NE(table.find(rows[1].elites.front().layout.toStr()), std::string::npos);
+}
+
+}
+
+}
@@ -0,0 +1,165 @@
+#include <doctest/doctest.h>
+
+#include "../src/jianhan.hpp"
+#include "../src/layout/layout.hpp"
+#include "../src/score/score.hpp"
+
+namespace jianhan::v0::tests {
+
+TEST_SUITE("Test C interface") {
+
+static constexpr std::string_view QWERTY = "QWERTYUIOPASDFGHJKL;ZXCVBNM,./";
+
+// score::gridDistanceCosts(), as the 30 * 30 matrix of the C interface.
+static auto distanceCosts() -> std::vector<float> {
+    const score::CostMatrix grid = score::gridDistanceCosts();
+    std::vector<float> costs(KEY_COUNT * KEY_COUNT);
+    for (const Position p1 : POSITIONS) {
+        for (const Position p2 : POSITIONS) {
+            costs[p1 * KEY_COUNT + p2] = grid[p1 * KEY_CNT_POW2 + p2];
+        }
+    }
+    return costs;
+}
+
+// Score of QWERTY: distances TH 2, HE 4, AN 6, QZ 2.
+static constexpr float QWERTY_SCORE = 3.0f * 2 + 2.5f * 4 + 2.0f * 6 + 0.1f * 2;
+
+static auto makeEvaluator() -> jh_evaluator * {
+    static constexpr std::array<jh_bigram, 4> BIGRAMS{{
+        {'T', 'H', 3.0f}, {'H', 'E', 2.5f}, {'A', 'N', 2.0f}, {'Q', 'Z', 0.1f},
+    }};
+    const std::vector<float> costs = distanceCosts();
+    jh_evaluator *evaluator = nullptr;
+    REQUIRE_EQ(jh_evaluator_new(BIGRAMS.data(), BIGRAMS.size(), costs.data(), &evaluator), JH_OK);
+    return evaluator;
+}
+
+TEST_CASE("test jh_config and jh_manager") {
+    static constexpr std::string_view TOML = R"(
+        [[fixed_key]]
+        val = "Q"
+        pos = 0
+    )";
+
+    jh_config *config = nullptr;
+    REQUIRE_EQ(jh_config_new(TOML.data(), TOML.size(), &config), JH_OK);
+
+    jh_manager *manager = nullptr;
+    REQUIRE_EQ(jh_manager_new(config, 7, &manager), JH_OK);
+    jh_config_free(config); // the manager keeps its own copy
+
+    std::array<char, 4 * KEY_COUNT> layouts{};
+    REQUIRE_EQ(jh_manager_create(manager, layouts.data(), 4), JH_OK);
+    REQUIRE_EQ(jh_manager_mutate(manager, layouts.data(), layouts.data(), 4), JH_OK);
+    for (uz i = 0; i < 4; ++i) {
+        const auto layout = Layout::parse(std::string_view(layouts.data() + i * KEY_COUNT, KEY_COUNT));
+        REQUIRE(layout.has_value());
+        CHECK_EQ(layout->getVal(0), 'Q');
+    }
+
+    // QWERTY does not keep ';' at 9, as the default configuration does.
+    jh_manager *default_manager = nullptr;
+    REQUIRE_EQ(jh_manager_new(nullptr, 7, &default_manager), JH_OK);
+    std::array<char, KEY_COUNT> child{};
+    CHECK_EQ(jh_manager_mutate(default_manager, QWERTY.data(), child.data(), 1), JH_INVALID_ARGUMENT);
+    CHECK_EQ(jh_manager_mutate(manager, "QQERTYUIOPASDFGHJKL;ZXCVBNM,./", child.data(), 1), JH_INVALID_ARGUMENT);
+    CHECK_NE(std::string_view(jh_last_error()).find("index 0"), std::string_view::npos);
+
+    jh_manager_free(default_manager);
+    jh_manager_free(manager);
+
+    jh_config *illegal = nullptr;
+    static constexpr std::string_view OUT_OF_RANGE = "[[fixed_key]]\nval = \"Q\"\npos = 40\n";
+    CHECK_EQ(jh_config_new(OUT_OF_RANGE.data(), OUT_OF_RANGE.size(), &illegal), JH_INVALID_ARGUMENT);
+    CHECK_EQ(illegal, nullptr);
+}
+
+TEST_CASE("test jh_evaluator_score()") {
+    jh_evaluator *evaluator = makeEvaluator();
+
+    std::array<char, 2 * KEY_COUNT> layouts{};
+    std::ranges::copy(QWERTY, layouts.begin());
+    std::ranges::copy(QWERTY, layouts.begin() + KEY_COUNT);
+    std::array<float, 2> scores{};
+    jh_set_num_threads(2);
+    REQUIRE_EQ(jh_evaluator_score(evaluator, layouts.data(), 2, scores.data()), JH_OK);
+    jh_set_num_threads(1);
+    CHECK_LT(std::abs(scores[0] - QWERTY_SCORE), 1e-4f);
+    CHECK_EQ(scores[1], scores[0]);
+
+    layouts[KEY_COUNT] = 'q';
+    CHECK_EQ(jh_evaluator_score(evaluator, layouts.data(), 2, scores.data()), JH_INVALID_ARGUMENT);
+    CHECK_NE(std::string_view(jh_last_error()).find("index 1"), std::string_view::npos);
+
+    jh_evaluator_free(evaluator);
+
+    static constexpr jh_bigram ILLEGAL{'T', '1', 1.0f};
+    const std::vector<float> costs = distanceCosts();
+    CHECK_EQ(jh_evaluator_new(&ILLEGAL, 1, costs.data(), &evaluator), JH_INVALID_ARGUMENT);
+}
+
+TEST_CASE("test jh_run") {
+    jh_evaluator *evaluator = makeEvaluator();
+    jh_run_options options{
+        .seed = 11, .num_restarts = 12, .num_steps = 2'000, .num_elites = 4,
+        .num_threads = 1, .start_temperature = 2.0, .end_temperature = 0.01,
+    };
+
+    auto results = [&](const size_t num_threads) -> std::pair<std::string, std::vector<float>> {
+        options.num_threads = num_threads;
+        jh_run *run = nullptr;
+        REQUIRE_EQ(jh_run_new(evaluator, nullptr, &options, &run), JH_OK);
+        REQUIRE_EQ(jh_run_start(run), JH_OK);
+        REQUIRE_EQ(jh_run_num_results(run), 4);
+
+        std::string layouts(4 * KEY_COUNT, '\0');
+        std::vector<float> scores(4);
+        REQUIRE_EQ(jh_run_results(run, layouts.data(), scores.data(), 4), JH_OK);
+        CHECK_EQ(jh_run_results(run, nullptr, nullptr, 5), JH_INVALID_ARGUMENT);
+        jh_run_free(run);
+        return {layouts, scores};
+    };
+
+    const auto [layouts, scores] = results(1);
+    CHECK(std::ranges::is_sorted(scores));
+    CHECK_LT(scores[0], QWERTY_SCORE);
+    CHECK_EQ(results(3), std::pair(layouts, scores));
+
+    SUBCASE("progress and cancellation") {
+        struct Progress final {
+            size_t calls;
+            size_t total;
+        } progress{0, 0};
+
+        jh_run *run = nullptr;
+        REQUIRE_EQ(jh_run_new(evaluator, nullptr, &options, &run), JH_OK);
+        jh_run_set_progress(run, [](void *user_data, const size_t, const size_t total, float) -> int {
+            auto *p = static_cast<Progress *>(user_data);
+            p->total = total;
+            return ++p->calls == 3; // cancel at the third restart
+        }, &progress);
+        CHECK_EQ(jh_run_start(run), JH_CANCELLED);
+        CHECK_EQ(progress.calls, 3);
+        CHECK_EQ(progress.total, 12);
+        CHECK_GE(jh_run_num_results(run), 3);
+        jh_run_free(run);
+    }
+
+    SUBCASE("illegal options") {
+        jh_run *run = nullptr;
+        jh_run_options illegal = options;
+        illegal.num_restarts = 0;
+        CHECK_EQ(jh_run_new(evaluator, nullptr, &illegal, &run), JH_INVALID_ARGUMENT);
+        illegal = options;
+        illegal.end_temperature = 0;
+        CHECK_EQ(jh_run_new(evaluator, nullptr, &illegal, &run), JH_INVALID_ARGUMENT);
+        CHECK_EQ(run, nullptr);
+    }
+
+    jh_evaluator_free(evaluator);
+}
+
+}
+
+}
@@ -9,6 +9,16 @@ set_languages("c99", "cxx23")
 set_optimize("fastest")
 set_fpmodels("fast")
 
+option("avx2", function ()
+    set_default(true)
+    set_showmenu(true)
+    set_description("Use the AVX2 code paths, the binaries then need an AVX2 CPU")
+end)
+
+if has_config("avx2") then
+    add_vectorexts("sse4.2", "avx2")
+end
+
 add_requires("openmp", {debug = true})
 add_requires("fmt >=10.2", {debug = true})
 add_requires("toml11 >=3.8", {debug = true})
@@ -21,6 +31,17 @@ target("jianhan", function ()
     add_packages(
         "openmp", "fmt", "toml11"
     )
+    add_syslinks("rt") -- shm_open before glibc 2.34
+end)
+
+target("jianhan-opt", function ()
+    set_kind("binary")
+    add_files("src/**.cpp")
+    add_files("app/jianhan_opt.cpp")
+    add_packages(
+        "openmp", "fmt", "toml11"
+    )
+    add_syslinks("rt")
 end)
 
 target("tests", function ()
@@ -31,4 +52,6 @@ target("tests", function ()
         "openmp", "fmt", "toml11",
         "doctest", "nanobench"
     )
+    add_syslinks("rt")
+    add_defines("JIANHAN_COUNT_ALLOCATIONS")
 end)